@@ -168,6 +168,7 @@ static int restore_tty;
 
 #if HAVE_THREADS
 static void free_input_threads(void);
+static void free_encoder_thread(OutputStream *ost);
 #endif
 
 /* sub2video hack:
@@ -513,6 +514,30 @@ static int decode_interrupt_cb(void *ctx)
 
 const AVIOInterruptCB int_cb = { decode_interrupt_cb, NULL };
 
+static void dump_codec_thread_stats(AVCodecContext *avctx, const char *kind,
+                                    int file_index, int index)
+{
+    const AVCodecThreadStats *st;
+
+    if (!avctx || !(st = avcodec_get_thread_stats(avctx)))
+        return;
+
+    av_log(NULL, AV_LOG_INFO, "%s #%d:%d (%s) thread statistics:\n",
+           kind, file_index, index, avctx->codec->name);
+    if (st->nb_frames)
+        av_log(NULL, AV_LOG_INFO, "  frames: %"PRId64", %.3f ms/frame, "
+               "waits: submit %.3f ms, output %.3f ms, progress %"PRId64" / %.3f ms\n",
+               st->nb_frames, st->frame_time / 1000.0 / st->nb_frames,
+               st->submit_wait_time / 1000.0, st->output_wait_time / 1000.0,
+               st->nb_progress_waits, st->progress_wait_time / 1000.0);
+    if (st->nb_executes)
+        av_log(NULL, AV_LOG_INFO, "  executes: %"PRId64", jobs: %"PRId64"\n",
+               st->nb_executes, st->nb_jobs);
+    for (int i = 0; i < st->nb_threads; i++)
+        av_log(NULL, AV_LOG_INFO, "  thread %2d: %8"PRId64" runs, busy %10.3f ms\n",
+               i, st->thread_nb_jobs[i], st->thread_busy_time[i] / 1000.0);
+}
+
 static void ffmpeg_cleanup(int ret)
 {
     int i, j;
@@ -522,8 +547,25 @@ static void ffmpeg_cleanup(int ret)
         av_log(NULL, AV_LOG_INFO, "bench: maxrss=%ikB\n", maxrss);
     }
 
+#if HAVE_THREADS
+    /* stop the encoders before anything they use is freed */
+    for (i = 0; i < nb_output_streams; i++)
+        if (output_streams[i])
+            free_encoder_thread(output_streams[i]);
+    for (i = 0; i < nb_input_streams; i++)
+        if (input_streams[i])
+            chunk_uninit(input_streams[i]);
+#endif
+
+    for (i = 0; i < nb_output_streams; i++)
+        if (output_streams[i])
+            dump_codec_thread_stats(output_streams[i]->enc_ctx, "Encoder",
+                                    output_streams[i]->file_index,
+                                    output_streams[i]->index);
+
     for (i = 0; i < nb_filtergraphs; i++) {
         FilterGraph *fg = filtergraphs[i];
+        dump_filtergraph_stats(fg);
         avfilter_graph_free(&fg->graph);
         for (j = 0; j < fg->nb_inputs; j++) {
             InputFilter *ifilter = fg->inputs[j];
@@ -589,6 +631,8 @@ static void ffmpeg_cleanup(int ret)
         av_frame_free(&ost->filtered_frame);
         av_frame_free(&ost->last_frame);
         av_packet_free(&ost->pkt);
+        av_packet_free(&ost->chunk_pkt);
+        av_packet_free(&ost->chunk_last_pkt);
         av_dict_free(&ost->encoder_opts);
 
         av_freep(&ost->forced_keyframes);
@@ -638,6 +682,7 @@ static void ffmpeg_cleanup(int ret)
 
         av_freep(&input_streams[i]);
     }
+    av_thread_pool_free(&thread_pool);
 
     if (vstats_file) {
         if (fclose(vstats_file))
@@ -996,6 +1041,210 @@ static int init_output_stream_wrapper(OutputStream *ost, AVFrame *frame,
     return ret;
 }
 
+#if HAVE_THREADS
+static void free_frame_msg(void *msg)
+{
+    av_frame_free(msg);
+}
+
+static void *encoder_thread(void *arg)
+{
+    OutputStream *ost = arg;
+    AVCodecContext *enc = ost->enc_ctx;
+    AVPacket *pkt = NULL, *queue_pkt;
+    AVFrame *frame;
+    int64_t pts;
+    int ret;
+
+    pkt = av_packet_alloc();
+    if (!pkt) {
+        ret = AVERROR(ENOMEM);
+        goto finish;
+    }
+
+    while (1) {
+        ret = av_thread_message_queue_recv(ost->enc_thread_queue, &frame, 0);
+        if (ret < 0)
+            break;
+
+        /* a NULL frame flushes the encoder and ends the thread */
+        pts = frame ? frame->pts : AV_NOPTS_VALUE;
+        if (frame && enc->codec_type == AVMEDIA_TYPE_VIDEO &&
+            !ost->frame_aspect_ratio.num)
+            enc->sample_aspect_ratio = frame->sample_aspect_ratio;
+        ret = avcodec_send_frame(enc, frame);
+        av_frame_free(&frame);
+        if (ret < 0)
+            break;
+
+        while ((ret = avcodec_receive_packet(enc, pkt)) >= 0) {
+            if (enc->codec_type == AVMEDIA_TYPE_VIDEO &&
+                pkt->pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
+                pkt->pts = pts;
+
+            /* if two pass, output log */
+            if (ost->logfile && enc->stats_out)
+                fprintf(ost->logfile, "%s", enc->stats_out);
+
+            queue_pkt = av_packet_alloc();
+            if (!queue_pkt) {
+                av_packet_unref(pkt);
+                ret = AVERROR(ENOMEM);
+                goto finish;
+            }
+            av_packet_move_ref(queue_pkt, pkt);
+
+            pthread_mutex_lock(&ost->enc_thread_lock);
+            ret = av_fifo_write(ost->enc_thread_pkts, &queue_pkt, 1);
+            pthread_mutex_unlock(&ost->enc_thread_lock);
+            if (ret < 0) {
+                av_packet_free(&queue_pkt);
+                goto finish;
+            }
+        }
+        if (ret != AVERROR(EAGAIN))
+            break;
+    }
+
+finish:
+    if (ret != AVERROR_EOF)
+        av_log(NULL, AV_LOG_ERROR, "Encoder thread for output stream %d:%d "
+               "failed: %s\n", ost->file_index, ost->index, av_err2str(ret));
+    av_packet_free(&pkt);
+    /* unblock the main thread if it is waiting to send a frame */
+    av_thread_message_queue_set_err_send(ost->enc_thread_queue, ret);
+
+    pthread_mutex_lock(&ost->enc_thread_lock);
+    ost->enc_thread_ret = ret;
+    pthread_mutex_unlock(&ost->enc_thread_lock);
+
+    return NULL;
+}
+
+static int init_encoder_thread(OutputStream *ost)
+{
+    int ret;
+
+    ost->enc_thread_pkts = av_fifo_alloc2(8, sizeof(AVPacket*), AV_FIFO_FLAG_AUTO_GROW);
+    if (!ost->enc_thread_pkts)
+        return AVERROR(ENOMEM);
+
+    ret = av_thread_message_queue_alloc(&ost->enc_thread_queue,
+                                        ost->enc_thread_queue_size, sizeof(AVFrame*));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(ost->enc_thread_queue, free_frame_msg);
+
+    ost->enc_thread_ret = AVERROR(EAGAIN);
+    pthread_mutex_init(&ost->enc_thread_lock, NULL);
+
+    if ((ret = pthread_create(&ost->enc_thread, NULL, encoder_thread, ost))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        pthread_mutex_destroy(&ost->enc_thread_lock);
+        av_thread_message_queue_free(&ost->enc_thread_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+/*
+ * Wait for the encoder thread to end. If flush is set, the encoder is
+ * drained first and all its packets remain available to
+ * encoder_receive_packet(), otherwise queued frames are discarded.
+ */
+static void join_encoder_thread(OutputStream *ost, int flush)
+{
+    AVFrame *frame = NULL;
+
+    if (!ost->enc_thread_queue || ost->enc_thread_joined)
+        return;
+
+    if (flush)
+        av_thread_message_queue_send(ost->enc_thread_queue, &frame, 0);
+    else {
+        av_thread_message_queue_set_err_recv(ost->enc_thread_queue, AVERROR_EOF);
+        av_thread_message_flush(ost->enc_thread_queue);
+    }
+
+    pthread_join(ost->enc_thread, NULL);
+    ost->enc_thread_joined = 1;
+    av_thread_message_queue_free(&ost->enc_thread_queue);
+}
+
+static void free_encoder_thread(OutputStream *ost)
+{
+    AVPacket *pkt;
+
+    join_encoder_thread(ost, 0);
+
+    if (!ost->enc_thread_pkts)
+        return;
+    while (av_fifo_read(ost->enc_thread_pkts, &pkt, 1) >= 0)
+        av_packet_free(&pkt);
+    av_fifo_freep2(&ost->enc_thread_pkts);
+    if (ost->enc_thread_joined)
+        pthread_mutex_destroy(&ost->enc_thread_lock);
+}
+#endif
+
+/*
+ * Send a frame to the encoder of ost. With an encoder thread, a new
+ * reference to the frame is queued and the call only blocks while the
+ * queue is full.
+ */
+static int encoder_send_frame(OutputStream *ost, const AVFrame *frame)
+{
+#if HAVE_THREADS
+    if (ost->enc_thread_queue_size > 0) {
+        AVFrame *queue_frame = NULL;
+        int ret;
+
+        if (!ost->enc_thread_pkts && (ret = init_encoder_thread(ost)) < 0)
+            return ret;
+
+        if (frame && !(queue_frame = av_frame_clone(frame)))
+            return AVERROR(ENOMEM);
+
+        ret = av_thread_message_queue_send(ost->enc_thread_queue, &queue_frame, 0);
+        if (ret < 0) {
+            av_frame_free(&queue_frame);
+            /* the encoder thread stopped, even a clean end is an error here */
+            return ret == AVERROR_EOF ? AVERROR_BUG : ret;
+        }
+        return 0;
+    }
+#endif
+    return avcodec_send_frame(ost->enc_ctx, frame);
+}
+
+/*
+ * Same semantics as avcodec_receive_packet(). With an encoder thread this
+ * never blocks: it returns AVERROR(EAGAIN) until the thread has produced
+ * a packet.
+ */
+static int encoder_receive_packet(OutputStream *ost, AVPacket *pkt)
+{
+#if HAVE_THREADS
+    if (ost->enc_thread_pkts) {
+        AVPacket *queue_pkt;
+        int ret;
+
+        pthread_mutex_lock(&ost->enc_thread_lock);
+        ret = av_fifo_read(ost->enc_thread_pkts, &queue_pkt, 1);
+        if (ret >= 0) {
+            av_packet_move_ref(pkt, queue_pkt);
+            av_packet_free(&queue_pkt);
+        } else
+            ret = ost->enc_thread_ret;
+        pthread_mutex_unlock(&ost->enc_thread_lock);
+
+        return ret;
+    }
+#endif
+    return avcodec_receive_packet(ost->enc_ctx, pkt);
+}
+
 static void do_audio_out(OutputFile *of, OutputStream *ost,
                          AVFrame *frame)
 {
@@ -1022,12 +1271,12 @@ static void do_audio_out(OutputFile *of, OutputStream *ost,
                enc->time_base.num, enc->time_base.den);
     }
 
-    ret = avcodec_send_frame(enc, frame);
+    ret = encoder_send_frame(ost, frame);
     if (ret < 0)
         goto error;
 
     while (1) {
-        ret = avcodec_receive_packet(enc, pkt);
+        ret = encoder_receive_packet(ost, pkt);
         if (ret == AVERROR(EAGAIN))
             break;
         if (ret < 0)
@@ -1141,7 +1390,8 @@ static void do_subtitle_out(OutputFile *of,
 /* May modify/reset next_picture */
 static void do_video_out(OutputFile *of,
                          OutputStream *ost,
-                         AVFrame *next_picture)
+                         AVFrame *next_picture,
+                         const AVPacket *next_encoded)
 {
     int ret;
     AVPacket *pkt = ost->pkt;
@@ -1271,13 +1521,20 @@ static void do_video_out(OutputFile *of,
     /* duplicates frame if needed */
     for (i = 0; i < nb_frames; i++) {
         AVFrame *in_picture;
+        const AVPacket *encoded;
         int forced_keyframe = 0;
         double pts_time;
 
         if (i < nb0_frames && ost->last_frame->buf[0]) {
             in_picture = ost->last_frame;
-        } else
+            encoded    = ost->chunk_last_pkt;
+        } else {
             in_picture = next_picture;
+            encoded    = next_encoded;
+        }
+        /* frames encoded by a chunk worker only need their timestamps */
+        if (encoded && !encoded->data)
+            encoded = NULL;
 
         if (!in_picture)
             return;
@@ -1349,19 +1606,28 @@ static void do_video_out(OutputFile *of,
 
         ost->frames_encoded++;
 
-        ret = avcodec_send_frame(enc, in_picture);
-        if (ret < 0)
-            goto error;
-        // Make sure Closed Captions will not be duplicated
-        av_frame_remove_side_data(in_picture, AV_FRAME_DATA_A53_CC);
-
-        while (1) {
-            ret = avcodec_receive_packet(enc, pkt);
-            update_benchmark("encode_video %d.%d", ost->file_index, ost->index);
-            if (ret == AVERROR(EAGAIN))
-                break;
+        if (encoded) {
+            ret = av_packet_ref(pkt, encoded);
+            if (ret < 0)
+                goto error;
+            pkt->pts = pkt->dts = in_picture->pts;
+        } else {
+            ret = encoder_send_frame(ost, in_picture);
             if (ret < 0)
                 goto error;
+            // Make sure Closed Captions will not be duplicated
+            av_frame_remove_side_data(in_picture, AV_FRAME_DATA_A53_CC);
+        }
+
+        while (1) {
+            if (!encoded) {
+                ret = encoder_receive_packet(ost, pkt);
+                update_benchmark("encode_video %d.%d", ost->file_index, ost->index);
+                if (ret == AVERROR(EAGAIN))
+                    break;
+                if (ret < 0)
+                    goto error;
+            }
 
             if (debug_ts) {
                 av_log(NULL, AV_LOG_INFO, "encoder -> type:video "
@@ -1390,9 +1656,12 @@ static void do_video_out(OutputFile *of,
             output_packet(of, pkt, ost, 0);
 
             /* if two pass, output log */
-            if (ost->logfile && enc->stats_out) {
+            if (ost->logfile && enc->stats_out && !ost->enc_thread_queue_size) {
                 fprintf(ost->logfile, "%s", enc->stats_out);
             }
+
+            if (encoded)
+                break;
         }
         ost->sync_opts++;
         /*
@@ -1409,6 +1678,12 @@ static void do_video_out(OutputFile *of,
     av_frame_unref(ost->last_frame);
     if (next_picture)
         av_frame_move_ref(ost->last_frame, next_picture);
+    if (ost->chunk_last_pkt) {
+        av_packet_unref(ost->chunk_last_pkt);
+        if (next_picture && next_encoded &&
+            av_packet_ref(ost->chunk_last_pkt, next_encoded) < 0)
+            goto error;
+    }
 
     return;
 error:
@@ -1523,7 +1798,7 @@ static int reap_filters(int flush)
                            "Error in av_buffersink_get_frame_flags(): %s\n", av_err2str(ret));
                 } else if (flush && ret == AVERROR_EOF) {
                     if (av_buffersink_get_type(filter) == AVMEDIA_TYPE_VIDEO)
-                        do_video_out(of, ost, NULL);
+                        do_video_out(of, ost, NULL, NULL);
                 }
                 break;
             }
@@ -1534,10 +1809,11 @@ static int reap_filters(int flush)
 
             switch (av_buffersink_get_type(filter)) {
             case AVMEDIA_TYPE_VIDEO:
-                if (!ost->frame_aspect_ratio.num)
+                /* with an encoder thread, this is done by the thread */
+                if (!ost->frame_aspect_ratio.num && !ost->enc_thread_queue_size)
                     enc->sample_aspect_ratio = filtered_frame->sample_aspect_ratio;
 
-                do_video_out(of, ost, filtered_frame);
+                do_video_out(of, ost, filtered_frame, NULL);
                 break;
             case AVMEDIA_TYPE_AUDIO:
                 if (!(enc->codec->capabilities & AV_CODEC_CAP_PARAM_CHANGE) &&
@@ -1955,6 +2231,12 @@ static void flush_encoders(void)
         if (enc->codec_type != AVMEDIA_TYPE_VIDEO && enc->codec_type != AVMEDIA_TYPE_AUDIO)
             continue;
 
+#if HAVE_THREADS
+        /* let the encoder thread drain the encoder, its packets are
+         * returned by encoder_receive_packet() below */
+        join_encoder_thread(ost, 1);
+#endif
+
         for (;;) {
             const char *desc = NULL;
             AVPacket *pkt = ost->pkt;
@@ -1973,7 +2255,7 @@ static void flush_encoders(void)
 
             update_benchmark(NULL);
 
-            while ((ret = avcodec_receive_packet(enc, pkt)) == AVERROR(EAGAIN)) {
+            while ((ret = encoder_receive_packet(ost, pkt)) == AVERROR(EAGAIN)) {
                 ret = avcodec_send_frame(enc, NULL);
                 if (ret < 0) {
                     av_log(NULL, AV_LOG_FATAL, "%s encoding failed: %s\n",
@@ -1990,7 +2272,7 @@ static void flush_encoders(void)
                        av_err2str(ret));
                 exit_program(1);
             }
-            if (ost->logfile && enc->stats_out) {
+            if (ost->logfile && enc->stats_out && !ost->enc_thread_queue_size) {
                 fprintf(ost->logfile, "%s", enc->stats_out);
             }
             if (ret == AVERROR_EOF) {
@@ -2366,6 +2648,82 @@ static int decode_audio(InputStream *ist, AVPacket *pkt, int *got_output,
     return err < 0 ? err : ret;
 }
 
+/* Pass the oldest frame transcoded by the chunk workers of ist on to
+ * the video sync, which also muxes its encoded packet. */
+static int output_chunk(InputStream *ist, int block)
+{
+    OutputStream *ost = ist->filters[0]->graph->outputs[0]->ost;
+    OutputFile    *of = output_files[ost->file_index];
+    AVFrame    *frame = ost->filtered_frame;
+    int decode_ret, got_output, ret;
+
+    ret = chunk_receive(ist, frame, ost->chunk_pkt, &decode_ret, block);
+    if (ret < 0) {
+        av_frame_unref(frame);
+        av_packet_unref(ost->chunk_pkt);
+        return ret;
+    }
+
+    if (decode_ret < 0)
+        av_log(NULL, AV_LOG_ERROR, "Error while decoding stream #%d:%d: %s\n",
+               ist->file_index, ist->st->index, av_err2str(decode_ret));
+    got_output = decode_ret > 0;
+    check_decode_result(NULL, &got_output, FFMIN(decode_ret, 0));
+    if (got_output)
+        ist->frames_decoded += decode_ret;
+
+    if (frame->buf[0] && !ost->finished) {
+        if (!ost->frame_aspect_ratio.num)
+            ost->enc_ctx->sample_aspect_ratio = frame->sample_aspect_ratio;
+
+        do_video_out(of, ost, frame, ost->chunk_pkt);
+    }
+
+    av_frame_unref(frame);
+    av_packet_unref(ost->chunk_pkt);
+    return 0;
+}
+
+static int reap_chunk_workers(InputStream *ist, int flush)
+{
+    int ret;
+
+    while ((ret = output_chunk(ist, flush)) >= 0);
+
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int decode_video_chunked(InputStream *ist, AVPacket *pkt, int *got_output,
+                                int64_t *duration_pts)
+{
+    int64_t pts = AV_NOPTS_VALUE, ts;
+    int ret;
+
+    // a packet never gives more than one frame
+    if (!pkt)
+        return 0;
+
+    if (ist->framerate.num)
+        pts = ist->cfr_next_pts++;
+
+    while ((ret = chunk_send_packet(ist, pkt, pts)) == AVERROR(EAGAIN)) {
+        ret = output_chunk(ist, 1);
+        if (ret < 0)
+            return ret;
+    }
+    if (ret < 0)
+        return ret;
+
+    /* the frame is output later, account for it as decode_video() does */
+    ts = pts != AV_NOPTS_VALUE ? pts : pkt->pts;
+    if (ts != AV_NOPTS_VALUE)
+        ist->next_pts = ist->pts = av_rescale_q(ts, ist->st->time_base, AV_TIME_BASE_Q);
+    *duration_pts = pkt->duration;
+    *got_output   = 1;
+
+    return reap_chunk_workers(ist, 0);
+}
+
 static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output, int64_t *duration_pts, int eof,
                         int *decode_failed)
 {
@@ -2386,6 +2744,23 @@ static int decode_video(InputStream *ist, AVPacket *pkt, int *got_output, int64_
         pkt->dts = dts; // ffmpeg.c probably shouldn't do this
     }
 
+    if (!eof && !ist->chunk) {
+        ret = chunk_init(ist);
+        if (ret < 0)
+            return ret;
+    }
+    if (ist->chunk) {
+        if (!eof)
+            return decode_video_chunked(ist, pkt, got_output, duration_pts);
+
+        /* output everything still in the workers, then flush the regular
+         * decoder as usual */
+        ret = reap_chunk_workers(ist, 1);
+        chunk_uninit(ist);
+        if (ret < 0)
+            return ret;
+    }
+
     // The old code used to set dts on the drain packet, which does not work
     // with the new API anymore.
     if (eof) {
@@ -2906,6 +3281,8 @@ static int init_input_stream(int ist_index, char *error, int error_len)
 
         if (!av_dict_get(ist->decoder_opts, "threads", NULL, 0))
             av_dict_set(&ist->decoder_opts, "threads", "auto", 0);
+        if ((ret = chunk_set_decoder_opts(ist)) < 0)
+            return ret;
         /* Attached pics are sparse, therefore we would not want to delay their decoding till EOF. */
         if (ist->st->disposition & AV_DISPOSITION_ATTACHED_PIC)
             av_dict_set(&ist->decoder_opts, "threads", "1", 0);
@@ -2918,6 +3295,7 @@ static int init_input_stream(int ist_index, char *error, int error_len)
             return ret;
         }
 
+        ist->dec_ctx->thread_pool = thread_pool;
         if ((ret = avcodec_open2(ist->dec_ctx, codec, &ist->decoder_opts)) < 0) {
             if (ret == AVERROR_EXPERIMENTAL)
                 abort_codec_experimental(codec, 0);
@@ -3490,6 +3868,7 @@ static int init_output_stream(OutputStream *ost, AVFrame *frame,
             }
         }
 
+        ost->enc_ctx->thread_pool = thread_pool;
         if ((ret = avcodec_open2(ost->enc_ctx, codec, &ost->encoder_opts)) < 0) {
             if (ret == AVERROR_EXPERIMENTAL)
                 abort_codec_experimental(codec, 1);
@@ -4763,6 +5142,7 @@ static int transcode(void)
     for (i = 0; i < nb_input_streams; i++) {
         ist = input_streams[i];
         if (ist->decoding_needed) {
+            dump_codec_thread_stats(ist->dec_ctx, "Decoder", ist->file_index, ist->st->index);
             avcodec_close(ist->dec_ctx);
             if (ist->hwaccel_uninit)
                 ist->hwaccel_uninit(ist->dec_ctx);
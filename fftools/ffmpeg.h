@@ -44,6 +44,7 @@
 #include "libavutil/rational.h"
 #include "libavutil/thread.h"
 #include "libavutil/threadmessage.h"
+#include "libavutil/threadpool.h"
 
 #include "libswresample/swresample.h"
 
@@ -216,6 +217,10 @@ typedef struct OptionsContext {
     int        nb_max_muxing_queue_size;
     SpecifierOpt *muxing_queue_data_threshold;
     int        nb_muxing_queue_data_threshold;
+    SpecifierOpt *enc_thread_queue_size;
+    int        nb_enc_thread_queue_size;
+    SpecifierOpt *chunk_workers;
+    int        nb_chunk_workers;
     SpecifierOpt *guess_layout_max;
     int        nb_guess_layout_max;
     SpecifierOpt *apad;
@@ -396,6 +401,10 @@ typedef struct InputStream {
     int nb_dts_buffer;
 
     int got_output;
+
+    /* decoder, filtergraph and encoder instances this stream is sharded
+     * across, see ffmpeg_chunk.c */
+    struct ChunkContext *chunk;
 } InputStream;
 
 typedef struct InputFile {
@@ -574,6 +583,22 @@ typedef struct OutputStream {
 
     /* frame encode sum of squared error values */
     int64_t error[4];
+
+    int enc_thread_queue_size;      /* maximum number of frames queued for the encoder thread */
+#if HAVE_THREADS
+    AVThreadMessageQueue *enc_thread_queue;
+    pthread_t enc_thread;           /* thread running the encoder */
+    pthread_mutex_t enc_thread_lock;
+    /* packets returned by the encoder thread, protected by enc_thread_lock */
+    AVFifo *enc_thread_pkts;
+    /* AVERROR(EAGAIN) while the encoder thread runs, its final status afterwards */
+    int enc_thread_ret;
+    int enc_thread_joined;
+#endif
+
+    int chunk_workers;              /* number of decode/filter/encode pipelines for intra-only video */
+    AVPacket *chunk_pkt;            /* packet encoded by a chunk worker */
+    AVPacket *chunk_last_pkt;       /* packet encoded by a chunk worker for last_frame */
 } OutputStream;
 
 typedef struct OutputFile {
@@ -634,6 +659,10 @@ extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern int filter_parallel;
+extern int filter_stats;
+extern int thread_pool_size;
+extern AVThreadPool *thread_pool;
 extern int vstats_version;
 extern int auto_conversion_filters;
 
@@ -657,8 +686,11 @@ void assert_avoptions(AVDictionary *m);
 int guess_input_channel_layout(InputStream *ist);
 
 int configure_filtergraph(FilterGraph *fg);
+void dump_filtergraph_stats(FilterGraph *fg);
 void check_filter_outputs(void);
 int filtergraph_is_simple(FilterGraph *fg);
+int filtergraph_instantiate(FilterGraph *fg, AVFilterGraph **graph,
+                            AVFilterContext **src, AVFilterContext **sink);
 int init_simple_filtergraph(InputStream *ist, OutputStream *ost);
 int init_complex_filtergraph(FilterGraph *fg);
 
@@ -681,4 +713,11 @@ int hw_device_setup_for_filter(FilterGraph *fg);
 
 int hwaccel_decode_init(AVCodecContext *avctx);
 
+int chunk_set_decoder_opts(InputStream *ist);
+int chunk_init(InputStream *ist);
+int chunk_send_packet(InputStream *ist, const AVPacket *pkt, int64_t pts);
+int chunk_receive(InputStream *ist, AVFrame *frame, AVPacket *pkt,
+                  int *decode_ret, int block);
+void chunk_uninit(InputStream *ist);
+
 #endif /* FFTOOLS_FFMPEG_H */
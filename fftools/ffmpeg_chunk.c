@@ -0,0 +1,628 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Chunked transcoding of intra-only video.
+ *
+ * Every frame of an intra-only stream can be decoded, filtered and encoded
+ * on its own, so the whole per-frame chain is replicated into several
+ * workers, each with its own decoder, filtergraph instance and encoder.
+ * Packets are handed out to the workers in decoding order and the main
+ * thread collects the filtered frames and their encoded packets in the same
+ * order, so that video sync and muxing work as without workers.
+ *
+ * The first frame always goes through the regular path, which configures
+ * the filtergraph and opens the encoder the workers are cloned from.
+ */
+
+#include <string.h>
+
+#include "libavutil/opt.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#include "ffmpeg.h"
+
+#if HAVE_THREADS
+
+typedef struct ChunkJob {
+    AVPacket *in;           /* packet to decode */
+    int64_t   pts;          /* timestamp forced with -r, or AV_NOPTS_VALUE */
+    AVFrame  *frame;        /* filtered frame, if the filtergraph output one */
+    AVPacket *out;          /* encoded frame */
+    int       decode_ret;   /* <0 on decoding error, number of decoded frames otherwise */
+    int       ret;
+    int       done;
+} ChunkJob;
+
+typedef struct ChunkWorker {
+    struct ChunkContext *cc;
+    pthread_t        thread;
+    int              thread_created;
+
+    AVCodecContext  *dec;
+    AVFilterGraph   *graph;
+    AVFilterContext *src;
+    AVFilterContext *sink;
+    AVCodecContext  *enc;
+    AVFrame         *frame;
+} ChunkWorker;
+
+typedef struct ChunkContext {
+    InputStream  *ist;
+    OutputStream *ost;
+
+    /* parameters the filtergraph instances were configured for */
+    int format, width, height;
+
+    ChunkWorker  *workers;
+    int        nb_workers;
+
+    /* ring of jobs, indexed by the counters below modulo nb_jobs */
+    ChunkJob     *jobs;
+    int        nb_jobs;
+    uint64_t      queued;
+    uint64_t      taken;
+    uint64_t      delivered;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  job_cond;
+    pthread_cond_t  done_cond;
+    int             exit;
+} ChunkContext;
+
+static int chunk_decode(ChunkWorker *w, ChunkJob *job)
+{
+    ChunkContext *cc  = w->cc;
+    InputStream  *ist = cc->ist;
+    AVFrame    *frame = w->frame;
+    int ret;
+
+    ret = avcodec_send_packet(w->dec, job->in);
+    av_packet_unref(job->in);
+    if (ret < 0 && ret != AVERROR_EOF) {
+        job->decode_ret = ret;
+        return 0;
+    }
+
+    while ((ret = avcodec_receive_frame(w->dec, frame)) >= 0) {
+        job->decode_ret++;
+
+        if (frame->format != cc->format ||
+            frame->width  != cc->width  || frame->height != cc->height) {
+            av_log(NULL, AV_LOG_ERROR, "Frame parameters of input stream #%d:%d "
+                   "changed, which is not supported with chunk workers\n",
+                   ist->file_index, ist->st->index);
+            return AVERROR(ENOSYS);
+        }
+
+        if (ist->top_field_first >= 0)
+            frame->top_field_first = ist->top_field_first;
+        frame->pts = job->pts != AV_NOPTS_VALUE ? job->pts :
+                                                  frame->best_effort_timestamp;
+        if (ist->st->sample_aspect_ratio.num)
+            frame->sample_aspect_ratio = ist->st->sample_aspect_ratio;
+
+        ret = av_buffersrc_add_frame_flags(w->src, frame, AV_BUFFERSRC_FLAG_PUSH);
+        if (ret < 0)
+            return ret;
+    }
+    if (ret != AVERROR(EAGAIN))
+        job->decode_ret = ret;
+
+    return 0;
+}
+
+static int chunk_run_job(ChunkWorker *w, ChunkJob *job)
+{
+    ChunkContext *cc  = w->cc;
+    OutputStream *ost = cc->ost;
+    AVFrame    *frame = w->frame;
+    int ret;
+
+    ret = chunk_decode(w, job);
+    if (ret < 0 || job->decode_ret <= 0)
+        return ret;
+
+    while ((ret = av_buffersink_get_frame_flags(w->sink, frame,
+                                                AV_BUFFERSINK_FLAG_NO_REQUEST)) >= 0) {
+        if (job->frame->buf[0]) {
+            av_frame_unref(frame);
+            av_log(NULL, AV_LOG_ERROR, "The filtergraph of output stream #%d:%d "
+                   "returned several frames for one input frame, which is not "
+                   "supported with chunk workers\n", ost->file_index, ost->index);
+            return AVERROR(ENOSYS);
+        }
+        av_frame_move_ref(job->frame, frame);
+    }
+    if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+        return ret;
+    if (!job->frame->buf[0]) {
+        av_log(NULL, AV_LOG_ERROR, "The filtergraph of output stream #%d:%d "
+               "returned no frame for an input frame, which is not supported "
+               "with chunk workers\n", ost->file_index, ost->index);
+        return AVERROR(ENOSYS);
+    }
+
+    if (!ost->frame_aspect_ratio.num)
+        w->enc->sample_aspect_ratio = job->frame->sample_aspect_ratio;
+
+    ret = av_frame_ref(frame, job->frame);
+    if (ret < 0)
+        return ret;
+    /* as done by do_video_out(); the timestamps of the packet are set by
+     * the main thread */
+    frame->quality   = w->enc->global_quality;
+    frame->pict_type = 0;
+
+    ret = avcodec_send_frame(w->enc, frame);
+    av_frame_unref(frame);
+    if (ret < 0)
+        return ret;
+
+    ret = avcodec_receive_packet(w->enc, job->out);
+    if (ret == AVERROR(EAGAIN)) {
+        av_log(NULL, AV_LOG_ERROR, "The encoder of output stream #%d:%d did "
+               "not return a packet for a frame\n", ost->file_index, ost->index);
+        ret = AVERROR_BUG;
+    }
+    return ret;
+}
+
+static void *chunk_worker_thread(void *arg)
+{
+    ChunkWorker  *w = arg;
+    ChunkContext *cc = w->cc;
+
+    pthread_mutex_lock(&cc->lock);
+    while (1) {
+        ChunkJob *job;
+
+        while (!cc->exit && cc->taken == cc->queued)
+            pthread_cond_wait(&cc->job_cond, &cc->lock);
+        if (cc->exit)
+            break;
+        job = &cc->jobs[cc->taken++ % cc->nb_jobs];
+        pthread_mutex_unlock(&cc->lock);
+
+        job->ret = chunk_run_job(w, job);
+
+        pthread_mutex_lock(&cc->lock);
+        job->done = 1;
+        pthread_cond_signal(&cc->done_cond);
+    }
+    pthread_mutex_unlock(&cc->lock);
+
+    return NULL;
+}
+
+static int chunk_open_decoder(ChunkWorker *w, InputStream *ist)
+{
+    AVCodecContext *dec;
+    int ret;
+
+    dec = w->dec = avcodec_alloc_context3(ist->dec);
+    if (!dec)
+        return AVERROR(ENOMEM);
+
+    ret = avcodec_parameters_to_context(dec, ist->st->codecpar);
+    if (ret < 0)
+        return ret;
+    ret = av_opt_copy(dec, ist->dec_ctx);
+    if (ret < 0)
+        return ret;
+    if (ist->dec->priv_class) {
+        ret = av_opt_copy(dec->priv_data, ist->dec_ctx->priv_data);
+        if (ret < 0)
+            return ret;
+    }
+
+    dec->pkt_timebase = ist->st->time_base;
+    dec->framerate    = ist->dec_ctx->framerate;
+    /* the workers are the threads */
+    dec->thread_count = 1;
+
+    return avcodec_open2(dec, ist->dec, NULL);
+}
+
+static int chunk_open_encoder(ChunkWorker *w, OutputStream *ost)
+{
+    AVCodecContext *enc;
+    int ret;
+
+    enc = w->enc = avcodec_alloc_context3(ost->enc);
+    if (!enc)
+        return AVERROR(ENOMEM);
+
+    /* the main encoder is open, so this includes the parameters set by
+     * init_output_stream_encode() */
+    ret = av_opt_copy(enc, ost->enc_ctx);
+    if (ret < 0)
+        return ret;
+    if (ost->enc->priv_class) {
+        ret = av_opt_copy(enc->priv_data, ost->enc_ctx->priv_data);
+        if (ret < 0)
+            return ret;
+    }
+
+    enc->time_base    = ost->enc_ctx->time_base;
+    enc->framerate    = ost->enc_ctx->framerate;
+    enc->thread_count = 1;
+
+    return avcodec_open2(enc, ost->enc, NULL);
+}
+
+static int chunk_worker_init(ChunkWorker *w, ChunkContext *cc)
+{
+    int ret;
+
+    w->cc = cc;
+
+    w->frame = av_frame_alloc();
+    if (!w->frame)
+        return AVERROR(ENOMEM);
+
+    ret = chunk_open_decoder(w, cc->ist);
+    if (ret < 0)
+        return ret;
+
+    ret = filtergraph_instantiate(cc->ost->filter->graph, &w->graph,
+                                  &w->src, &w->sink);
+    if (ret < 0)
+        return ret;
+
+    ret = chunk_open_encoder(w, cc->ost);
+    if (ret < 0)
+        return ret;
+
+    ret = pthread_create(&w->thread, NULL, chunk_worker_thread, w);
+    if (ret)
+        return AVERROR(ret);
+    w->thread_created = 1;
+
+    return 0;
+}
+
+/**
+ * Check whether copies of f, each seeing only some of the frames, output the
+ * same as f seeing all of them: f must output one frame for every input
+ * frame, without delay, and keep no state between frames.
+ */
+static int chunk_filter_supported(AVFilterContext *f)
+{
+    /* filters inserted by ffmpeg itself, which do not set
+     * AVFILTER_FLAG_FRAME_THREADS because they have no filter_frame() or
+     * can use the frame number */
+    static const char *const inserted[] = {
+        "buffer", "buffersink", "format", "null", "scale",
+    };
+    int64_t eval;
+    int i;
+
+    /* the timeline can use the frame number */
+    if (f->enable_str)
+        return 0;
+    if (f->filter->flags & AVFILTER_FLAG_FRAME_THREADS)
+        return 1;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(inserted); i++)
+        if (!strcmp(f->filter->name, inserted[i]))
+            break;
+    if (i == FF_ARRAY_ELEMS(inserted))
+        return 0;
+
+    /* scale with eval=frame evaluates its expressions for every frame */
+    if (!strcmp(f->filter->name, "scale") &&
+        (av_opt_get_int(f, "eval", AV_OPT_SEARCH_CHILDREN, &eval) < 0 || eval))
+        return 0;
+
+    return 1;
+}
+
+static const char *chunk_unsupported(InputStream *ist, OutputStream *ost)
+{
+    const AVCodecDescriptor *idesc = avcodec_descriptor_get(ist->dec_ctx->codec_id);
+    const AVCodecDescriptor *odesc = avcodec_descriptor_get(ost->enc_ctx->codec_id);
+    const AVFilterGraph *graph = ist->filters[0]->graph->graph;
+    OutputFile *of = output_files[ost->file_index];
+    int i;
+
+    if (ist->dec_ctx->codec_type != AVMEDIA_TYPE_VIDEO)
+        return "the stream is not video";
+    if (!idesc || !(idesc->props & AV_CODEC_PROP_INTRA_ONLY))
+        return "the input codec is not intra-only";
+    if (!odesc || !(odesc->props & AV_CODEC_PROP_INTRA_ONLY))
+        return "the output codec is not intra-only";
+    if (ost->enc->capabilities & AV_CODEC_CAP_DELAY)
+        return "the encoder delays its output";
+    if (ist->hwaccel_id != HWACCEL_NONE || ist->filters[0]->hw_frames_ctx)
+        return "hardware decoding is used";
+    /* the frames it still holds would be lost once the workers take over */
+    if (ist->dec_ctx->active_thread_type & FF_THREAD_FRAME)
+        return "the decoder uses frame threads";
+    if (ost->logfile)
+        return "two-pass encoding is used";
+    if (ost->enc_thread_queue_size)
+        return "an encoder thread is used";
+    /* the trim filters measure the duration from the first frame they see */
+    if (of->recording_time != INT64_MAX ||
+        input_files[ist->file_index]->recording_time != INT64_MAX)
+        return "a duration limit is set";
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+
+        if (!chunk_filter_supported(f)) {
+            av_log(NULL, AV_LOG_VERBOSE, "Filter '%s' may keep state between "
+                   "frames or not output one frame per input frame\n", f->name);
+            return "the filtergraph is not known to filter frames independently";
+        }
+    }
+
+    return NULL;
+}
+
+static OutputStream *chunk_output_stream(InputStream *ist)
+{
+    OutputStream *ost;
+
+    if (ist->nb_filters != 1 || !filtergraph_is_simple(ist->filters[0]->graph))
+        return NULL;
+
+    ost = ist->filters[0]->graph->outputs[0]->ost;
+    return ost->chunk_workers > 1 ? ost : NULL;
+}
+
+int chunk_set_decoder_opts(InputStream *ist)
+{
+    /* the workers start after the first frames are decoded on the main
+     * thread, a frame threaded decoder would hold the next ones; the workers
+     * already decode in parallel */
+    if (!chunk_output_stream(ist) ||
+        av_dict_get(ist->decoder_opts, "thread_type", NULL, 0))
+        return 0;
+    return av_dict_set(&ist->decoder_opts, "thread_type", "slice", 0);
+}
+
+/**
+ * Start the workers for ist, once the regular path has configured the
+ * filtergraph and opened the encoder.
+ *
+ * @return 0 if ist is not (yet) transcoded in chunks, 1 if the workers were
+ *         started, <0 on error
+ */
+int chunk_init(InputStream *ist)
+{
+    ChunkContext *cc;
+    OutputStream *ost;
+    InputFilter  *ifilter;
+    const char *reason;
+    int i, ret;
+
+    if (ist->chunk || !(ost = chunk_output_stream(ist)))
+        return 0;
+
+    ifilter = ist->filters[0];
+    if (!ost->initialized || ost->finished || !ifilter->graph->graph)
+        return 0;
+
+    reason = chunk_unsupported(ist, ost);
+    if (reason) {
+        av_log(NULL, AV_LOG_WARNING, "Not using chunk workers for output "
+               "stream #%d:%d: %s\n", ost->file_index, ost->index, reason);
+        ost->chunk_workers = 0;
+        return 0;
+    }
+
+    cc = av_mallocz(sizeof(*cc));
+    if (!cc)
+        return AVERROR(ENOMEM);
+    ist->chunk = cc;
+
+    cc->ist    = ist;
+    cc->ost    = ost;
+    cc->format = ifilter->format;
+    cc->width  = ifilter->width;
+    cc->height = ifilter->height;
+
+    pthread_mutex_init(&cc->lock, NULL);
+    pthread_cond_init(&cc->job_cond, NULL);
+    pthread_cond_init(&cc->done_cond, NULL);
+
+    if (!ost->chunk_pkt)
+        ost->chunk_pkt = av_packet_alloc();
+    if (!ost->chunk_last_pkt)
+        ost->chunk_last_pkt = av_packet_alloc();
+    if (!ost->chunk_pkt || !ost->chunk_last_pkt)
+        return AVERROR(ENOMEM);
+
+    /* keep every worker busy while the main thread collects the results */
+    cc->nb_jobs = 2 * ost->chunk_workers;
+    cc->jobs    = av_calloc(cc->nb_jobs, sizeof(*cc->jobs));
+    if (!cc->jobs)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < cc->nb_jobs; i++) {
+        ChunkJob *job = &cc->jobs[i];
+
+        job->in    = av_packet_alloc();
+        job->frame = av_frame_alloc();
+        job->out   = av_packet_alloc();
+        if (!job->in || !job->frame || !job->out)
+            return AVERROR(ENOMEM);
+    }
+
+    cc->workers = av_calloc(ost->chunk_workers, sizeof(*cc->workers));
+    if (!cc->workers)
+        return AVERROR(ENOMEM);
+    for (i = 0; i < ost->chunk_workers; i++) {
+        ret = chunk_worker_init(&cc->workers[i], cc);
+        cc->nb_workers++;
+        if (ret < 0) {
+            av_log(NULL, AV_LOG_ERROR, "Error starting chunk worker %d for "
+                   "output stream #%d:%d: %s\n", i, ost->file_index, ost->index,
+                   av_err2str(ret));
+            return ret;
+        }
+    }
+
+    av_log(NULL, AV_LOG_VERBOSE, "Transcoding stream #%d:%d -> #%d:%d with %d chunk workers\n",
+           ist->file_index, ist->st->index, ost->file_index, ost->index,
+           cc->nb_workers);
+
+    return 1;
+}
+
+/**
+ * Queue a packet for decoding by the next free worker.
+ *
+ * @return AVERROR(EAGAIN) if all job slots are in use and chunk_receive()
+ *         must be called first
+ */
+int chunk_send_packet(InputStream *ist, const AVPacket *pkt, int64_t pts)
+{
+    ChunkContext *cc = ist->chunk;
+    ChunkJob *job;
+    int ret;
+
+    if (cc->queued - cc->delivered == cc->nb_jobs)
+        return AVERROR(EAGAIN);
+
+    job = &cc->jobs[cc->queued % cc->nb_jobs];
+    ret = av_packet_ref(job->in, pkt);
+    if (ret < 0)
+        return ret;
+    job->pts        = pts;
+    job->decode_ret = 0;
+    job->ret        = 0;
+    job->done       = 0;
+
+    pthread_mutex_lock(&cc->lock);
+    cc->queued++;
+    pthread_cond_signal(&cc->job_cond);
+    pthread_mutex_unlock(&cc->lock);
+
+    return 0;
+}
+
+/**
+ * Get the result of the oldest queued packet.
+ *
+ * @param frame      the filtered frame, left blank if the filtergraph did not
+ *                   output a frame
+ * @param pkt        the encoded frame
+ * @param decode_ret set to the number of decoded frames or to the decoding
+ *                   error
+ * @param block      wait for the result if it is not ready yet
+ * @return 0 on success, AVERROR(EAGAIN) if the result is not ready yet,
+ *         AVERROR_EOF if no packets are queued, another negative error code
+ *         on filtering or encoding errors
+ */
+int chunk_receive(InputStream *ist, AVFrame *frame, AVPacket *pkt,
+                  int *decode_ret, int block)
+{
+    ChunkContext *cc = ist->chunk;
+    ChunkJob *job;
+    int done;
+
+    if (cc->delivered == cc->queued)
+        return AVERROR_EOF;
+
+    job = &cc->jobs[cc->delivered % cc->nb_jobs];
+
+    pthread_mutex_lock(&cc->lock);
+    while (block && !job->done)
+        pthread_cond_wait(&cc->done_cond, &cc->lock);
+    done = job->done;
+    pthread_mutex_unlock(&cc->lock);
+    if (!done)
+        return AVERROR(EAGAIN);
+
+    cc->delivered++;
+
+    *decode_ret = job->decode_ret;
+    av_frame_move_ref(frame, job->frame);
+    av_packet_move_ref(pkt, job->out);
+
+    return job->ret;
+}
+
+void chunk_uninit(InputStream *ist)
+{
+    ChunkContext *cc = ist->chunk;
+    int i;
+
+    if (!cc)
+        return;
+
+    pthread_mutex_lock(&cc->lock);
+    cc->exit = 1;
+    pthread_cond_broadcast(&cc->job_cond);
+    pthread_mutex_unlock(&cc->lock);
+
+    for (i = 0; i < cc->nb_workers; i++) {
+        ChunkWorker *w = &cc->workers[i];
+
+        if (w->thread_created)
+            pthread_join(w->thread, NULL);
+        avcodec_free_context(&w->dec);
+        avfilter_graph_free(&w->graph);
+        avcodec_free_context(&w->enc);
+        av_frame_free(&w->frame);
+    }
+    av_freep(&cc->workers);
+
+    for (i = 0; i < cc->nb_jobs; i++) {
+        ChunkJob *job = &cc->jobs[i];
+
+        av_packet_free(&job->in);
+        av_frame_free(&job->frame);
+        av_packet_free(&job->out);
+    }
+    av_freep(&cc->jobs);
+
+    pthread_cond_destroy(&cc->done_cond);
+    pthread_cond_destroy(&cc->job_cond);
+    pthread_mutex_destroy(&cc->lock);
+
+    av_freep(&ist->chunk);
+}
+
+#else
+
+int chunk_init(InputStream *ist)
+{
+    return 0;
+}
+
+int chunk_send_packet(InputStream *ist, const AVPacket *pkt, int64_t pts)
+{
+    return AVERROR(ENOSYS);
+}
+
+int chunk_receive(InputStream *ist, AVFrame *frame, AVPacket *pkt,
+                  int *decode_ret, int block)
+{
+    return AVERROR_EOF;
+}
+
+void chunk_uninit(InputStream *ist)
+{
+}
+
+#endif /* HAVE_THREADS */
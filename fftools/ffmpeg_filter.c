@@ -956,9 +956,34 @@ static int configure_input_filter(FilterGraph *fg, InputFilter *ifilter,
     }
 }
 
+void dump_filtergraph_stats(FilterGraph *fg)
+{
+    if (!filter_stats || !fg->graph)
+        return;
+
+    av_log(NULL, AV_LOG_INFO, "Filtergraph #%d statistics:\n", fg->index);
+    av_log(NULL, AV_LOG_INFO, "  %-32s %8s %8s %8s %10s %10s %6s %10s\n",
+           "filter", "in", "out", "runs", "real(ms)", "cpu(ms)", "queue", "alloc(kB)");
+    for (unsigned i = 0; i < fg->graph->nb_filters; i++) {
+        AVFilterContext *f = fg->graph->filters[i];
+        const AVFilterStats *st = avfilter_get_stats(f);
+        char cpu[16] = "N/A";
+
+        if (!st)
+            continue;
+        if (st->cpu_time >= 0)
+            snprintf(cpu, sizeof(cpu), "%.3f", st->cpu_time / 1000.0);
+        av_log(NULL, AV_LOG_INFO, "  %-32s %8"PRId64" %8"PRId64" %8"PRId64" %10.3f %10s %6"PRId64" %10"PRId64"\n",
+               f->name, st->nb_frames_in, st->nb_frames_out, st->nb_activations,
+               st->real_time / 1000.0, cpu, st->max_queued_frames,
+               st->bytes_allocated >> 10);
+    }
+}
+
 static void cleanup_filtergraph(FilterGraph *fg)
 {
     int i;
+    dump_filtergraph_stats(fg);
     for (i = 0; i < fg->nb_outputs; i++)
         fg->outputs[i]->filter = (AVFilterContext *)NULL;
     for (i = 0; i < fg->nb_inputs; i++)
@@ -1001,6 +1026,11 @@ int configure_filtergraph(FilterGraph *fg)
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
 
+    if (filter_parallel)
+        fg->graph->thread_type |= AVFILTER_THREAD_GRAPH | AVFILTER_THREAD_FRAME;
+    fg->graph->stats = filter_stats;
+    fg->graph->thread_pool = thread_pool;
+
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
         char args[512];
@@ -1166,6 +1196,54 @@ fail:
     return ret;
 }
 
+/**
+ * Build another instance of the configured simple filtergraph fg, with the
+ * same input and output parameters. fg itself is left untouched.
+ */
+int filtergraph_instantiate(FilterGraph *fg, AVFilterGraph **graph,
+                            AVFilterContext **src, AVFilterContext **sink)
+{
+    FilterGraph   copy     = *fg;
+    InputFilter   ifilter  = *fg->inputs[0];
+    OutputFilter  ofilter  = *fg->outputs[0];
+    InputFilter  *inputs[]  = { &ifilter };
+    OutputFilter *outputs[] = { &ofilter };
+    OutputStream *ost = ofilter.ost;
+    char name[255];
+    int ret;
+
+    av_assert0(filtergraph_is_simple(fg) && fg->graph);
+
+    /* the output size is set from the buffersink after configuring, but
+     * the first configuration only scaled to it if it was requested */
+    snprintf(name, sizeof(name), "scaler_out_%d_%d", ost->file_index, ost->index);
+    if (ofilter.type == AVMEDIA_TYPE_VIDEO && !avfilter_graph_get_filter(fg->graph, name))
+        ofilter.width = ofilter.height = 0;
+
+    copy.graph   = NULL;
+    copy.inputs  = inputs;
+    copy.outputs = outputs;
+
+    ifilter.eof         = 0;
+    ifilter.frame_queue = av_fifo_alloc2(1, sizeof(AVFrame*), 0);
+    if (!ifilter.frame_queue)
+        return AVERROR(ENOMEM);
+    /* overwritten from the buffersink, must not free the original */
+    memset(&ofilter.ch_layout, 0, sizeof(ofilter.ch_layout));
+
+    ret = configure_filtergraph(&copy);
+
+    av_fifo_freep2(&ifilter.frame_queue);
+    av_channel_layout_uninit(&ofilter.ch_layout);
+    if (ret < 0)
+        return ret;
+
+    *graph = copy.graph;
+    *src   = ifilter.filter;
+    *sink  = ofilter.filter;
+    return 0;
+}
+
 int ifilter_parameters_from_frame(InputFilter *ifilter, const AVFrame *frame)
 {
     AVFrameSideData *sd;
@@ -99,6 +99,8 @@ static const char *const opt_name_pass[]                      = {"pass", NULL};
 static const char *const opt_name_passlogfiles[]              = {"passlogfile", NULL};
 static const char *const opt_name_max_muxing_queue_size[]     = {"max_muxing_queue_size", NULL};
 static const char *const opt_name_muxing_queue_data_threshold[] = {"muxing_queue_data_threshold", NULL};
+static const char *const opt_name_enc_thread_queue_size[]     = {"enc_thread_queue_size", NULL};
+static const char *const opt_name_chunk_workers[]             = {"chunk_workers", NULL};
 static const char *const opt_name_guess_layout_max[]          = {"guess_layout_max", NULL};
 static const char *const opt_name_apad[]                      = {"apad", NULL};
 static const char *const opt_name_discard[]                   = {"discard", NULL};
@@ -173,6 +175,10 @@ int stdin_interaction = 1;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+int filter_parallel = 0;
+int filter_stats = 0;
+int thread_pool_size = -1;
+AVThreadPool *thread_pool;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
 int64_t stats_period = 500000;
@@ -1602,6 +1608,11 @@ static OutputStream *new_output_stream(OptionsContext *o, AVFormatContext *oc, e
     ost->muxing_queue_data_threshold = 50*1024*1024;
     MATCH_PER_STREAM_OPT(muxing_queue_data_threshold, i, ost->muxing_queue_data_threshold, oc, st);
 
+#if HAVE_THREADS
+    MATCH_PER_STREAM_OPT(enc_thread_queue_size, i, ost->enc_thread_queue_size, oc, st);
+    MATCH_PER_STREAM_OPT(chunk_workers, i, ost->chunk_workers, oc, st);
+#endif
+
     MATCH_PER_STREAM_OPT(bits_per_raw_sample, i, ost->bits_per_raw_sample,
                          oc, st);
 
@@ -3454,6 +3465,14 @@ int ffmpeg_parse_options(int argc, char **argv)
         goto fail;
     }
 
+    if (thread_pool_size >= 0) {
+        ret = av_thread_pool_alloc(&thread_pool, thread_pool_size);
+        if (ret < 0) {
+            av_log(NULL, AV_LOG_FATAL, "Error creating the thread pool: ");
+            goto fail;
+        }
+    }
+
     /* configure terminal and setup signal handlers */
     term_init();
 
@@ -3677,6 +3696,12 @@ const OptionDef options[] = {
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_threads", HAS_ARG | OPT_INT,                   { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_parallel", OPT_BOOL | OPT_EXPERT,                      { &filter_parallel },
+        "run independent filters of each filtergraph concurrently" },
+    { "filter_stats",   OPT_BOOL | OPT_EXPERT,                       { &filter_stats },
+        "print per-filter statistics when a filtergraph is freed" },
+    { "thread_pool",    OPT_INT | HAS_ARG | OPT_EXPERT,              { &thread_pool_size },
+        "run the slice threads of all codecs and filters on one pool of threads, 0 for one per CPU", "nb_threads" },
     { "lavfi",          HAS_ARG | OPT_EXPERT,                        { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
     { "filter_complex_script", HAS_ARG | OPT_EXPERT,                 { .func_arg = opt_filter_complex_script },
@@ -3888,6 +3913,10 @@ const OptionDef options[] = {
         "maximum number of packets that can be buffered while waiting for all streams to initialize", "packets" },
     { "muxing_queue_data_threshold", HAS_ARG | OPT_INT | OPT_SPEC | OPT_EXPERT | OPT_OUTPUT, { .off = OFFSET(muxing_queue_data_threshold) },
         "set the threshold after which max_muxing_queue_size is taken into account", "bytes" },
+    { "enc_thread_queue_size", HAS_ARG | OPT_INT | OPT_SPEC | OPT_EXPERT | OPT_OUTPUT, { .off = OFFSET(enc_thread_queue_size) },
+        "run the encoder in a separate thread with a queue of the given number of frames", "frames" },
+    { "chunk_workers", HAS_ARG | OPT_INT | OPT_SPEC | OPT_EXPERT | OPT_OUTPUT, { .off = OFFSET(chunk_workers) },
+        "decode, filter and encode intra-only video in the given number of parallel pipelines", "workers" },
 
     /* data codec support */
     { "dcodec", HAS_ARG | OPT_DATA | OPT_PERFILE | OPT_EXPERT | OPT_INPUT | OPT_OUTPUT, { .func_arg = opt_data_codec },
@@ -1076,6 +1076,35 @@ int opt_cpucount(void *optctx, const char *opt, const char *arg)
     return ret;
 }
 
+int opt_large_alloc(void *optctx, const char *opt, const char *arg)
+{
+    int ret;
+    int flags;
+
+    static const AVOption opts[] = {
+        {"flags",   NULL, 0, AV_OPT_TYPE_FLAGS, { .i64 = 0 }, 0, INT_MAX, .unit = "flags" },
+        {"thp",     NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_MEM_LARGE_THP     }, .unit = "flags" },
+        {"hugetlb", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_MEM_LARGE_HUGETLB }, .unit = "flags" },
+        {"numa",    NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AV_MEM_LARGE_NUMA    }, .unit = "flags" },
+        {NULL},
+    };
+    static const AVClass class = {
+        .class_name = "large_alloc",
+        .item_name  = av_default_item_name,
+        .option     = opts,
+        .version    = LIBAVUTIL_VERSION_INT,
+    };
+    const AVClass *pclass = &class;
+
+    ret = av_opt_eval_flags(&pclass, opts, arg, &flags);
+
+    if (!ret) {
+        av_mem_set_large_alloc(flags, 0);
+    }
+
+    return ret;
+}
+
 static void expand_filename_template(AVBPrint *bp, const char *template,
                                      struct tm *tm)
 {
@@ -186,6 +186,11 @@ int init_report(const char *env, FILE **file);
 
 int opt_max_alloc(void *optctx, const char *opt, const char *arg);
 
+/**
+ * Set the huge page and NUMA flags of large allocations.
+ */
+int opt_large_alloc(void *optctx, const char *opt, const char *arg);
+
 /**
  * Override the cpuflags.
  */
@@ -223,6 +228,7 @@ int opt_cpucount(void *optctx, const char *opt, const char *arg);
     { "v",           HAS_ARG,              { .func_arg = opt_loglevel },     "set logging level", "loglevel" },         \
     { "report",      0,                    { .func_arg = opt_report },       "generate a report" },                     \
     { "max_alloc",   HAS_ARG,              { .func_arg = opt_max_alloc },    "set maximum size of a single allocated block", "bytes" }, \
+    { "large_alloc", HAS_ARG | OPT_EXPERT, { .func_arg = opt_large_alloc },  "set how large buffers are allocated", "flags" }, \
     { "cpuflags",    HAS_ARG | OPT_EXPERT, { .func_arg = opt_cpuflags },     "force specific cpu flags", "flags" },     \
     { "cpucount",    HAS_ARG | OPT_EXPERT, { .func_arg = opt_cpucount },     "force specific cpu count", "count" },     \
     { "hide_banner", OPT_BOOL | OPT_EXPERT, {&hide_banner},     "do not show program banner", "hide_banner" },          \
@@ -486,6 +486,8 @@ av_cold int avcodec_close(AVCodecContext *avctx)
         }
         if (HAVE_THREADS && avci->thread_ctx)
             ff_thread_free(avctx);
+        if (HAVE_THREADS)
+            ff_thread_stats_free(avctx);
         if (avci->needs_close && ffcodec(avctx->codec)->close)
             ffcodec(avctx->codec)->close(avctx);
         avci->byte_buffer_size = 0;
@@ -749,3 +751,10 @@ int avcodec_is_open(AVCodecContext *s)
 {
     return !!s->internal;
 }
+
+const AVCodecThreadStats *avcodec_get_thread_stats(AVCodecContext *avctx)
+{
+    if (!HAVE_THREADS || !avctx->internal)
+        return NULL;
+    return ff_thread_get_stats(avctx);
+}
@@ -2055,6 +2055,28 @@ typedef struct AVCodecContext {
      *             The decoder can then override during decoding as needed.
      */
     AVChannelLayout ch_layout;
+
+    /**
+     * Collect statistics on the threading of the codec, see
+     * avcodec_get_thread_stats().
+     * - encoding: Set by user before avcodec_open2().
+     * - decoding: Set by user before avcodec_open2().
+     */
+    int thread_stats;
+
+    /**
+     * Thread pool to run the slice threading jobs on, instead of threads
+     * created for this context. thread_count still limits the number of
+     * threads working on the frame at once. The codec keeps a reference to
+     * the pool, which may be freed by the user after avcodec_open2().
+     *
+     * Frame threading and codecs running a main function alongside their
+     * slice jobs keep using threads of their own.
+     *
+     * - encoding: Set by user before avcodec_open2().
+     * - decoding: Set by user before avcodec_open2().
+     */
+    struct AVThreadPool *thread_pool;
 } AVCodecContext;
 
 /**
@@ -3163,6 +3185,101 @@ void av_fast_padded_mallocz(void *ptr, unsigned int *size, size_t min_size);
  */
 int avcodec_is_open(AVCodecContext *s);
 
+/**
+ * Number of buckets of the histograms of AVCodecThreadStats. Bucket 0
+ * counts the durations under 2 microseconds, bucket i > 0 those from 2^i to
+ * 2^(i+1) - 1 microseconds, and the last bucket also counts all the longer
+ * ones.
+ */
+#define AV_CODEC_THREAD_STATS_HIST_SIZE 24
+
+/**
+ * Statistics collected by the threading of a codec when
+ * AVCodecContext.thread_stats is set. All the times are in microseconds of
+ * wall clock time.
+ *
+ * sizeof(AVCodecThreadStats) is not a part of the public ABI, new fields may
+ * be added at the end with a minor version bump.
+ */
+typedef struct AVCodecThreadStats {
+    /**
+     * Number of threads, the size of the per-thread arrays.
+     */
+    int nb_threads;
+
+    /**
+     * Number of frames decoded or encoded by frame threads.
+     */
+    int64_t nb_frames;
+
+    /**
+     * Time spent decoding or encoding frames in frame threads, waits for
+     * other threads included.
+     */
+    int64_t frame_time;
+
+    /**
+     * Histogram of the time spent on each frame in frame threads.
+     */
+    int64_t frame_time_hist[AV_CODEC_THREAD_STATS_HIST_SIZE];
+
+    /**
+     * Time the caller waited, when submitting a packet to a decoding
+     * thread, for the previous thread to finish its setup.
+     */
+    int64_t submit_wait_time;
+
+    /**
+     * Time the caller waited for frame threads to output a frame or a
+     * packet.
+     */
+    int64_t output_wait_time;
+
+    /**
+     * Number of times and total time decoding threads waited for the
+     * progress of other threads on reference frames.
+     */
+    int64_t nb_progress_waits;
+    int64_t progress_wait_time;
+
+    /**
+     * Histogram of the durations of the waits for progress.
+     */
+    int64_t progress_wait_hist[AV_CODEC_THREAD_STATS_HIST_SIZE];
+
+    /**
+     * Number of execute() and execute2() calls run by slice threads and the
+     * total number of jobs they ran.
+     */
+    int64_t nb_executes;
+    int64_t nb_jobs;
+
+    /**
+     * Time each thread spent running frames (frame threading) or jobs
+     * (slice threading), nb_threads entries.
+     */
+    int64_t *thread_busy_time;
+
+    /**
+     * Number of frames (frame threading) or jobs (slice threading) run by
+     * each thread, nb_threads entries.
+     */
+    int64_t *thread_nb_jobs;
+} AVCodecThreadStats;
+
+/**
+ * Get the threading statistics of a codec.
+ *
+ * This function may be called while the codec is running; frames and jobs
+ * in progress are then not accounted yet.
+ *
+ * @param avctx an opened codec context with AVCodecContext.thread_stats set
+ * @return statistics owned by the context, updated by this function and
+ *         valid until the context is closed, or NULL if no statistics are
+ *         collected, e.g. because the codec does not use threads
+ */
+const AVCodecThreadStats *avcodec_get_thread_stats(AVCodecContext *avctx);
+
 /**
  * @}
  */
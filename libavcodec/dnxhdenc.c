@@ -116,94 +116,41 @@ void dnxhd_10bit_get_pixels_8x4_sym(int16_t *av_restrict block,
     memcpy(block + 4 * 8, pixels + 3 * line_size, 8 * sizeof(*block));
 }
 
-static int dnxhd_10bit_dct_quantize_444(MpegEncContext *ctx, int16_t *block,
-                                        int n, int qscale, int *overflow)
+static int dnxhd_quantize_count_c(int16_t *block, const int *qmat,
+                                  const uint8_t *scantable, int bias, int shift,
+                                  const uint8_t *vlc_bits, const uint8_t *run_bits,
+                                  int *bits)
 {
-    int i, j, level, last_non_zero, start_i;
-    const int *qmat;
-    const uint8_t *scantable= ctx->intra_scantable.scantable;
-    int bias;
-    int max = 0;
-    unsigned int threshold1, threshold2;
-
-    ctx->fdsp.fdct(block);
-
-    block[0] = (block[0] + 2) >> 2;
-    start_i = 1;
-    last_non_zero = 0;
-    qmat = n < 4 ? ctx->q_intra_matrix[qscale] : ctx->q_chroma_intra_matrix[qscale];
-    bias= ctx->intra_quant_bias * (1 << (16 - 8));
-    threshold1 = (1 << 16) - bias - 1;
-    threshold2 = (threshold1 << 1);
+    const unsigned threshold1 = (1 << shift) - bias - 1;
+    const unsigned threshold2 = threshold1 << 1;
+    int last_non_zero = 0;
+    int count = 0;
+    int i;
 
-    for (i = 63; i >= start_i; i--) {
-        j = scantable[i];
-        level = block[j] * qmat[j];
+    for (i = 1; i < 64; i++) {
+        int j     = scantable[i];
+        int level = block[j] * qmat[j];
 
         if (((unsigned)(level + threshold1)) > threshold2) {
+            int run_level = i - last_non_zero - 1;
+            if (level > 0)
+                level =   (bias + level) >> shift;
+            else
+                level = -((bias - level) >> shift);
+            block[j] = level;
+            count += vlc_bits[level * (1 << 1) | !!run_level] + run_bits[run_level];
             last_non_zero = i;
-            break;
-        } else{
-            block[j]=0;
-        }
-    }
-
-    for (i = start_i; i <= last_non_zero; i++) {
-        j = scantable[i];
-        level = block[j] * qmat[j];
-
-        if (((unsigned)(level + threshold1)) > threshold2) {
-            if (level > 0) {
-                level = (bias + level) >> 16;
-                block[j] = level;
-            } else{
-                level = (bias - level) >> 16;
-                block[j] = -level;
-            }
-            max |= level;
         } else {
             block[j] = 0;
         }
     }
-    *overflow = ctx->max_qcoeff < max; //overflow might have happened
-
-    /* we need this permutation so that we correct the IDCT, we only permute the !=0 elements */
-    if (ctx->idsp.perm_type != FF_IDCT_PERM_NONE)
-        ff_block_permute(block, ctx->idsp.idct_permutation,
-                         scantable, last_non_zero);
-
+    *bits = count;
     return last_non_zero;
 }
 
-static int dnxhd_10bit_dct_quantize(MpegEncContext *ctx, int16_t *block,
-                                    int n, int qscale, int *overflow)
+av_cold void ff_dnxhdencdsp_init(DNXHDEncDSPContext *c)
 {
-    const uint8_t *scantable= ctx->intra_scantable.scantable;
-    const int *qmat = n<4 ? ctx->q_intra_matrix[qscale] : ctx->q_chroma_intra_matrix[qscale];
-    int last_non_zero = 0;
-    int i;
-
-    ctx->fdsp.fdct(block);
-
-    // Divide by 4 with rounding, to compensate scaling of DCT coefficients
-    block[0] = (block[0] + 2) >> 2;
-
-    for (i = 1; i < 64; ++i) {
-        int j = scantable[i];
-        int sign = FF_SIGNBIT(block[j]);
-        int level = (block[j] ^ sign) - sign;
-        level = level * qmat[j] >> DNX10BIT_QMAT_SHIFT;
-        block[j] = (level ^ sign) - sign;
-        if (level)
-            last_non_zero = i;
-    }
-
-    /* we need this permutation so that we correct the IDCT, we only permute the !=0 elements */
-    if (ctx->idsp.perm_type != FF_IDCT_PERM_NONE)
-        ff_block_permute(block, ctx->idsp.idct_permutation,
-                         scantable, last_non_zero);
-
-    return last_non_zero;
+    c->quantize_count = dnxhd_quantize_count_c;
 }
 
 static av_cold int dnxhd_init_vlc(DNXHDEncContext *ctx)
@@ -339,6 +286,11 @@ static av_cold int dnxhd_init_rc(DNXHDEncContext *ctx)
     if (!FF_ALLOCZ_TYPED_ARRAY(ctx->mb_rc, (ctx->m.avctx->qmax + 1) * ctx->m.mb_num))
         return AVERROR(ENOMEM);
 
+    // 8-bit content keeps using the optimized mpegvideo quantizers directly
+    if (ctx->bit_depth == 10 &&
+        !FF_ALLOCZ_TYPED_ARRAY(ctx->dct_blocks, (8 + 4 * ctx->is_444) * ctx->m.mb_num))
+        return AVERROR(ENOMEM);
+
     if (ctx->m.avctx->mb_decision != FF_MB_DECISION_RD) {
         if (!FF_ALLOCZ_TYPED_ARRAY(ctx->mb_cmp,     ctx->m.mb_num) ||
             !FF_ALLOCZ_TYPED_ARRAY(ctx->mb_cmp_tmp, ctx->m.mb_num))
@@ -425,6 +377,7 @@ static av_cold int dnxhd_encode_init(AVCodecContext *avctx)
     ff_mpegvideoencdsp_init(&ctx->m.mpvencdsp, avctx);
     ff_pixblockdsp_init(&ctx->m.pdsp, avctx);
     ff_dct_encode_init(&ctx->m);
+    ff_dnxhdencdsp_init(&ctx->dsp);
 
     if (ctx->profile != FF_PROFILE_DNXHD)
         ff_videodsp_init(&ctx->m.vdsp, ctx->bit_depth);
@@ -433,11 +386,12 @@ static av_cold int dnxhd_encode_init(AVCodecContext *avctx)
         ctx->m.dct_quantize = ff_dct_quantize_c;
 
     if (ctx->is_444 || ctx->profile == FF_PROFILE_DNXHR_HQX) {
-        ctx->m.dct_quantize     = dnxhd_10bit_dct_quantize_444;
+        ctx->quant_shift        = 16;
+        ctx->quant_bias         = ctx->m.intra_quant_bias * (1 << (16 - 8));
         ctx->get_pixels_8x4_sym = dnxhd_10bit_get_pixels_8x4_sym;
         ctx->block_width_l2     = 4;
     } else if (ctx->bit_depth == 10) {
-        ctx->m.dct_quantize     = dnxhd_10bit_dct_quantize;
+        ctx->quant_shift        = DNX10BIT_QMAT_SHIFT;
         ctx->get_pixels_8x4_sym = dnxhd_10bit_get_pixels_8x4_sym;
         ctx->block_width_l2     = 4;
     } else {
@@ -818,12 +772,86 @@ int dnxhd_switch_matrix(DNXHDEncContext *ctx, int i)
     return x;
 }
 
+static av_always_inline
+const int *dnxhd_get_qmat(DNXHDEncContext *ctx, int n, int qscale)
+{
+    return n ? ctx->m.q_chroma_intra_matrix[qscale] : ctx->m.q_intra_matrix[qscale];
+}
+
+static av_always_inline
+void dnxhd_transform_blocks(DNXHDEncContext *ctx, int16_t (*dct_blocks)[64],
+                            int histogram)
+{
+    int i, j;
+
+    for (i = 0; i < 8 + 4 * ctx->is_444; i++) {
+        int16_t *block = dct_blocks[i];
+
+        memcpy(block, ctx->blocks[i], 64 * sizeof(*block));
+        ctx->m.fdsp.fdct(block);
+
+        if (histogram) {
+            const int *qmat = dnxhd_get_qmat(ctx, dnxhd_switch_matrix(ctx, i), 1);
+            for (j = 1; j < 64; j++) {
+                int level = (FFABS(block[j]) * qmat[j]) >> ctx->quant_shift;
+                if (level)
+                    ctx->level_hist[FFMIN(level, DNXHD_LEVEL_HIST_SIZE - 1)]++;
+            }
+        }
+    }
+}
+
+/**
+ * Quantize block i of the current macroblock into block, with the non-zero
+ * coefficients permuted for the IDCT, and return its last scan index.
+ * dct_block holds the cached transform of the block, or is NULL if the
+ * pixels in ctx->blocks have to be transformed. The AC bits are counted if
+ * bits is not NULL.
+ */
+static av_always_inline
+int dnxhd_quantize_block(DNXHDEncContext *ctx, int16_t *block,
+                         const int16_t *dct_block, int i, int qscale, int *bits)
+{
+    int n = dnxhd_switch_matrix(ctx, i);
+    int last_index, count;
+
+    if (!dct_block) {
+        int overflow;
+
+        memcpy(block, ctx->blocks[i], 64 * sizeof(*block));
+        last_index = ctx->m.dct_quantize(&ctx->m, block, 4 * !!n,
+                                         qscale, &overflow);
+        if (bits)
+            *bits = dnxhd_calc_ac_bits(ctx, block, last_index);
+        return last_index;
+    }
+
+    memcpy(block, dct_block, 64 * sizeof(*block));
+    // Divide by 4 with rounding, to compensate scaling of DCT coefficients
+    block[0] = (block[0] + 2) >> 2;
+    last_index = ctx->dsp.quantize_count(block, dnxhd_get_qmat(ctx, n, qscale),
+                                         ctx->m.intra_scantable.scantable,
+                                         ctx->quant_bias, ctx->quant_shift,
+                                         ctx->vlc_bits, ctx->run_bits, &count);
+    if (bits)
+        *bits = count;
+
+    /* we need this permutation so that we correct the IDCT, we only permute the !=0 elements */
+    if (ctx->m.idsp.perm_type != FF_IDCT_PERM_NONE)
+        ff_block_permute(block, ctx->m.idsp.idct_permutation,
+                         ctx->m.intra_scantable.scantable, last_index);
+
+    return last_index;
+}
+
 static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
                                   int jobnr, int threadnr)
 {
     DNXHDEncContext *ctx = avctx->priv_data;
     int mb_y = jobnr, mb_x;
     int qscale = ctx->qscale;
+    int transform = !ctx->dct_blocks_valid;
+    int rd = avctx->mb_decision == FF_MB_DECISION_RD || !RC_VARIANCE;
     LOCAL_ALIGNED_16(int16_t, block, [64]);
     ctx = ctx->thread[threadnr];
 
@@ -833,23 +861,27 @@ static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
 
     for (mb_x = 0; mb_x < ctx->m.mb_width; mb_x++) {
         unsigned mb = mb_y * ctx->m.mb_width + mb_x;
+        int16_t (*dct_blocks)[64] = NULL;
         int ssd     = 0;
         int ac_bits = 0;
         int dc_bits = 0;
         int i;
 
-        dnxhd_get_blocks(ctx, mb_x, mb_y);
+        if (ctx->dct_blocks)
+            dct_blocks = ctx->dct_blocks + (8 + 4 * ctx->is_444) * mb;
+        if (!dct_blocks || transform || rd)
+            dnxhd_get_blocks(ctx, mb_x, mb_y);
+        if (dct_blocks && transform)
+            dnxhd_transform_blocks(ctx, dct_blocks, !rd);
 
         for (i = 0; i < 8 + 4 * ctx->is_444; i++) {
-            int16_t *src_block = ctx->blocks[i];
-            int overflow, nbits, diff, last_index;
+            int nbits, diff, last_index, bits;
             int n = dnxhd_switch_matrix(ctx, i);
 
-            memcpy(block, src_block, 64 * sizeof(*block));
-            last_index = ctx->m.dct_quantize(&ctx->m, block,
-                                             ctx->is_444 ? 4 * (n > 0): 4 & (2*i),
-                                             qscale, &overflow);
-            ac_bits   += dnxhd_calc_ac_bits(ctx, block, last_index);
+            last_index = dnxhd_quantize_block(ctx, block,
+                                              dct_blocks ? dct_blocks[i] : NULL,
+                                              i, qscale, &bits);
+            ac_bits   += bits;
 
             diff = block[0] - ctx->m.last_dc[n];
             if (diff < 0)
@@ -862,10 +894,10 @@ static int dnxhd_calc_bits_thread(AVCodecContext *avctx, void *arg,
 
             ctx->m.last_dc[n] = block[0];
 
-            if (avctx->mb_decision == FF_MB_DECISION_RD || !RC_VARIANCE) {
+            if (rd) {
                 dnxhd_unquantize_c(ctx, block, i, qscale, last_index);
                 ctx->m.idsp.idct(block);
-                ssd += dnxhd_ssd_block(block, src_block);
+                ssd += dnxhd_ssd_block(block, ctx->blocks[i]);
             }
         }
         ctx->mb_rc[(qscale * ctx->m.mb_num) + mb].ssd  = ssd;
@@ -880,6 +912,7 @@ static int dnxhd_encode_thread(AVCodecContext *avctx, void *arg,
 {
     DNXHDEncContext *ctx = avctx->priv_data;
     int mb_y = jobnr, mb_x;
+    LOCAL_ALIGNED_16(int16_t, block, [64]);
     ctx = ctx->thread[threadnr];
     init_put_bits(&ctx->m.pb, (uint8_t *)arg + ctx->data_offset + ctx->slice_offs[jobnr],
                   ctx->slice_size[jobnr]);
@@ -889,20 +922,23 @@ static int dnxhd_encode_thread(AVCodecContext *avctx, void *arg,
     ctx->m.last_dc[2] = 1 << (ctx->bit_depth + 2);
     for (mb_x = 0; mb_x < ctx->m.mb_width; mb_x++) {
         unsigned mb = mb_y * ctx->m.mb_width + mb_x;
+        int16_t (*dct_blocks)[64] = NULL;
         int qscale = ctx->mb_qscale[mb];
         int i;
 
         put_bits(&ctx->m.pb, 11, qscale);
         put_bits(&ctx->m.pb, 1, avctx->pix_fmt == AV_PIX_FMT_YUV444P10);
 
-        dnxhd_get_blocks(ctx, mb_x, mb_y);
+        if (ctx->dct_blocks)
+            dct_blocks = ctx->dct_blocks + (8 + 4 * ctx->is_444) * mb;
+        else
+            dnxhd_get_blocks(ctx, mb_x, mb_y);
 
         for (i = 0; i < 8 + 4 * ctx->is_444; i++) {
-            int16_t *block = ctx->blocks[i];
-            int overflow, n = dnxhd_switch_matrix(ctx, i);
-            int last_index = ctx->m.dct_quantize(&ctx->m, block,
-                                                 ctx->is_444 ? (((i >> 1) % 3) < 1 ? 0 : 4): 4 & (2*i),
-                                                 qscale, &overflow);
+            int n = dnxhd_switch_matrix(ctx, i);
+            int last_index = dnxhd_quantize_block(ctx, block,
+                                                  dct_blocks ? dct_blocks[i] : NULL,
+                                                  i, qscale, NULL);
 
             dnxhd_encode_block(ctx, block, last_index, n);
         }
@@ -1001,17 +1037,36 @@ static int dnxhd_mb_var_thread(AVCodecContext *avctx, void *arg,
     return 0;
 }
 
+static void dnxhd_calc_bits(DNXHDEncContext *ctx, int qscale)
+{
+    AVCodecContext *avctx = ctx->m.avctx;
+    int i, j;
+
+    if (!ctx->dct_blocks_valid) {
+        for (i = 0; i < avctx->thread_count; i++)
+            memset(ctx->thread[i]->level_hist, 0, sizeof(ctx->level_hist));
+    }
+
+    ctx->qscale = qscale;
+    avctx->execute2(avctx, dnxhd_calc_bits_thread,
+                    NULL, NULL, ctx->m.mb_height);
+
+    if (!ctx->dct_blocks_valid) {
+        for (i = 1; i < avctx->thread_count; i++)
+            for (j = 0; j < DNXHD_LEVEL_HIST_SIZE; j++)
+                ctx->level_hist[j] += ctx->thread[i]->level_hist[j];
+        ctx->dct_blocks_valid = 1;
+    }
+}
+
 static int dnxhd_encode_rdo(AVCodecContext *avctx, DNXHDEncContext *ctx)
 {
     int lambda, up_step, down_step;
     int last_lower = INT_MAX, last_higher = 0;
     int x, y, q;
 
-    for (q = 1; q < avctx->qmax; q++) {
-        ctx->qscale = q;
-        avctx->execute2(avctx, dnxhd_calc_bits_thread,
-                        NULL, NULL, ctx->m.mb_height);
-    }
+    for (q = 1; q < avctx->qmax; q++)
+        dnxhd_calc_bits(ctx, q);
     up_step = down_step = 2 << LAMBDA_FRAC_BITS;
     lambda  = ctx->lambda;
 
@@ -1078,6 +1133,47 @@ static int dnxhd_encode_rdo(AVCodecContext *avctx, DNXHDEncContext *ctx)
     return 0;
 }
 
+static int64_t dnxhd_estimate_ac_bits(DNXHDEncContext *ctx, int qscale)
+{
+    int max_level = (1 << (ctx->bit_depth + 2)) - 1;
+    int64_t bits = 0;
+    int i;
+
+    for (i = qscale; i < DNXHD_LEVEL_HIST_SIZE; i++) {
+        int level = FFMIN(i / qscale, max_level);
+        bits += (int64_t)ctx->level_hist[i] *
+                (ctx->vlc_bits[level * (1 << 1)] + ctx->run_bits[0]);
+    }
+    return bits;
+}
+
+/**
+ * Predict the smallest qscale that fits the frame, by rescaling the AC
+ * level histogram and anchoring it to the exact size at the given qscale.
+ */
+static int dnxhd_predict_qscale(DNXHDEncContext *ctx, int qscale)
+{
+    int64_t bits = 0;
+    int low = 1, high = ctx->m.avctx->qmax - 1;
+    int x, y;
+
+    for (y = 0; y < ctx->m.mb_height; y++) {
+        for (x = 0; x < ctx->m.mb_width; x++)
+            bits += ctx->mb_rc[(qscale*ctx->m.mb_num) + (y*ctx->m.mb_width+x)].bits;
+        bits = (bits+31)&~31; // padding
+    }
+    bits -= dnxhd_estimate_ac_bits(ctx, qscale);
+
+    while (low < high) {
+        int mid = (low + high) >> 1;
+        if (bits + dnxhd_estimate_ac_bits(ctx, mid) < ctx->frame_bits)
+            high = mid;
+        else
+            low = mid + 1;
+    }
+    return low;
+}
+
 static int dnxhd_find_qscale(DNXHDEncContext *ctx)
 {
     int bits = 0;
@@ -1091,10 +1187,7 @@ static int dnxhd_find_qscale(DNXHDEncContext *ctx)
     qscale = ctx->qscale;
     for (;;) {
         bits = 0;
-        ctx->qscale = qscale;
-        // XXX avoid recalculating bits
-        ctx->m.avctx->execute2(ctx->m.avctx, dnxhd_calc_bits_thread,
-                               NULL, NULL, ctx->m.mb_height);
+        dnxhd_calc_bits(ctx, qscale);
         for (y = 0; y < ctx->m.mb_height; y++) {
             for (x = 0; x < ctx->m.mb_width; x++)
                 bits += ctx->mb_rc[(qscale*ctx->m.mb_num) + (y*ctx->m.mb_width+x)].bits;
@@ -1112,6 +1205,8 @@ static int dnxhd_find_qscale(DNXHDEncContext *ctx)
             last_lower = FFMIN(qscale, last_lower);
             if (last_higher != 0)
                 qscale = (qscale + last_higher) >> 1;
+            else if (ctx->dct_blocks)
+                qscale = FFMIN(qscale - 1, dnxhd_predict_qscale(ctx, qscale));
             else
                 qscale -= down_step++;
             if (qscale < 1)
@@ -1123,6 +1218,8 @@ static int dnxhd_find_qscale(DNXHDEncContext *ctx)
             last_higher = FFMAX(qscale, last_higher);
             if (last_lower != INT_MAX)
                 qscale = (qscale + last_lower) >> 1;
+            else if (ctx->dct_blocks)
+                qscale = FFMAX(qscale + 1, dnxhd_predict_qscale(ctx, qscale) - 1);
             else
                 qscale += up_step++;
             down_step = 1;
@@ -1268,6 +1365,7 @@ static int dnxhd_encode_picture(AVCodecContext *avctx, AVPacket *pkt,
     dnxhd_load_picture(ctx, frame);
 
 encode_coding_unit:
+    ctx->dct_blocks_valid = 0;
     for (i = 0; i < 3; i++) {
         ctx->src[i] = frame->data[i];
         if (ctx->interlaced && ctx->cur_field)
@@ -1331,6 +1429,7 @@ static av_cold int dnxhd_encode_end(AVCodecContext *avctx)
     av_freep(&ctx->mb_rc);
     av_freep(&ctx->mb_cmp);
     av_freep(&ctx->mb_cmp_tmp);
+    av_freep(&ctx->dct_blocks);
     av_freep(&ctx->slice_size);
     av_freep(&ctx->slice_offs);
 
@@ -43,9 +43,34 @@ typedef struct RCEntry {
     int bits;
 } RCEntry;
 
+#define DNXHD_LEVEL_HIST_SIZE 2048
+
+typedef struct DNXHDEncDSPContext {
+    /**
+     * Dead-zone quantize the AC coefficients of a forward transformed 8x8
+     * block in place and count the bits needed to code them.
+     *
+     * @param block     transformed coefficients in natural order; on return
+     *                  the AC coefficients hold the quantized levels
+     * @param qmat      quantization multipliers for the current qscale
+     * @param scantable zigzag scan order, not permuted
+     * @param bias      rounding bias, scaled by 1 << shift
+     * @param shift     fixed-point precision of qmat
+     * @param vlc_bits  AC code lengths indexed by level * 2 | (run != 0)
+     * @param run_bits  zero run code lengths
+     * @param bits      set to the number of bits needed by the AC coefficients
+     * @return scan index of the last non-zero coefficient, 0 if there is none
+     */
+    int (*quantize_count)(int16_t *block, const int *qmat,
+                          const uint8_t *scantable, int bias, int shift,
+                          const uint8_t *vlc_bits, const uint8_t *run_bits,
+                          int *bits);
+} DNXHDEncDSPContext;
+
 typedef struct DNXHDEncContext {
     AVClass *class;
     BlockDSPContext bdsp;
+    DNXHDEncDSPContext dsp;
     MpegEncContext m; ///< Used for quantization dsp functions
 
     int cid;
@@ -107,10 +132,24 @@ typedef struct DNXHDEncContext {
     RCCMPEntry *mb_cmp_tmp;
     RCEntry    *mb_rc;
 
+    /**
+     * Forward transformed blocks of the current coding unit, filled by the
+     * first rate control pass and reused by all later passes.
+     */
+    int16_t (*dct_blocks)[64];
+    int dct_blocks_valid;
+    int quant_bias;
+    int quant_shift;
+
+    /** Histogram of the AC levels at qscale 1, used to seed the qscale search */
+    unsigned level_hist[DNXHD_LEVEL_HIST_SIZE];
+
     void (*get_pixels_8x4_sym)(int16_t *av_restrict /* align 16 */ block,
                                const uint8_t *pixels, ptrdiff_t line_size);
 } DNXHDEncContext;
 
+void ff_dnxhdencdsp_init(DNXHDEncDSPContext *c);
+
 void ff_dnxhdenc_init_x86(DNXHDEncContext *ctx);
 
 #endif /* AVCODEC_DNXHDENC_H */
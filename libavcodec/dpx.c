@@ -27,7 +27,26 @@
 #include "bytestream.h"
 #include "avcodec.h"
 #include "codec_internal.h"
+#include "dpxdsp.h"
 #include "internal.h"
+#include "thread.h"
+
+typedef struct DPXDecContext {
+    DPXDSPContext dsp;
+} DPXDecContext;
+
+typedef struct DPXThreadData {
+    AVFrame *frame;
+    const uint8_t *buf;     ///< start of the image data
+    int stride;             ///< distance between two lines in buf
+    int need_align;         ///< padding after each line in buf
+    int slice_height;
+    int bits_per_color;
+    int elements;
+    int packing;
+    int endian;
+    int unpadded_10bit;     ///< lines are not aligned to 32-bit words
+} DPXThreadData;
 
 enum DPX_TRC {
     DPX_TRC_USER_DEFINED       = 0,
@@ -150,6 +169,120 @@ static uint16_t read12in32(const uint8_t **ptr, uint32_t *lbuf,
     }
 }
 
+static void unpack_10bit_line(const DPXDecContext *s, const DPXThreadData *td,
+                              uint16_t *dst[4], const uint8_t **buf,
+                              uint32_t *rgbBuffer, int *n_datum, int width)
+{
+    int elements = td->elements, endian = td->endian;
+    int shift = elements > 1 ? td->packing == 1 ? 22 : 20 : td->packing == 1 ? 2 : 0;
+    int x;
+
+    /* fast paths for lines starting at a word boundary */
+    if (!*n_datum && elements == 3) {
+        s->dsp.unpack_rgb10[endian](dst[0], dst[1], dst[2], *buf, shift, width);
+        *buf += 4 * width;
+        return;
+    }
+    if (!*n_datum && elements == 1 && !td->unpadded_10bit) {
+        s->dsp.unpack_gray10[endian](dst[0], *buf, shift, width);
+        *buf += (width + 2) / 3 * 4;
+        return;
+    }
+
+    for (x = 0; x < width; x++) {
+        if (elements >= 3)
+            *dst[2]++ = read10in32(buf, rgbBuffer,
+                                   n_datum, endian, shift);
+        if (elements == 1)
+            *dst[0]++ = read10in32_gray(buf, rgbBuffer,
+                                        n_datum, endian, shift);
+        else
+            *dst[0]++ = read10in32(buf, rgbBuffer,
+                                   n_datum, endian, shift);
+        if (elements >= 2)
+            *dst[1]++ = read10in32(buf, rgbBuffer,
+                                   n_datum, endian, shift);
+        if (elements == 4)
+            *dst[3]++ =
+            read10in32(buf, rgbBuffer,
+                       n_datum, endian, shift);
+    }
+}
+
+static void unpack_12bit_line(const DPXThreadData *td, uint16_t *dst[4],
+                              const uint8_t **buf, uint32_t *rgbBuffer,
+                              int *n_datum, int width)
+{
+    int elements = td->elements, endian = td->endian;
+    int shift = td->packing == 1 ? 4 : 0;
+    int x;
+
+    for (x = 0; x < width; x++) {
+        if (td->packing) {
+            if (elements >= 3)
+                *dst[2]++ = read16(buf, endian) >> shift & 0xFFF;
+            *dst[0]++ = read16(buf, endian) >> shift & 0xFFF;
+            if (elements >= 2)
+                *dst[1]++ = read16(buf, endian) >> shift & 0xFFF;
+            if (elements == 4)
+                *dst[3]++ = read16(buf, endian) >> shift & 0xFFF;
+        } else {
+            if (elements >= 3)
+                *dst[2]++ = read12in32(buf, rgbBuffer,
+                                       n_datum, endian);
+            *dst[0]++ = read12in32(buf, rgbBuffer,
+                                   n_datum, endian);
+            if (elements >= 2)
+                *dst[1]++ = read12in32(buf, rgbBuffer,
+                                       n_datum, endian);
+            if (elements == 4)
+                *dst[3]++ = read12in32(buf, rgbBuffer,
+                                       n_datum, endian);
+        }
+    }
+}
+
+static int unpack_slice(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    const DPXDecContext *s = avctx->priv_data;
+    const DPXThreadData *td = arg;
+    const AVFrame *p = td->frame;
+    int y0 = jobnr * td->slice_height;
+    int y1 = FFMIN(y0 + td->slice_height, avctx->height);
+    const uint8_t *buf = td->buf + (ptrdiff_t)y0 * td->stride;
+    uint32_t rgbBuffer = 0;
+    int n_datum = 0;
+
+    for (int y = y0; y < y1; y++) {
+        uint16_t *dst[4];
+
+        for (int i = 0; i < 4; i++)
+            dst[i] = (uint16_t *)(p->data[i] + (ptrdiff_t)y * p->linesize[i]);
+
+        if (td->bits_per_color == 10) {
+            unpack_10bit_line(s, td, dst, &buf, &rgbBuffer, &n_datum, avctx->width);
+            if (!td->unpadded_10bit)
+                n_datum = 0;
+        } else {
+            unpack_12bit_line(td, dst, &buf, &rgbBuffer, &n_datum, avctx->width);
+            n_datum = 0;
+            // Jump to next aligned position
+            buf += td->need_align;
+        }
+    }
+
+    return 0;
+}
+
+static av_cold int decode_init(AVCodecContext *avctx)
+{
+    DPXDecContext *s = avctx->priv_data;
+
+    ff_dpxdsp_init(&s->dsp);
+
+    return 0;
+}
+
 static int decode_frame(AVCodecContext *avctx, AVFrame *p,
                         int *got_frame, AVPacket *avpkt)
 {
@@ -167,9 +300,6 @@ static int decode_frame(AVCodecContext *avctx, AVFrame *p,
     int yuv, color_trc, color_spec;
     int encoding, need_align = 0, unpadded_10bit = 0;
 
-    unsigned int rgbBuffer = 0;
-    int n_datum = 0;
-
     if (avpkt->size <= 1634) {
         av_log(avctx, AV_LOG_ERROR, "Packet too small for DPX header\n");
         return AVERROR_INVALIDDATA;
@@ -607,7 +737,7 @@ static int decode_frame(AVCodecContext *avctx, AVFrame *p,
 
     ff_set_sar(avctx, avctx->sample_aspect_ratio);
 
-    if ((ret = ff_get_buffer(avctx, p, 0)) < 0)
+    if ((ret = ff_thread_get_buffer(avctx, p, 0)) < 0)
         return ret;
 
     av_strlcpy(creator, avpkt->data + 160, 100);
@@ -632,73 +762,27 @@ static int decode_frame(AVCodecContext *avctx, AVFrame *p,
 
     switch (bits_per_color) {
     case 10:
-        for (x = 0; x < avctx->height; x++) {
-            uint16_t *dst[4] = {(uint16_t*)ptr[0],
-                                (uint16_t*)ptr[1],
-                                (uint16_t*)ptr[2],
-                                (uint16_t*)ptr[3]};
-            int shift = elements > 1 ? packing == 1 ? 22 : 20 : packing == 1 ? 2 : 0;
-            for (y = 0; y < avctx->width; y++) {
-                if (elements >= 3)
-                    *dst[2]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements == 1)
-                    *dst[0]++ = read10in32_gray(&buf, &rgbBuffer,
-                                                &n_datum, endian, shift);
-                else
-                    *dst[0]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements >= 2)
-                    *dst[1]++ = read10in32(&buf, &rgbBuffer,
-                                           &n_datum, endian, shift);
-                if (elements == 4)
-                    *dst[3]++ =
-                    read10in32(&buf, &rgbBuffer,
-                               &n_datum, endian, shift);
-            }
-            if (!unpadded_10bit)
-                n_datum = 0;
-            for (i = 0; i < elements; i++)
-                ptr[i] += p->linesize[i];
-        }
-        break;
-    case 12:
-        for (x = 0; x < avctx->height; x++) {
-            uint16_t *dst[4] = {(uint16_t*)ptr[0],
-                                (uint16_t*)ptr[1],
-                                (uint16_t*)ptr[2],
-                                (uint16_t*)ptr[3]};
-            int shift = packing == 1 ? 4 : 0;
-            for (y = 0; y < avctx->width; y++) {
-                if (packing) {
-                    if (elements >= 3)
-                        *dst[2]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    *dst[0]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    if (elements >= 2)
-                        *dst[1]++ = read16(&buf, endian) >> shift & 0xFFF;
-                    if (elements == 4)
-                        *dst[3]++ = read16(&buf, endian) >> shift & 0xFFF;
-                } else {
-                    if (elements >= 3)
-                        *dst[2]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                    *dst[0]++ = read12in32(&buf, &rgbBuffer,
-                                           &n_datum, endian);
-                    if (elements >= 2)
-                        *dst[1]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                    if (elements == 4)
-                        *dst[3]++ = read12in32(&buf, &rgbBuffer,
-                                               &n_datum, endian);
-                }
-            }
-            n_datum = 0;
-            for (i = 0; i < elements; i++)
-                ptr[i] += p->linesize[i];
-            // Jump to next aligned position
-            buf += need_align;
-        }
+    case 12: {
+        DPXThreadData td = {
+            .frame          = p,
+            .buf            = buf,
+            .stride         = stride,
+            .need_align     = need_align,
+            .bits_per_color = bits_per_color,
+            .elements       = elements,
+            .packing        = packing,
+            .endian         = endian,
+            .unpadded_10bit = unpadded_10bit,
+        };
+        /* without padding, lines do not start at a known position */
+        int nb_jobs = bits_per_color == 10 && unpadded_10bit && elements != 3 ?
+                      1 : av_clip(avctx->thread_count, 1, avctx->height);
+
+        td.slice_height = (avctx->height + nb_jobs - 1) / nb_jobs;
+        nb_jobs         = (avctx->height + td.slice_height - 1) / td.slice_height;
+        avctx->execute2(avctx, unpack_slice, &td, NULL, nb_jobs);
         break;
+    }
     case 32:
         if (elements == 1) {
             av_image_copy_plane(ptr[0], p->linesize[0],
@@ -765,6 +849,10 @@ const FFCodec ff_dpx_decoder = {
     .p.long_name    = NULL_IF_CONFIG_SMALL("DPX (Digital Picture Exchange) image"),
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_DPX,
+    .priv_data_size = sizeof(DPXDecContext),
+    .init           = decode_init,
     FF_CODEC_DECODE_CB(decode_frame),
-    .p.capabilities = AV_CODEC_CAP_DR1,
+    .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
 };
@@ -0,0 +1,66 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/intreadwrite.h"
+#include "dpxdsp.h"
+
+#define UNPACK_FUNCS(endian, RN32)                                          \
+static void unpack_rgb10_ ## endian ## _c(uint16_t *g, uint16_t *b,         \
+                                         uint16_t *r, const uint8_t *src,   \
+                                         int shift, int width)              \
+{                                                                           \
+    for (int x = 0; x < width; x++) {                                       \
+        uint32_t v = RN32(src + 4 * x);                                     \
+        r[x] = v >>  shift       & 0x3FF;                                   \
+        g[x] = v >> (shift - 10) & 0x3FF;                                   \
+        b[x] = v >> (shift - 20) & 0x3FF;                                   \
+    }                                                                       \
+}                                                                           \
+                                                                            \
+static void unpack_gray10_ ## endian ## _c(uint16_t *dst, const uint8_t *src, \
+                                          int shift, int width)             \
+{                                                                           \
+    int x;                                                                  \
+                                                                            \
+    for (x = 0; x + 2 < width; x += 3) {                                    \
+        uint32_t v = RN32(src) >> shift;                                    \
+        dst[x + 0] = v       & 0x3FF;                                       \
+        dst[x + 1] = v >> 10 & 0x3FF;                                       \
+        dst[x + 2] = v >> 20 & 0x3FF;                                       \
+        src += 4;                                                           \
+    }                                                                       \
+    if (x < width) {                                                        \
+        uint32_t v = RN32(src) >> shift;                                    \
+        for (; x < width; x++, v >>= 10)                                    \
+            dst[x] = v & 0x3FF;                                             \
+    }                                                                       \
+}
+
+UNPACK_FUNCS(le, AV_RL32)
+UNPACK_FUNCS(be, AV_RB32)
+
+av_cold void ff_dpxdsp_init(DPXDSPContext *c)
+{
+    c->unpack_rgb10[0]  = unpack_rgb10_le_c;
+    c->unpack_rgb10[1]  = unpack_rgb10_be_c;
+    c->unpack_gray10[0] = unpack_gray10_le_c;
+    c->unpack_gray10[1] = unpack_gray10_be_c;
+}
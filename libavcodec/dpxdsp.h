@@ -0,0 +1,48 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_DPXDSP_H
+#define AVCODEC_DPXDSP_H
+
+#include <stdint.h>
+
+typedef struct DPXDSPContext {
+    /**
+     * Unpack a line of 10-bit RGB pixels stored one per 32-bit word, with the
+     * R, G and B samples starting at bits shift, shift - 10 and shift - 20 of
+     * the word (shift is 22 for packing method A and 20 for method B).
+     * Indexed by endianness of the words, 1 for big-endian.
+     * @param width number of pixels
+     */
+    void (*unpack_rgb10[2])(uint16_t *g, uint16_t *b, uint16_t *r,
+                            const uint8_t *src, int shift, int width);
+
+    /**
+     * Unpack a line of 10-bit gray samples stored three per 32-bit word, the
+     * first one starting at bit shift of the word (2 for packing method A and
+     * 0 for method B) and the next ones 10 and 20 bits higher.
+     * Indexed by endianness of the words, 1 for big-endian.
+     * @param width number of samples
+     */
+    void (*unpack_gray10[2])(uint16_t *dst, const uint8_t *src,
+                             int shift, int width);
+} DPXDSPContext;
+
+void ff_dpxdsp_init(DPXDSPContext *c);
+
+#endif /* AVCODEC_DPXDSP_H */
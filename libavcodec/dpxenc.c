@@ -35,6 +35,13 @@ typedef struct DPXContext {
     int planar;
 } DPXContext;
 
+typedef struct DPXThreadData {
+    const AVFrame *pic;
+    uint8_t *dst;           ///< start of the image data
+    int dst_stride;
+    int slice_height;
+} DPXThreadData;
+
 static av_cold int encode_init(AVCodecContext *avctx)
 {
     DPXContext *s = avctx->priv_data;
@@ -90,13 +97,13 @@ static av_always_inline void write32_internal(int big_endian, void *p, int value
 #define write32(p, value) write32_internal(s->big_endian, p, value)
 
 static void encode_rgb48_10bit(AVCodecContext *avctx, const AVFrame *pic,
-                               uint8_t *dst)
+                               uint8_t *dst, int y0, int y1)
 {
     DPXContext *s = avctx->priv_data;
-    const uint8_t *src = pic->data[0];
+    const uint8_t *src = pic->data[0] + y0 * pic->linesize[0];
     int x, y;
 
-    for (y = 0; y < avctx->height; y++) {
+    for (y = y0; y < y1; y++) {
         for (x = 0; x < avctx->width; x++) {
             int value;
             if (s->big_endian) {
@@ -115,13 +122,16 @@ static void encode_rgb48_10bit(AVCodecContext *avctx, const AVFrame *pic,
     }
 }
 
-static void encode_gbrp10(AVCodecContext *avctx, const AVFrame *pic, uint8_t *dst)
+static void encode_gbrp10(AVCodecContext *avctx, const AVFrame *pic, uint8_t *dst,
+                          int y0, int y1)
 {
     DPXContext *s = avctx->priv_data;
-    const uint8_t *src[3] = {pic->data[0], pic->data[1], pic->data[2]};
+    const uint8_t *src[3] = {pic->data[0] + y0 * pic->linesize[0],
+                             pic->data[1] + y0 * pic->linesize[1],
+                             pic->data[2] + y0 * pic->linesize[2]};
     int x, y, i;
 
-    for (y = 0; y < avctx->height; y++) {
+    for (y = y0; y < y1; y++) {
         for (x = 0; x < avctx->width; x++) {
             int value;
             if (s->big_endian) {
@@ -141,16 +151,17 @@ static void encode_gbrp10(AVCodecContext *avctx, const AVFrame *pic, uint8_t *ds
     }
 }
 
-static void encode_gbrp12(AVCodecContext *avctx, const AVFrame *pic, uint8_t *dst)
+static void encode_gbrp12(AVCodecContext *avctx, const AVFrame *pic, uint8_t *dst,
+                          int y0, int y1)
 {
     DPXContext *s = avctx->priv_data;
-    const uint16_t *src[3] = {(uint16_t*)pic->data[0],
-                              (uint16_t*)pic->data[1],
-                              (uint16_t*)pic->data[2]};
+    const uint16_t *src[3] = {(uint16_t*)(pic->data[0] + y0 * pic->linesize[0]),
+                              (uint16_t*)(pic->data[1] + y0 * pic->linesize[1]),
+                              (uint16_t*)(pic->data[2] + y0 * pic->linesize[2])};
     int x, y, i, pad;
     pad = avctx->width*6;
     pad = (FFALIGN(pad, 4) - pad) >> 1;
-    for (y = 0; y < avctx->height; y++) {
+    for (y = y0; y < y1; y++) {
         for (x = 0; x < avctx->width; x++) {
             uint16_t value[3];
             if (s->big_endian) {
@@ -172,6 +183,24 @@ static void encode_gbrp12(AVCodecContext *avctx, const AVFrame *pic, uint8_t *ds
     }
 }
 
+static int encode_slice(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    DPXContext *s = avctx->priv_data;
+    const DPXThreadData *td = arg;
+    int y0 = jobnr * td->slice_height;
+    int y1 = FFMIN(y0 + td->slice_height, avctx->height);
+    uint8_t *dst = td->dst + (ptrdiff_t)y0 * td->dst_stride;
+
+    if (s->bits_per_component == 12)
+        encode_gbrp12(avctx, td->pic, dst, y0, y1);
+    else if (s->planar)
+        encode_gbrp10(avctx, td->pic, dst, y0, y1);
+    else
+        encode_rgb48_10bit(avctx, td->pic, dst, y0, y1);
+
+    return 0;
+}
+
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *frame, int *got_packet)
 {
@@ -252,14 +281,19 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
             return size;
         break;
     case 10:
-        if (s->planar)
-            encode_gbrp10(avctx, frame, buf + HEADER_SIZE);
-        else
-            encode_rgb48_10bit(avctx, frame, buf + HEADER_SIZE);
-        break;
-    case 12:
-        encode_gbrp12(avctx, frame, buf + HEADER_SIZE);
+    case 12: {
+        DPXThreadData td = {
+            .pic        = frame,
+            .dst        = buf + HEADER_SIZE,
+            .dst_stride = size / avctx->height,
+        };
+        int nb_jobs = av_clip(avctx->thread_count, 1, avctx->height);
+
+        td.slice_height = (avctx->height + nb_jobs - 1) / nb_jobs;
+        nb_jobs         = (avctx->height + td.slice_height - 1) / td.slice_height;
+        avctx->execute2(avctx, encode_slice, &td, NULL, nb_jobs);
         break;
+    }
     default:
         av_log(avctx, AV_LOG_ERROR, "Unsupported bit depth: %d\n", s->bits_per_component);
         return -1;
@@ -279,7 +313,8 @@ const FFCodec ff_dpx_encoder = {
     .p.long_name    = NULL_IF_CONFIG_SMALL("DPX (Digital Picture Exchange) image"),
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_DPX,
-    .p.capabilities = AV_CODEC_CAP_DR1,
+    .p.capabilities = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(DPXContext),
     .init           = encode_init,
     FF_CODEC_ENCODE_CB(encode_frame),
@@ -138,6 +138,7 @@ typedef struct EXRThreadData {
     int channel_line_size;
 
     int run_sym;
+    int vlc_depth;
     HuffEntry *he;
     uint64_t *freq;
     VLC vlc;
@@ -190,6 +191,7 @@ typedef struct EXRContext {
     enum AVColorTransferCharacteristic apply_trc_type;
     float gamma;
     union av_intfloat32 gamma_table[65536];
+    int linear_half; /* gamma_table is a plain half to float conversion */
 
     uint32_t mantissatable[2048];
     uint32_t exponenttable[64];
@@ -365,10 +367,12 @@ static int huf_unpack_enc_table(GetByteContext *gb,
     return 0;
 }
 
+#define HUF_DEC_BITS 12
+
 static int huf_build_dec_table(EXRContext *s,
                                EXRThreadData *td, int im, int iM)
 {
-    int j = 0;
+    int j = 0, max_len;
 
     td->run_sym = -1;
     for (int i = im; i < iM; i++) {
@@ -404,22 +408,29 @@ static int huf_build_dec_table(EXRContext *s,
     td->he[j].code = td->freq[iM] >> 6;
     j++;
 
+    max_len = 0;
+    for (int i = 0; i < j; i++)
+        max_len = FFMAX(max_len, td->he[i].len);
+    td->vlc_depth = (max_len + HUF_DEC_BITS - 1) / HUF_DEC_BITS;
+
     ff_free_vlc(&td->vlc);
-    return ff_init_vlc_sparse(&td->vlc, 12, j,
+    return ff_init_vlc_sparse(&td->vlc, HUF_DEC_BITS, j,
                               &td->he[0].len, sizeof(td->he[0]), sizeof(td->he[0].len),
                               &td->he[0].code, sizeof(td->he[0]), sizeof(td->he[0].code),
                               &td->he[0].sym, sizeof(td->he[0]), sizeof(td->he[0].sym), 0);
 }
 
-static int huf_decode(VLC *vlc, GetByteContext *gb, int nbits, int run_sym,
-                      int no, uint16_t *out)
+static av_always_inline int huf_decode_template(VLC *vlc, GetByteContext *gb,
+                                                int nbits, int run_sym,
+                                                int no, uint16_t *out,
+                                                int max_depth)
 {
     GetBitContext gbit;
     int oe = 0;
 
     init_get_bits(&gbit, gb->buffer, nbits);
     while (get_bits_left(&gbit) > 0 && oe < no) {
-        uint16_t x = get_vlc2(&gbit, vlc->table, 12, 3);
+        uint16_t x = get_vlc2(&gbit, vlc->table, HUF_DEC_BITS, max_depth);
 
         if (x == run_sym) {
             int run = get_bits(&gbit, 8);
@@ -440,6 +451,18 @@ static int huf_decode(VLC *vlc, GetByteContext *gb, int nbits, int run_sym,
     return 0;
 }
 
+/* Most tables fit in a single lookup level; specialise for the table depth
+ * so the common case does not pay for the multi-level lookup. */
+static int huf_decode(VLC *vlc, GetByteContext *gb, int nbits, int run_sym,
+                      int no, uint16_t *out, int depth)
+{
+    switch (depth) {
+    case 1:  return huf_decode_template(vlc, gb, nbits, run_sym, no, out, 1);
+    case 2:  return huf_decode_template(vlc, gb, nbits, run_sym, no, out, 2);
+    default: return huf_decode_template(vlc, gb, nbits, run_sym, no, out, 3);
+    }
+}
+
 static int huf_uncompress(EXRContext *s,
                           EXRThreadData *td,
                           GetByteContext *gb,
@@ -479,7 +502,8 @@ static int huf_uncompress(EXRContext *s,
 
     if ((ret = huf_build_dec_table(s, td, im, iM)) < 0)
         return ret;
-    return huf_decode(&td->vlc, gb, nBits, td->run_sym, dst_size, dst);
+    return huf_decode(&td->vlc, gb, nBits, td->run_sym, dst_size, dst,
+                      td->vlc_depth);
 }
 
 static inline void wdec14(uint16_t l, uint16_t h, uint16_t *a, uint16_t *b)
@@ -1419,18 +1443,14 @@ static int decode_block(AVCodecContext *avctx, void *tdata,
                     }
                 } else if (s->pixel_type == EXR_HALF) {
                     // 16-bit
-                    if (c < 3 || !trc_func) {
+                    if ((c < 3 || !trc_func) && !s->linear_half) {
                         for (x = 0; x < xsize; x++) {
                             *ptr_x++ = s->gamma_table[bytestream_get_le16(&src)];
                         }
                     } else {
-                        for (x = 0; x < xsize; x++) {
-                            ptr_x[0].i = half2float(bytestream_get_le16(&src),
-                                                    s->mantissatable,
-                                                    s->exponenttable,
-                                                    s->offsettable);
-                            ptr_x++;
-                        }
+                        s->dsp.half2float(&ptr_x[0].i, src, xsize);
+                        src   += 2 * xsize;
+                        ptr_x += xsize;
                     }
                 }
 
@@ -2234,6 +2254,7 @@ static av_cold int decode_init(AVCodecContext *avctx)
         }
     } else {
         if (one_gamma > 0.9999f && one_gamma < 1.0001f) {
+            s->linear_half = 1;
             for (i = 0; i < 65536; ++i) {
                 s->gamma_table[i].i = half2float(i, s->mantissatable, s->exponenttable, s->offsettable);
             }
@@ -21,6 +21,8 @@
 #include <stdint.h>
 
 #include "libavutil/attributes.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
 #include "exrdsp.h"
 #include "config.h"
 
@@ -46,10 +48,34 @@ static void predictor_scalar(uint8_t *src, ptrdiff_t size)
         src[i] += src[i-1] - 128;
 }
 
+/* Table-free conversion so that the loop can be vectorised by the compiler;
+ * results are bit-identical to half2float() from half2float.h. */
+static void half2float_scalar(uint32_t *dst, const uint8_t *src, ptrdiff_t len)
+{
+    ptrdiff_t i;
+
+    for (i = 0; i < len; i++) {
+        uint32_t h   = AV_RL16(src + 2 * i);
+        uint32_t em  = (h & 0x7fff) << 13;
+        uint32_t exp = em & 0x0f800000;
+        union av_intfloat32 o;
+
+        o.i = em + ((127 - 15) << 23);
+        if (exp == 0x0f800000) {        /* Inf/NaN */
+            o.i += (128 - 16) << 23;
+        } else if (!exp) {              /* zero/denormal */
+            o.i += 1 << 23;
+            o.f -= 6.103515625e-05f;    /* 2^-14 */
+        }
+        dst[i] = o.i | ((h & 0x8000) << 16);
+    }
+}
+
 av_cold void ff_exrdsp_init(ExrDSPContext *c)
 {
     c->reorder_pixels   = reorder_pixels_scalar;
     c->predictor        = predictor_scalar;
+    c->half2float       = half2float_scalar;
 
     if (ARCH_X86)
         ff_exrdsp_init_x86(c);
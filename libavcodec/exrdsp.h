@@ -25,6 +25,11 @@
 typedef struct ExrDSPContext {
     void (*reorder_pixels)(uint8_t *dst, const uint8_t *src, ptrdiff_t size);
     void (*predictor)(uint8_t *src, ptrdiff_t size);
+    /**
+     * Convert len little-endian half floats from src to single precision
+     * floats (as their bit patterns) in dst.
+     */
+    void (*half2float)(uint32_t *dst, const uint8_t *src, ptrdiff_t len);
 } ExrDSPContext;
 
 void ff_exrdsp_init(ExrDSPContext *c);
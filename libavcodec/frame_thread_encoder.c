@@ -27,6 +27,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 #include "avcodec.h"
 #include "codec_internal.h"
 #include "internal.h"
@@ -66,6 +67,9 @@ typedef struct{
 
     pthread_t worker[MAX_THREADS];
     atomic_int exit;
+
+    ThreadStats *stats;        /* NULL unless AVCodecContext.thread_stats is set */
+    atomic_int next_worker;    /* Used by the workers to number themselves in stats */
 } ThreadContext;
 
 #define OFF(member) offsetof(ThreadContext, member)
@@ -77,6 +81,7 @@ DEFINE_OFFSET_ARRAY(ThreadContext, thread_ctx, pthread_init_cnt,
 static void * attribute_align_arg worker(void *v){
     AVCodecContext *avctx = v;
     ThreadContext *c = avctx->internal->frame_thread_encoder;
+    int thread = atomic_fetch_add(&c->next_worker, 1);
 
     while (!atomic_load(&c->exit)) {
         int got_packet = 0, ret;
@@ -84,6 +89,7 @@ static void * attribute_align_arg worker(void *v){
         AVFrame *frame;
         Task *task;
         unsigned task_index;
+        int64_t start;
 
         pthread_mutex_lock(&c->task_fifo_mutex);
         while (c->next_task_index == c->task_index || atomic_load(&c->exit)) {
@@ -104,7 +110,10 @@ static void * attribute_align_arg worker(void *v){
         frame = task->indata;
         pkt   = task->outdata;
 
+        start = c->stats ? av_gettime_relative() : 0;
         ret = ffcodec(avctx->codec)->cb.encode(avctx, pkt, frame, &got_packet);
+        if (c->stats)
+            ff_thread_stats_frame(c->stats, thread, av_gettime_relative() - start);
         if(got_packet) {
             int ret2 = av_packet_make_refcounted(pkt);
             if (ret >= 0 && ret2 < 0)
@@ -177,6 +186,13 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
         }
     }
 
+    /* FFV1 frames are only independent when every frame is a keyframe, and
+     * the first pass statistics are only output when flushing. Keep using
+     * slice threads otherwise. */
+    if (avctx->codec_id == AV_CODEC_ID_FFV1 &&
+        (avctx->gop_size > 1 || avctx->flags & AV_CODEC_FLAG_PASS1))
+        return 0;
+
     if(!avctx->thread_count) {
         avctx->thread_count = av_cpu_count();
         avctx->thread_count = FFMIN(avctx->thread_count, MAX_THREADS);
@@ -199,6 +215,12 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
     if (ret < 0)
         goto fail;
     atomic_init(&c->exit, 0);
+    atomic_init(&c->next_worker, 0);
+
+    ret = ff_thread_stats_init(avctx, avctx->thread_count);
+    if (ret < 0)
+        goto fail;
+    c->stats = avctx->internal->thread_stats;
 
     c->max_tasks = avctx->thread_count + 2;
     for (unsigned j = 0; j < c->max_tasks; j++) {
@@ -307,8 +329,14 @@ int ff_thread_video_encode_frame(AVCodecContext *avctx, AVPacket *pkt,
             pthread_mutex_unlock(&c->finished_task_mutex);
             return 0;
         }
-    while (!outtask->finished) {
-        pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+    if (!outtask->finished) {
+        int64_t start = c->stats ? av_gettime_relative() : 0;
+        while (!outtask->finished) {
+            pthread_cond_wait(&c->finished_task_cond, &c->finished_task_mutex);
+        }
+        if (c->stats)
+            ff_thread_stats_wait(c->stats, THREAD_STATS_WAIT_OUTPUT,
+                                 av_gettime_relative() - start);
     }
     pthread_mutex_unlock(&c->finished_task_mutex);
     /* We now own outtask completely: No worker thread touches it any more,
@@ -68,6 +68,12 @@ typedef struct AVCodecInternal {
 
     void *thread_ctx;
 
+    /**
+     * Threading statistics, if AVCodecContext.thread_stats is set and the
+     * codec uses threads.
+     */
+    struct ThreadStats *thread_stats;
+
     /**
      * This packet is used to hold the packet given to decoders
      * implementing the .decode API; it is unused by the generic
@@ -37,6 +37,7 @@
 #include "internal.h"
 #include "mathops.h"
 #include "pcm_tablegen.h"
+#include "pcmdsp.h"
 
 static av_cold int pcm_encode_init(AVCodecContext *avctx)
 {
@@ -247,6 +248,7 @@ typedef struct PCMDecode {
     void (*vector_fmul_scalar)(float *dst, const float *src, float mul,
                                int len);
     float   scale;
+    PCMDSPContext pcmdsp;
 } PCMDecode;
 
 static av_cold int pcm_decode_init(AVCodecContext *avctx)
@@ -291,7 +293,17 @@ static av_cold int pcm_decode_init(AVCodecContext *avctx)
 
     avctx->sample_fmt = avctx->codec->sample_fmts[0];
 
-    if (avctx->sample_fmt == AV_SAMPLE_FMT_S32)
+    if (avctx->codec_id == AV_CODEC_ID_PCM_S24LE ||
+        avctx->codec_id == AV_CODEC_ID_PCM_S24LE_PLANAR) {
+        ff_pcmdsp_init(&s->pcmdsp);
+        /* deinterleave directly instead of leaving it to a later conversion */
+        if (avctx->codec_id == AV_CODEC_ID_PCM_S24LE &&
+            (avctx->request_sample_fmt == AV_SAMPLE_FMT_S32P ||
+             avctx->request_sample_fmt == AV_SAMPLE_FMT_FLTP))
+            avctx->sample_fmt = avctx->request_sample_fmt;
+    }
+
+    if (av_get_packed_sample_fmt(avctx->sample_fmt) == AV_SAMPLE_FMT_S32)
         avctx->bits_per_raw_sample = av_get_bits_per_sample(avctx->codec_id);
 
     return 0;
@@ -390,10 +402,25 @@ static int pcm_decode_frame(AVCodecContext *avctx, AVFrame *frame,
         DECODE(32, be32, src, samples, n, 0, 0x80000000)
         break;
     case AV_CODEC_ID_PCM_S24LE:
-        DECODE(32, le24, src, samples, n, 8, 0)
+        if (avctx->sample_fmt == AV_SAMPLE_FMT_S32) {
+            s->pcmdsp.s24le_to_s32((int32_t *)samples, src, n);
+            break;
+        }
+        n /= channels;
+        for (c = 0; c < channels; c++) {
+            if (avctx->sample_fmt == AV_SAMPLE_FMT_S32P)
+                s->pcmdsp.s24le_to_s32p((int32_t *)frame->extended_data[c],
+                                        src + 3 * c, 3 * channels, n);
+            else
+                s->pcmdsp.s24le_to_fltp((float *)frame->extended_data[c],
+                                        src + 3 * c, 3 * channels, n);
+        }
         break;
     case AV_CODEC_ID_PCM_S24LE_PLANAR:
-        DECODE_PLANAR(32, le24, src, samples, n, 8, 0);
+        n /= channels;
+        for (c = 0; c < channels; c++)
+            s->pcmdsp.s24le_to_s32((int32_t *)frame->extended_data[c],
+                                   src + 3 * n * c, n);
         break;
     case AV_CODEC_ID_PCM_S24BE:
         DECODE(32, be24, src, samples, n, 8, 0)
@@ -619,7 +646,25 @@ PCM_CODEC  (PCM_S16LE,        AV_SAMPLE_FMT_S16, pcm_s16le,        "PCM signed 1
 PCM_CODEC  (PCM_S16LE_PLANAR, AV_SAMPLE_FMT_S16P,pcm_s16le_planar, "PCM signed 16-bit little-endian planar");
 PCM_CODEC  (PCM_S24BE,        AV_SAMPLE_FMT_S32, pcm_s24be,        "PCM signed 24-bit big-endian");
 PCM_CODEC  (PCM_S24DAUD,      AV_SAMPLE_FMT_S16, pcm_s24daud,      "PCM D-Cinema audio signed 24-bit");
-PCM_CODEC  (PCM_S24LE,        AV_SAMPLE_FMT_S32, pcm_s24le,        "PCM signed 24-bit little-endian");
+PCM_ENCODER(PCM_S24LE,        AV_SAMPLE_FMT_S32, pcm_s24le,        "PCM signed 24-bit little-endian");
+#if CONFIG_PCM_S24LE_DECODER
+/* also outputs planar samples, see the request_sample_fmt check in pcm_decode_init() */
+const FFCodec ff_pcm_s24le_decoder = {
+    .p.name         = "pcm_s24le",
+    .p.long_name    = NULL_IF_CONFIG_SMALL("PCM signed 24-bit little-endian"),
+    .p.type         = AVMEDIA_TYPE_AUDIO,
+    .p.id           = AV_CODEC_ID_PCM_S24LE,
+    .priv_data_size = sizeof(PCMDecode),
+    .init           = pcm_decode_init,
+    FF_CODEC_DECODE_CB(pcm_decode_frame),
+    .p.capabilities = AV_CODEC_CAP_DR1,
+    .p.sample_fmts  = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_S32,
+                                                     AV_SAMPLE_FMT_S32P,
+                                                     AV_SAMPLE_FMT_FLTP,
+                                                     AV_SAMPLE_FMT_NONE },
+    .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE,
+};
+#endif
 PCM_CODEC  (PCM_S24LE_PLANAR, AV_SAMPLE_FMT_S32P,pcm_s24le_planar, "PCM signed 24-bit little-endian planar");
 PCM_CODEC  (PCM_S32BE,        AV_SAMPLE_FMT_S32, pcm_s32be,        "PCM signed 32-bit big-endian");
 PCM_CODEC  (PCM_S32LE,        AV_SAMPLE_FMT_S32, pcm_s32le,        "PCM signed 32-bit little-endian");
@@ -0,0 +1,60 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/intreadwrite.h"
+#include "pcmdsp.h"
+
+/* The 24-bit samples are read with a 32-bit load and shifted into the MSBs,
+ * which reads one byte past the last sample; input buffers are padded. */
+
+static void s24le_to_s32_c(int32_t *dst, const uint8_t *src, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = AV_RL32(src + 3 * i) << 8;
+}
+
+static void s24le_to_s32p_c(int32_t *dst, const uint8_t *src,
+                            ptrdiff_t stride, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = AV_RL32(src + i * stride) << 8;
+}
+
+static void s24le_to_fltp_c(float *dst, const uint8_t *src,
+                            ptrdiff_t stride, int len)
+{
+    int i;
+
+    for (i = 0; i < len; i++)
+        dst[i] = (int32_t)(AV_RL32(src + i * stride) << 8) * (1.0f / (1U << 31));
+}
+
+av_cold void ff_pcmdsp_init(PCMDSPContext *c)
+{
+    c->s24le_to_s32  = s24le_to_s32_c;
+    c->s24le_to_s32p = s24le_to_s32p_c;
+    c->s24le_to_fltp = s24le_to_fltp_c;
+}
@@ -0,0 +1,54 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_PCMDSP_H
+#define AVCODEC_PCMDSP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct PCMDSPContext {
+    /**
+     * Unpack signed 24-bit little-endian samples to signed 32-bit samples,
+     * with the 24 significant bits in the MSBs.
+     * The source buffer must be readable up to 1 byte past the last sample.
+     * @param len number of samples
+     */
+    void (*s24le_to_s32)(int32_t *dst, const uint8_t *src, int len);
+
+    /**
+     * Extract one channel of interleaved signed 24-bit little-endian samples
+     * to a plane of signed 32-bit samples, with the 24 significant bits in
+     * the MSBs.
+     * The source buffer must be readable up to 1 byte past the last sample.
+     * @param stride distance in bytes between two samples of the channel
+     * @param len    number of samples
+     */
+    void (*s24le_to_s32p)(int32_t *dst, const uint8_t *src,
+                          ptrdiff_t stride, int len);
+
+    /**
+     * Same as s24le_to_s32p(), but output float samples in [-1.0, 1.0).
+     */
+    void (*s24le_to_fltp)(float *dst, const uint8_t *src,
+                          ptrdiff_t stride, int len);
+} PCMDSPContext;
+
+void ff_pcmdsp_init(PCMDSPContext *c);
+
+#endif /* AVCODEC_PCMDSP_H */
@@ -51,7 +51,6 @@ typedef struct {
     const uint8_t *scan;
     int first_field;
     int alpha_info;
-    void (*unpack_alpha)(GetBitContext *gb, uint16_t *dst, int num_coeffs, const int num_bits);
     enum AVPixelFormat pix_fmt;
 } ProresContext;
 
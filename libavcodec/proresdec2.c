@@ -52,90 +52,76 @@ static void permute(uint8_t *dst, const uint8_t *src, const uint8_t permutation[
         dst[i] = permutation[src[i]];
 }
 
-#define ALPHA_SHIFT_16_TO_10(alpha_val) (alpha_val >> 6)
-#define ALPHA_SHIFT_8_TO_10(alpha_val)  ((alpha_val << 2) | (alpha_val >> 6))
-#define ALPHA_SHIFT_16_TO_12(alpha_val) (alpha_val >> 4)
-#define ALPHA_SHIFT_8_TO_12(alpha_val)  ((alpha_val << 4) | (alpha_val >> 4))
-
-static void inline unpack_alpha(GetBitContext *gb, uint16_t *dst, int num_coeffs,
-                                const int num_bits, const int decode_precision) {
+/**
+ * Decode raw alpha values; scaling to the output precision is done by
+ * ProresDSPContext.put_alpha.
+ */
+static av_always_inline void unpack_alpha(GetBitContext *gb, uint16_t *dst,
+                                          int num_coeffs, const int num_bits)
+{
     const int mask = (1 << num_bits) - 1;
-    int i, idx, val, alpha_val;
+    int i, idx, val, alpha_val, bits_left;
+
+    OPEN_READER(re, gb);
 
     idx       = 0;
     alpha_val = mask;
-    do {
-        do {
-            if (get_bits1(gb)) {
-                val = get_bits(gb, num_bits);
-            } else {
-                int sign;
-                val  = get_bits(gb, num_bits == 16 ? 7 : 4);
-                sign = val & 1;
-                val  = (val + 2) >> 1;
-                if (sign)
-                    val = -val;
-            }
-            alpha_val = (alpha_val + val) & mask;
-            if (num_bits == 16) {
-                if (decode_precision == 10) {
-                    dst[idx++] = ALPHA_SHIFT_16_TO_10(alpha_val);
-                } else { /* 12b */
-                    dst[idx++] = ALPHA_SHIFT_16_TO_12(alpha_val);
-                }
-            } else {
-                if (decode_precision == 10) {
-                    dst[idx++] = ALPHA_SHIFT_8_TO_10(alpha_val);
-                } else { /* 12b */
-                    dst[idx++] = ALPHA_SHIFT_8_TO_12(alpha_val);
-                }
-            }
-            if (idx >= num_coeffs)
-                break;
-        } while (get_bits_left(gb)>0 && get_bits1(gb));
-        val = get_bits(gb, 4);
-        if (!val)
-            val = get_bits(gb, 11);
-        if (idx + val > num_coeffs)
-            val = num_coeffs - idx;
-        if (num_bits == 16) {
-            for (i = 0; i < val; i++) {
-                if (decode_precision == 10) {
-                    dst[idx++] = ALPHA_SHIFT_16_TO_10(alpha_val);
-                } else { /* 12b */
-                    dst[idx++] = ALPHA_SHIFT_16_TO_12(alpha_val);
-                }
-            }
+    for (;;) {
+        /* at most 1 + num_bits bits for the value and 1 continuation bit */
+        UPDATE_CACHE(re, gb);
+        if (SHOW_UBITS(re, gb, 1)) {
+            val = SHOW_UBITS(re, gb, num_bits + 1) & mask;
+            SKIP_BITS(re, gb, num_bits + 1);
         } else {
-            for (i = 0; i < val; i++) {
-                if (decode_precision == 10) {
-                    dst[idx++] = ALPHA_SHIFT_8_TO_10(alpha_val);
-                } else { /* 12b */
-                    dst[idx++] = ALPHA_SHIFT_8_TO_12(alpha_val);
-                }
-            }
+            int sign;
+            val  = SHOW_UBITS(re, gb, num_bits == 16 ? 8 : 5);
+            SKIP_BITS(re, gb, num_bits == 16 ? 8 : 5);
+            sign = val & 1;
+            val  = (val + 2) >> 1;
+            if (sign)
+                val = -val;
         }
-    } while (idx < num_coeffs);
+        alpha_val = (alpha_val + val) & mask;
+        dst[idx++] = alpha_val;
+        if (idx >= num_coeffs)
+            break;
+
+        bits_left = gb->size_in_bits - re_index;
+        if (bits_left > 0) {
+            int more = SHOW_UBITS(re, gb, 1);
+            SKIP_BITS(re, gb, 1);
+            if (more)
+                continue;
+        }
+
+        /* run of repeated values */
+        UPDATE_CACHE(re, gb);
+        val = SHOW_UBITS(re, gb, 4);
+        SKIP_BITS(re, gb, 4);
+        if (!val) {
+            val = SHOW_UBITS(re, gb, 11);
+            SKIP_BITS(re, gb, 11);
+        }
+        if (idx + val > num_coeffs)
+            val = num_coeffs - idx;
+        for (i = 0; i < val; i++)
+            dst[idx + i] = alpha_val;
+        idx += val;
+        if (idx >= num_coeffs)
+            break;
+    }
+
+    CLOSE_READER(re, gb);
 }
 
-static void unpack_alpha_10(GetBitContext *gb, uint16_t *dst, int num_coeffs,
-                            const int num_bits)
+static void unpack_alpha_8(GetBitContext *gb, uint16_t *dst, int num_coeffs)
 {
-    if (num_bits == 16) {
-        unpack_alpha(gb, dst, num_coeffs, 16, 10);
-    } else { /* 8 bits alpha */
-        unpack_alpha(gb, dst, num_coeffs, 8, 10);
-    }
+    unpack_alpha(gb, dst, num_coeffs, 8);
 }
 
-static void unpack_alpha_12(GetBitContext *gb, uint16_t *dst, int num_coeffs,
-                            const int num_bits)
+static void unpack_alpha_16(GetBitContext *gb, uint16_t *dst, int num_coeffs)
 {
-    if (num_bits == 16) {
-        unpack_alpha(gb, dst, num_coeffs, 16, 12);
-    } else { /* 8 bits alpha */
-        unpack_alpha(gb, dst, num_coeffs, 8, 12);
-    }
+    unpack_alpha(gb, dst, num_coeffs, 16);
 }
 
 static av_cold int decode_init(AVCodecContext *avctx)
@@ -193,14 +179,6 @@ static av_cold int decode_init(AVCodecContext *avctx)
 
     ctx->pix_fmt = AV_PIX_FMT_NONE;
 
-    if (avctx->bits_per_raw_sample == 10){
-        ctx->unpack_alpha = unpack_alpha_10;
-    } else if (avctx->bits_per_raw_sample == 12){
-        ctx->unpack_alpha = unpack_alpha_12;
-    } else {
-        av_log(avctx, AV_LOG_ERROR, "Fail to set unpack_alpha for bits per raw sample %d\n", avctx->bits_per_raw_sample);
-        return AVERROR_BUG;
-    }
     return ret;
 }
 
@@ -451,9 +429,11 @@ static int decode_picture_header(AVCodecContext *avctx, const uint8_t *buf, cons
                 ((switch_bits + 1) << rice_order);                      \
             SKIP(re, gb, bits);                                         \
         } else if (rice_order) {                                        \
-            SKIP_BITS(re, gb, q+1);                                     \
-            val = (q << rice_order) + SHOW_UBITS(re, gb, rice_order);   \
-            SKIP(re, gb, rice_order);                                   \
+            /* prefix, stop bit and suffix in a single read */          \
+            bits = q + 1 + rice_order;                                  \
+            val  = (q << rice_order) +                                  \
+                   (SHOW_UBITS(re, gb, bits) & ((1U << rice_order) - 1));\
+            SKIP(re, gb, bits);                                         \
         } else {                                                        \
             val = q;                                                    \
             SKIP(re, gb, q+1);                                          \
@@ -617,27 +597,17 @@ static void decode_slice_alpha(ProresContext *ctx,
                                int blocks_per_slice)
 {
     GetBitContext gb;
-    int i;
-    LOCAL_ALIGNED_32(int16_t, blocks, [8*4*64]);
-    int16_t *block;
-
-    for (i = 0; i < blocks_per_slice<<2; i++)
-        ctx->bdsp.clear_block(blocks+(i<<6));
+    LOCAL_ALIGNED_32(uint16_t, alpha, [8*4*64]);
+    int num_coeffs = blocks_per_slice * 4 * 64;
 
     init_get_bits(&gb, buf, buf_size << 3);
 
     if (ctx->alpha_info == 2) {
-        ctx->unpack_alpha(&gb, blocks, blocks_per_slice * 4 * 64, 16);
+        unpack_alpha_16(&gb, alpha, num_coeffs);
+        ctx->prodsp.put_alpha[1](dst, dst_stride, alpha, 16 * blocks_per_slice, 16);
     } else {
-        ctx->unpack_alpha(&gb, blocks, blocks_per_slice * 4 * 64, 8);
-    }
-
-    block = blocks;
-
-    for (i = 0; i < 16; i++) {
-        memcpy(dst, block, 16 * blocks_per_slice * sizeof(*dst));
-        dst   += dst_stride >> 1;
-        block += 16 * blocks_per_slice;
+        unpack_alpha_8(&gb, alpha, num_coeffs);
+        ctx->prodsp.put_alpha[0](dst, dst_stride, alpha, 16 * blocks_per_slice, 16);
     }
 }
 
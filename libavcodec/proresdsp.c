@@ -76,14 +76,61 @@ static void prores_idct_put_12_c(uint16_t *out, ptrdiff_t linesize, int16_t *blo
     put_pixels_12(out, linesize >> 1, block);
 }
 
+#define ALPHA_SHIFT_16_TO_10(alpha_val) (alpha_val >> 6)
+#define ALPHA_SHIFT_8_TO_10(alpha_val)  ((alpha_val << 2) | (alpha_val >> 6))
+#define ALPHA_SHIFT_16_TO_12(alpha_val) (alpha_val >> 4)
+#define ALPHA_SHIFT_8_TO_12(alpha_val)  ((alpha_val << 4) | (alpha_val >> 4))
+
+static av_always_inline void put_alpha(uint16_t *dst, ptrdiff_t linesize,
+                                       const uint16_t *src, int width, int height,
+                                       int num_bits, int decode_precision)
+{
+    int x, y;
+
+    linesize >>= 1;
+    for (y = 0; y < height; y++) {
+        for (x = 0; x < width; x++) {
+            unsigned alpha_val = src[x];
+
+            if (num_bits == 16) {
+                dst[x] = decode_precision == 10 ? ALPHA_SHIFT_16_TO_10(alpha_val)
+                                                : ALPHA_SHIFT_16_TO_12(alpha_val);
+            } else {
+                dst[x] = decode_precision == 10 ? ALPHA_SHIFT_8_TO_10(alpha_val)
+                                                : ALPHA_SHIFT_8_TO_12(alpha_val);
+            }
+        }
+        dst += linesize;
+        src += width;
+    }
+}
+
+#define PUT_ALPHA_FUNC(num_bits, decode_precision)                                  \
+static void put_alpha_##num_bits##_##decode_precision##_c(uint16_t *dst,            \
+                                                           ptrdiff_t linesize,      \
+                                                           const uint16_t *src,     \
+                                                           int width, int height)   \
+{                                                                                   \
+    put_alpha(dst, linesize, src, width, height, num_bits, decode_precision);       \
+}
+
+PUT_ALPHA_FUNC(8,  10)
+PUT_ALPHA_FUNC(16, 10)
+PUT_ALPHA_FUNC(8,  12)
+PUT_ALPHA_FUNC(16, 12)
+
 av_cold int ff_proresdsp_init(ProresDSPContext *dsp, AVCodecContext *avctx)
 {
     if (avctx->bits_per_raw_sample == 10) {
         dsp->idct_put = prores_idct_put_10_c;
         dsp->idct_permutation_type = FF_IDCT_PERM_NONE;
+        dsp->put_alpha[0] = put_alpha_8_10_c;
+        dsp->put_alpha[1] = put_alpha_16_10_c;
     } else if (avctx->bits_per_raw_sample == 12) {
         dsp->idct_put = prores_idct_put_12_c;
         dsp->idct_permutation_type = FF_IDCT_PERM_NONE;
+        dsp->put_alpha[0] = put_alpha_8_12_c;
+        dsp->put_alpha[1] = put_alpha_16_12_c;
     } else {
         return AVERROR_BUG;
     }
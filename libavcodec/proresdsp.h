@@ -31,6 +31,13 @@ typedef struct ProresDSPContext {
     int idct_permutation_type;
     uint8_t idct_permutation[64];
     void (*idct_put)(uint16_t *out, ptrdiff_t linesize, int16_t *block, const int16_t *qmat);
+    /**
+     * Scale decoded alpha values to the output precision and store them.
+     * Index 0 is for 8-bit alpha, index 1 for 16-bit alpha.
+     * @param src   width * height alpha values in raster order
+     */
+    void (*put_alpha[2])(uint16_t *dst, ptrdiff_t linesize, const uint16_t *src,
+                         int width, int height);
 } ProresDSPContext;
 
 int ff_proresdsp_init(ProresDSPContext *dsp, AVCodecContext *avctx);
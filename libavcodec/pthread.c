@@ -29,10 +29,15 @@
  * @see doc/multithreading.txt
  */
 
+#include <stdatomic.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem.h"
 #include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "codec_internal.h"
+#include "internal.h"
 #include "pthread_internal.h"
 #include "thread.h"
 
@@ -47,7 +52,10 @@
  */
 static void validate_thread_parameters(AVCodecContext *avctx)
 {
+    /* Encoders are frame threaded by frame_thread_encoder.c, which has
+     * already declined if we get here. */
     int frame_threading_supported = (avctx->codec->capabilities & AV_CODEC_CAP_FRAME_THREADS)
+                                && !av_codec_is_encoder(avctx->codec)
 #if FF_API_FLAG_TRUNCATED
                                 && !(avctx->flags  & AV_CODEC_FLAG_TRUNCATED)
 #endif
@@ -126,3 +134,139 @@ fail:
     *(unsigned*)((char*)obj + offsets[0]) = cnt;
     return err;
 }
+
+struct ThreadStats {
+    AVCodecThreadStats pub;
+
+    atomic_int_least64_t nb_frames;
+    atomic_int_least64_t frame_time;
+    atomic_int_least64_t frame_time_hist[AV_CODEC_THREAD_STATS_HIST_SIZE];
+    atomic_int_least64_t wait_time[THREAD_STATS_WAIT_PROGRESS + 1];
+    atomic_int_least64_t nb_progress_waits;
+    atomic_int_least64_t progress_wait_hist[AV_CODEC_THREAD_STATS_HIST_SIZE];
+    atomic_int_least64_t nb_executes;
+    atomic_int_least64_t nb_jobs;
+    atomic_int_least64_t *thread_busy_time;
+    atomic_int_least64_t *thread_nb_jobs;
+};
+
+int ff_thread_stats_init(AVCodecContext *avctx, int nb_threads)
+{
+    ThreadStats *stats;
+
+    if (!avctx->thread_stats || avctx->internal->thread_stats)
+        return 0;
+
+    stats = av_mallocz(sizeof(*stats));
+    if (!stats)
+        return AVERROR(ENOMEM);
+    stats->pub.nb_threads       = nb_threads;
+    stats->pub.thread_busy_time = av_calloc(nb_threads, sizeof(*stats->pub.thread_busy_time));
+    stats->pub.thread_nb_jobs   = av_calloc(nb_threads, sizeof(*stats->pub.thread_nb_jobs));
+    stats->thread_busy_time     = av_calloc(nb_threads, sizeof(*stats->thread_busy_time));
+    stats->thread_nb_jobs       = av_calloc(nb_threads, sizeof(*stats->thread_nb_jobs));
+    avctx->internal->thread_stats = stats;
+    if (!stats->pub.thread_busy_time || !stats->pub.thread_nb_jobs ||
+        !stats->thread_busy_time || !stats->thread_nb_jobs) {
+        ff_thread_stats_free(avctx);
+        return AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
+void ff_thread_stats_free(AVCodecContext *avctx)
+{
+    ThreadStats *stats = avctx->internal->thread_stats;
+
+    if (!stats)
+        return;
+    av_freep(&stats->pub.thread_busy_time);
+    av_freep(&stats->pub.thread_nb_jobs);
+    av_freep(&stats->thread_busy_time);
+    av_freep(&stats->thread_nb_jobs);
+    av_freep(&avctx->internal->thread_stats);
+}
+
+static void stats_add(atomic_int_least64_t *counter, int64_t n)
+{
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+static void stats_add_hist(atomic_int_least64_t *hist, int64_t time)
+{
+    int bucket = time > 1 ? av_log2(FFMIN(time, INT_MAX)) : 0;
+    stats_add(&hist[FFMIN(bucket, AV_CODEC_THREAD_STATS_HIST_SIZE - 1)], 1);
+}
+
+void ff_thread_stats_frame(ThreadStats *stats, int thread, int64_t time)
+{
+    if (!stats)
+        return;
+    stats_add(&stats->nb_frames, 1);
+    stats_add(&stats->frame_time, time);
+    stats_add_hist(stats->frame_time_hist, time);
+    stats_add(&stats->thread_busy_time[thread], time);
+    stats_add(&stats->thread_nb_jobs[thread], 1);
+}
+
+void ff_thread_stats_job(ThreadStats *stats, int thread, int64_t time)
+{
+    if (!stats)
+        return;
+    stats_add(&stats->nb_jobs, 1);
+    stats_add(&stats->thread_busy_time[thread], time);
+    stats_add(&stats->thread_nb_jobs[thread], 1);
+}
+
+void ff_thread_stats_execute(ThreadStats *stats)
+{
+    if (!stats)
+        return;
+    stats_add(&stats->nb_executes, 1);
+}
+
+void ff_thread_stats_wait(ThreadStats *stats, enum ThreadStatsWait wait,
+                          int64_t time)
+{
+    if (!stats)
+        return;
+    stats_add(&stats->wait_time[wait], time);
+    if (wait == THREAD_STATS_WAIT_PROGRESS) {
+        stats_add(&stats->nb_progress_waits, 1);
+        stats_add_hist(stats->progress_wait_hist, time);
+    }
+}
+
+static int64_t stats_get(atomic_int_least64_t *counter)
+{
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+const AVCodecThreadStats *ff_thread_get_stats(AVCodecContext *avctx)
+{
+    ThreadStats *stats = avctx->internal->thread_stats;
+    AVCodecThreadStats *pub;
+    int i;
+
+    if (!stats)
+        return NULL;
+    pub = &stats->pub;
+
+    pub->nb_frames          = stats_get(&stats->nb_frames);
+    pub->frame_time         = stats_get(&stats->frame_time);
+    pub->submit_wait_time   = stats_get(&stats->wait_time[THREAD_STATS_WAIT_SUBMIT]);
+    pub->output_wait_time   = stats_get(&stats->wait_time[THREAD_STATS_WAIT_OUTPUT]);
+    pub->progress_wait_time = stats_get(&stats->wait_time[THREAD_STATS_WAIT_PROGRESS]);
+    pub->nb_progress_waits  = stats_get(&stats->nb_progress_waits);
+    pub->nb_executes        = stats_get(&stats->nb_executes);
+    pub->nb_jobs            = stats_get(&stats->nb_jobs);
+    for (i = 0; i < AV_CODEC_THREAD_STATS_HIST_SIZE; i++) {
+        pub->frame_time_hist[i]    = stats_get(&stats->frame_time_hist[i]);
+        pub->progress_wait_hist[i] = stats_get(&stats->progress_wait_hist[i]);
+    }
+    for (i = 0; i < pub->nb_threads; i++) {
+        pub->thread_busy_time[i] = stats_get(&stats->thread_busy_time[i]);
+        pub->thread_nb_jobs[i]   = stats_get(&stats->thread_nb_jobs[i]);
+    }
+    return pub;
+}
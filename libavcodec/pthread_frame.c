@@ -46,6 +46,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/opt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 enum {
     ///< Set when the thread is awaiting a packet.
@@ -147,6 +148,8 @@ typedef struct FrameThreadContext {
                                     * Set for the first N packets, where N is the number of threads.
                                     * While it is set, ff_thread_en/decode_frame won't return any results.
                                     */
+
+    ThreadStats *stats;            ///< Threading statistics, NULL unless AVCodecContext.thread_stats is set.
 } FrameThreadContext;
 
 #if FF_API_THREAD_SAFE_CALLBACKS
@@ -218,7 +221,13 @@ FF_ENABLE_DEPRECATION_WARNINGS
 
         av_frame_unref(p->frame);
         p->got_frame = 0;
-        p->result = codec->cb.decode(avctx, p->frame, &p->got_frame, p->avpkt);
+        if (p->parent->stats) {
+            int64_t start = av_gettime_relative();
+            p->result = codec->cb.decode(avctx, p->frame, &p->got_frame, p->avpkt);
+            ff_thread_stats_frame(p->parent->stats, p - p->parent->threads,
+                                  av_gettime_relative() - start);
+        } else
+            p->result = codec->cb.decode(avctx, p->frame, &p->got_frame, p->avpkt);
 
         if ((p->result < 0 || !p->got_frame) && p->frame->buf[0])
             ff_thread_release_buffer(avctx, p->frame);
@@ -438,10 +447,14 @@ static int submit_packet(PerThreadContext *p, AVCodecContext *user_avctx,
     if (prev_thread) {
         int err;
         if (atomic_load(&prev_thread->state) == STATE_SETTING_UP) {
+            int64_t start = fctx->stats ? av_gettime_relative() : 0;
             pthread_mutex_lock(&prev_thread->progress_mutex);
             while (atomic_load(&prev_thread->state) == STATE_SETTING_UP)
                 pthread_cond_wait(&prev_thread->progress_cond, &prev_thread->progress_mutex);
             pthread_mutex_unlock(&prev_thread->progress_mutex);
+            if (fctx->stats)
+                ff_thread_stats_wait(fctx->stats, THREAD_STATS_WAIT_SUBMIT,
+                                     av_gettime_relative() - start);
         }
 
         err = update_context_from_thread(p->avctx, prev_thread->avctx, 0);
@@ -555,10 +568,14 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
         p = &fctx->threads[finished++];
 
         if (atomic_load(&p->state) != STATE_INPUT_READY) {
+            int64_t start = fctx->stats ? av_gettime_relative() : 0;
             pthread_mutex_lock(&p->progress_mutex);
             while (atomic_load_explicit(&p->state, memory_order_relaxed) != STATE_INPUT_READY)
                 pthread_cond_wait(&p->output_cond, &p->progress_mutex);
             pthread_mutex_unlock(&p->progress_mutex);
+            if (fctx->stats)
+                ff_thread_stats_wait(fctx->stats, THREAD_STATS_WAIT_OUTPUT,
+                                     av_gettime_relative() - start);
         }
 
         av_frame_move_ref(picture, p->frame);
@@ -619,6 +636,7 @@ void ff_thread_await_progress(ThreadFrame *f, int n, int field)
 {
     PerThreadContext *p;
     atomic_int *progress = f->progress ? (atomic_int*)f->progress->data : NULL;
+    int64_t start;
 
     if (!progress ||
         atomic_load_explicit(&progress[field], memory_order_acquire) >= n)
@@ -630,10 +648,14 @@ void ff_thread_await_progress(ThreadFrame *f, int n, int field)
         av_log(f->owner[field], AV_LOG_DEBUG,
                "thread awaiting %d field %d from %p\n", n, field, progress);
 
+    start = p->parent->stats ? av_gettime_relative() : 0;
     pthread_mutex_lock(&p->progress_mutex);
     while (atomic_load_explicit(&progress[field], memory_order_relaxed) < n)
         pthread_cond_wait(&p->progress_cond, &p->progress_mutex);
     pthread_mutex_unlock(&p->progress_mutex);
+    if (p->parent->stats)
+        ff_thread_stats_wait(p->parent->stats, THREAD_STATS_WAIT_PROGRESS,
+                             av_gettime_relative() - start);
 }
 
 void ff_thread_finish_setup(AVCodecContext *avctx) {
@@ -881,6 +903,11 @@ int ff_frame_thread_init(AVCodecContext *avctx)
     fctx->async_lock = 1;
     fctx->delaying = 1;
 
+    err = ff_thread_stats_init(avctx, thread_count);
+    if (err < 0)
+        goto error;
+    fctx->stats = avctx->internal->thread_stats;
+
     if (codec->p.type == AVMEDIA_TYPE_VIDEO)
         avctx->delay = avctx->thread_count - 1;
 
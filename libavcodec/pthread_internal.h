@@ -19,6 +19,8 @@
 #ifndef AVCODEC_PTHREAD_INTERNAL_H
 #define AVCODEC_PTHREAD_INTERNAL_H
 
+#include <stdint.h>
+
 #include "avcodec.h"
 
 /* H.264 slice threading seems to be buggy with more than 16 threads,
@@ -31,6 +33,33 @@ void ff_slice_thread_free(AVCodecContext *avctx);
 int ff_frame_thread_init(AVCodecContext *avctx);
 void ff_frame_thread_free(AVCodecContext *avctx, int thread_count);
 
+enum ThreadStatsWait {
+    THREAD_STATS_WAIT_SUBMIT,   ///< caller waiting for the setup of the previous thread
+    THREAD_STATS_WAIT_OUTPUT,   ///< caller waiting for the output of a thread
+    THREAD_STATS_WAIT_PROGRESS, ///< thread waiting for the progress of another one
+};
+
+typedef struct ThreadStats ThreadStats;
+
+/**
+ * Allocate avctx->internal->thread_stats for nb_threads threads if the user
+ * asked for statistics. Does nothing if they are already allocated.
+ */
+int  ff_thread_stats_init(AVCodecContext *avctx, int nb_threads);
+
+/**
+ * Account a frame or a slice job run by a thread. These functions and
+ * ff_thread_stats_wait() may be called concurrently from all threads.
+ *
+ * @param stats the statistics, may be NULL if they are not collected
+ * @param time  time spent on the frame or job, in microseconds
+ */
+void ff_thread_stats_frame(ThreadStats *stats, int thread, int64_t time);
+void ff_thread_stats_job(ThreadStats *stats, int thread, int64_t time);
+void ff_thread_stats_execute(ThreadStats *stats);
+void ff_thread_stats_wait(ThreadStats *stats, enum ThreadStatsWait wait,
+                          int64_t time);
+
 #define THREAD_SENTINEL 0 // This forbids putting a mutex/condition variable at the front.
 /**
  * Initialize/destroy a list of mutexes/conditions contained in a structure.
@@ -36,6 +36,7 @@
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/time.h"
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -55,6 +56,8 @@ typedef struct SliceThreadContext {
     int thread_count;
     pthread_cond_t *progress_cond;
     pthread_mutex_t *progress_mutex;
+
+    ThreadStats *stats;     ///< NULL unless AVCodecContext.thread_stats is set
 } SliceThreadContext;
 
 static void main_function(void *priv) {
@@ -67,10 +70,13 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 {
     AVCodecContext *avctx = priv;
     SliceThreadContext *c = avctx->internal->thread_ctx;
+    int64_t start = c->stats ? av_gettime_relative() : 0;
     int ret;
 
     ret = c->func ? c->func(avctx, (char *)c->args + c->job_size * jobnr)
                   : c->func2(avctx, c->args, jobnr, threadnr);
+    if (c->stats)
+        ff_thread_stats_job(c->stats, threadnr, av_gettime_relative() - start);
     if (c->rets)
         c->rets[jobnr] = ret;
 }
@@ -108,6 +114,7 @@ static int thread_execute(AVCodecContext *avctx, action_func* func, void *arg, i
     c->func = func;
     c->rets = ret;
 
+    ff_thread_stats_execute(c->stats);
     avpriv_slicethread_execute(c->thread, job_count, !!c->mainfunc  );
     return 0;
 }
@@ -132,6 +139,7 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     SliceThreadContext *c;
     int thread_count = avctx->thread_count;
     void (*mainfunc)(void *);
+    int err;
 
     // We cannot do this in the encoder init as the threads are created before
     if (av_codec_is_encoder(avctx->codec) &&
@@ -157,7 +165,8 @@ int ff_slice_thread_init(AVCodecContext *avctx)
 
     avctx->internal->thread_ctx = c = av_mallocz(sizeof(*c));
     mainfunc = ffcodec(avctx->codec)->caps_internal & FF_CODEC_CAP_SLICE_THREAD_HAS_MF ? &main_function : NULL;
-    if (!c || (thread_count = avpriv_slicethread_create(&c->thread, avctx, worker_func, mainfunc, thread_count)) <= 1) {
+    if (!c || (thread_count = avpriv_slicethread_create_pool(&c->thread, avctx->thread_pool, avctx,
+                                                             worker_func, mainfunc, thread_count)) <= 1) {
         if (c)
             avpriv_slicethread_free(&c->thread);
         av_freep(&avctx->internal->thread_ctx);
@@ -167,6 +176,11 @@ int ff_slice_thread_init(AVCodecContext *avctx)
     }
     avctx->thread_count = thread_count;
 
+    err = ff_thread_stats_init(avctx, thread_count);
+    if (err < 0)
+        return err;
+    c->stats = avctx->internal->thread_stats;
+
     avctx->execute = thread_execute;
     avctx->execute2 = thread_execute2;
     return 0;
@@ -187,16 +201,21 @@ void ff_thread_await_progress2(AVCodecContext *avctx, int field, int thread, int
 {
     SliceThreadContext *p  = avctx->internal->thread_ctx;
     int *entries      = p->entries;
+    int64_t start;
 
     if (!entries || !field) return;
 
     thread = thread ? thread - 1 : p->thread_count - 1;
 
+    start = p->stats ? av_gettime_relative() : 0;
     pthread_mutex_lock(&p->progress_mutex[thread]);
     while ((entries[field - 1] - entries[field]) < shift){
         pthread_cond_wait(&p->progress_cond[thread], &p->progress_mutex[thread]);
     }
     pthread_mutex_unlock(&p->progress_mutex[thread]);
+    if (p->stats)
+        ff_thread_stats_wait(p->stats, THREAD_STATS_WAIT_PROGRESS,
+                             av_gettime_relative() - start);
 }
 
 int ff_alloc_entries(AVCodecContext *avctx, int count)
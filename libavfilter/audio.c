@@ -67,9 +67,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
         if (pool_channels != channels || pool_nb_samples < nb_samples ||
             pool_format != link->format || pool_align != align) {
 
-            ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
-                                                        nb_samples, link->format, align);
+            ff_frame_pool_replace((FFFramePool **)&link->frame_pool,
+                                  ff_frame_pool_audio_init(av_buffer_allocz, channels,
+                                                           nb_samples, link->format, align));
             if (!link->frame_pool)
                 return NULL;
         }
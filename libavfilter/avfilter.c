@@ -19,11 +19,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <time.h>
+
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/buffer.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/common.h"
+#include "libavutil/cpu.h"
 #include "libavutil/eval.h"
 #include "libavutil/frame.h"
 #include "libavutil/hwcontext.h"
@@ -33,6 +36,7 @@
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
 #include "libavutil/thread.h"
+#include "libavutil/time.h"
 
 #define FF_INTERNAL_FIELDS 1
 #include "framequeue.h"
@@ -210,9 +214,28 @@ void avfilter_link_free(AVFilterLink **link)
     av_freep(link);
 }
 
+/**
+ * Filters sharing no link may be activated concurrently (see
+ * ff_filter_graph_run_once()); state they can both reach, i.e. the readiness
+ * of a common neighbour and the sink links heap, is updated under a lock.
+ */
+static void graph_lock(AVFilterGraph *graph)
+{
+    if (graph && graph->internal->activate_running)
+        ff_mutex_lock(&graph->internal->activate_lock);
+}
+
+static void graph_unlock(AVFilterGraph *graph)
+{
+    if (graph && graph->internal->activate_running)
+        ff_mutex_unlock(&graph->internal->activate_lock);
+}
+
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
+    graph_lock(filter->graph);
     filter->ready = FFMAX(filter->ready, priority);
+    graph_unlock(filter->graph);
 }
 
 /**
@@ -547,10 +570,15 @@ void ff_update_link_current_pts(AVFilterLink *link, int64_t pts)
     link->current_pts = pts;
     link->current_pts_us = av_rescale_q(pts, link->time_base, AV_TIME_BASE_Q);
     /* TODO use duration */
+    graph_lock(link->graph);
     if (link->graph && link->age_index >= 0)
         ff_avfilter_graph_update_heap(link->graph, link);
+    graph_unlock(link->graph);
 }
 
+static void frame_threads_flush(AVFilterContext *ctx);
+static void frame_threads_free(AVFilterContext *ctx);
+
 int avfilter_process_command(AVFilterContext *filter, const char *cmd, const char *arg, char *res, int res_len, int flags)
 {
     if(!strcmp(cmd, "ping")){
@@ -567,6 +595,10 @@ int avfilter_process_command(AVFilterContext *filter, const char *cmd, const cha
     }else if(!strcmp(cmd, "enable")) {
         return set_enable_expr(filter, arg);
     }else if(filter->filter->process_command) {
+        /* the copies used for frame threading are rebuilt with the new
+         * settings on the next frame */
+        frame_threads_flush(filter);
+        frame_threads_free(filter);
         return filter->filter->process_command(filter, cmd, arg, res, res_len, flags);
     }
     return AVERROR(ENOSYS);
@@ -628,8 +660,9 @@ static const AVClass *filter_child_class_iterate(void **iter)
 #define TFLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_RUNTIME_PARAM
 static const AVOption avfilter_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
-        { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, FLAGS, "thread_type" },
+        { .i64 = AVFILTER_THREAD_SLICE | AVFILTER_THREAD_FRAME }, 0, INT_MAX, FLAGS, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = FLAGS, .unit = "thread_type" },
+        { "frame", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_FRAME }, .flags = FLAGS, .unit = "thread_type" },
     { "enable", "set enable expression", OFFSET(enable_str), AV_OPT_TYPE_STRING, {.str=NULL}, .flags = TFLAGS },
     { "threads", "Allowed number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, FLAGS },
@@ -766,6 +799,8 @@ void avfilter_free(AVFilterContext *filter)
     if (filter->graph)
         ff_filter_graph_remove_filter(filter->graph, filter);
 
+    frame_threads_free(filter);
+
     if (filter->filter->uninit)
         filter->filter->uninit(filter);
 
@@ -897,7 +932,7 @@ int ff_filter_process_command(AVFilterContext *ctx, const char *cmd,
 
 int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
 {
-    int ret = 0;
+    int ret = 0, thread_type;
 
     ret = av_opt_set_dict(ctx, options);
     if (ret < 0) {
@@ -905,14 +940,19 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         return ret;
     }
 
+    thread_type      = ctx->thread_type & ctx->graph->thread_type;
+    ctx->thread_type = 0;
     if (ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS &&
-        ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_SLICE &&
+        thread_type & AVFILTER_THREAD_SLICE &&
         ctx->graph->internal->thread_execute) {
         ctx->thread_type       = AVFILTER_THREAD_SLICE;
         ctx->internal->execute = ctx->graph->internal->thread_execute;
-    } else {
-        ctx->thread_type = 0;
     }
+    if (ctx->filter->flags & AVFILTER_FLAG_FRAME_THREADS &&
+        thread_type & AVFILTER_THREAD_FRAME &&
+        ctx->graph->internal->thread_execute &&
+        ff_filter_get_nb_threads(ctx) > 1)
+        ctx->thread_type |= AVFILTER_THREAD_FRAME;
 
     if (ctx->filter->priv_class) {
         ret = av_opt_set_dict2(ctx->priv, options, AV_OPT_SEARCH_CHILDREN);
@@ -1023,6 +1063,14 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
     int ret;
     FF_TPRINTF_START(NULL, filter_frame); ff_tlog_link(NULL, link, 1); ff_tlog(NULL, " "); tlog_ref(NULL, frame, 1);
 
+    /* Output of a frame threading copy, see filter_frame_threaded(). */
+    if (!link->dst) {
+        ret = ff_framequeue_add(&link->fifo, frame);
+        if (ret < 0)
+            av_frame_free(&frame);
+        return ret;
+    }
+
     /* Consistency checks */
     if (link->type == AVMEDIA_TYPE_VIDEO) {
         if (strcmp(link->dst->filter->name, "buffersink") &&
@@ -1058,6 +1106,9 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         av_frame_free(&frame);
         return ret;
     }
+    if (link->dst->graph->stats)
+        link->max_queued_frames = FFMAX(link->max_queued_frames,
+                                        ff_framequeue_queued_frames(&link->fifo));
     ff_filter_set_ready(link->dst, 300);
     return 0;
 
@@ -1073,6 +1124,24 @@ static int samples_ready(AVFilterLink *link, unsigned min)
             link->status_in);
 }
 
+/**
+ * Check that the data of all the planes of an audio frame is aligned as
+ * ff_get_audio_buffer() would align it, so that it can be passed to
+ * filters without copy even after samples were skipped from it.
+ */
+static int samples_aligned(const AVFrame *frame)
+{
+    int planes = av_sample_fmt_is_planar(frame->format) ?
+                 frame->ch_layout.nb_channels : 1;
+    uintptr_t align = av_cpu_max_align() - 1;
+    int i;
+
+    for (i = 0; i < planes; i++)
+        if ((uintptr_t)frame->extended_data[i] & align)
+            return 0;
+    return 1;
+}
+
 static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
                         AVFrame **rframe)
 {
@@ -1084,8 +1153,25 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
        called with enough samples. */
     av_assert1(samples_ready(link, link->min_samples));
     frame0 = frame = ff_framequeue_peek(&link->fifo, 0);
-    if (!link->fifo.samples_skipped && frame->nb_samples >= min && frame->nb_samples <= max) {
-        *rframe = ff_framequeue_take(&link->fifo);
+    if (frame->nb_samples >= min &&
+        (!link->fifo.samples_skipped || samples_aligned(frame))) {
+        if (frame->nb_samples <= max) {
+            *rframe = ff_framequeue_take(&link->fifo);
+            return 0;
+        }
+        /* The requested samples are all in the first frame: return a
+           reference to them and leave the rest queued. */
+        buf = av_frame_alloc();
+        if (!buf)
+            return AVERROR(ENOMEM);
+        ret = av_frame_ref(buf, frame);
+        if (ret < 0) {
+            av_frame_free(&buf);
+            return ret;
+        }
+        buf->nb_samples = max;
+        ff_framequeue_skip_samples(&link->fifo, max, link->time_base);
+        *rframe = buf;
         return 0;
     }
     nb_frames = 0;
@@ -1132,12 +1218,292 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
     return 0;
 }
 
+/**
+ * Frame threading: a filter flagged with AVFILTER_FLAG_FRAME_THREADS gets
+ * one copy per thread, each with private input and output links mirroring
+ * the real ones. The frames queued on the input are filtered concurrently,
+ * one per copy, and the output of the copies is then sent on the real
+ * output link in input order. The filter instance in the graph is only
+ * used when commands are pending.
+ */
+typedef struct FrameThreadJob {
+    AVFrame *frame;
+    int64_t frame_count_in, frame_count_out;
+    int64_t current_pts, current_pts_us;
+    int is_disabled;
+    int ret;
+} FrameThreadJob;
+
+typedef struct FrameThreadContext {
+    AVFilterContext **copies;
+    FrameThreadJob *jobs;
+    int nb_copies;
+} FrameThreadContext;
+
+/* Destination pad of the output links of the copies: it has no get_buffer
+ * callback, so the copies allocate from their own frame pools. */
+static const AVFilterPad frame_thread_sink_pad = {
+    .name = "frame_thread",
+    .type = AVMEDIA_TYPE_VIDEO,
+};
+
+static void frame_threads_free(AVFilterContext *ctx)
+{
+    FrameThreadContext *ft = ctx->internal->frame_threads;
+
+    if (!ft)
+        return;
+    for (int i = 0; i < ft->nb_copies; i++) {
+        if (ft->copies[i]) {
+            ft->copies[i]->graph = NULL;
+            avfilter_free(ft->copies[i]);
+        }
+    }
+    av_freep(&ft->copies);
+    av_freep(&ft->jobs);
+    av_freep(&ctx->internal->frame_threads);
+}
+
+static AVFilterLink *frame_thread_link(const AVFilterLink *link)
+{
+    AVFilterLink *copy = av_malloc(sizeof(*copy));
+
+    if (!copy)
+        return NULL;
+    *copy = *link;
+    copy->src    = copy->dst    = NULL;
+    copy->srcpad = copy->dstpad = NULL;
+    copy->graph  = NULL;
+    memset(&copy->incfg,  0, sizeof(copy->incfg));
+    memset(&copy->outcfg, 0, sizeof(copy->outcfg));
+    memset(&copy->ch_layout, 0, sizeof(copy->ch_layout));
+    copy->age_index        = -1;
+    copy->frame_pool       = NULL;
+    copy->frame_wanted_out = 0;
+    copy->frame_blocked_in = 0;
+    copy->status_in        = 0;
+    copy->status_out       = 0;
+    memset(&copy->fifo, 0, sizeof(copy->fifo));
+    ff_framequeue_init(&copy->fifo, &link->graph->internal->frame_queues);
+    copy->hw_frames_ctx    = NULL;
+    if (link->hw_frames_ctx &&
+        !(copy->hw_frames_ctx = av_buffer_ref(link->hw_frames_ctx))) {
+        av_free(copy);
+        return NULL;
+    }
+    return copy;
+}
+
+static int frame_thread_copy(AVFilterContext *ctx, AVFilterContext **pcopy)
+{
+    AVFilterContext *copy;
+    AVFilterLink *link;
+    int ret;
+
+    *pcopy = copy = ff_filter_alloc(ctx->filter, ctx->name);
+    if (!copy)
+        return AVERROR(ENOMEM);
+    copy->graph           = ctx->graph;
+    copy->thread_type     = 0;
+    copy->extra_hw_frames = ctx->extra_hw_frames;
+    if (ctx->hw_device_ctx &&
+        !(copy->hw_device_ctx = av_buffer_ref(ctx->hw_device_ctx)))
+        return AVERROR(ENOMEM);
+    if (ctx->filter->priv_class) {
+        ret = av_opt_copy(copy->priv, ctx->priv);
+        if (ret < 0)
+            return ret;
+    }
+    ret = avfilter_init_dict(copy, NULL);
+    if (ret < 0)
+        return ret;
+
+    if (!(link = frame_thread_link(ctx->inputs[0])))
+        return AVERROR(ENOMEM);
+    link->dst        = copy;
+    link->dstpad     = &copy->input_pads[0];
+    copy->inputs[0]  = link;
+
+    if (!(link = frame_thread_link(ctx->outputs[0])))
+        return AVERROR(ENOMEM);
+    link->src        = copy;
+    link->srcpad     = &copy->output_pads[0];
+    link->dstpad     = (AVFilterPad *)&frame_thread_sink_pad;
+    copy->outputs[0] = link;
+
+    /* same order as avfilter_config_links() */
+    link = copy->inputs[0];
+    if (link->dstpad->config_props && (ret = link->dstpad->config_props(link)) < 0)
+        return ret;
+    link = copy->outputs[0];
+    if (link->srcpad->config_props && (ret = link->srcpad->config_props(link)) < 0)
+        return ret;
+    return 0;
+}
+
+static int frame_threads_init(AVFilterContext *ctx)
+{
+    FrameThreadContext *ft;
+    int nb_copies = ff_filter_get_nb_threads(ctx);
+    int ret;
+
+    ft = ctx->internal->frame_threads = av_mallocz(sizeof(*ft));
+    if (!ft)
+        return AVERROR(ENOMEM);
+    ft->copies = av_calloc(nb_copies, sizeof(*ft->copies));
+    ft->jobs   = av_calloc(nb_copies, sizeof(*ft->jobs));
+    if (!ft->copies || !ft->jobs) {
+        frame_threads_free(ctx);
+        return AVERROR(ENOMEM);
+    }
+    ft->nb_copies = nb_copies;
+
+    for (int i = 0; i < nb_copies; i++) {
+        ret = frame_thread_copy(ctx, &ft->copies[i]);
+        if (ret < 0) {
+            frame_threads_free(ctx);
+            return ret;
+        }
+    }
+    return 0;
+}
+
+static int frame_thread_worker(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FrameThreadContext *ft = arg;
+    FrameThreadJob *job    = &ft->jobs[jobnr];
+    AVFilterContext *copy  = ft->copies[jobnr];
+    AVFilterLink *link     = copy->inputs[0];
+    int (*filter_frame)(AVFilterLink *, AVFrame *) = link->dstpad->filter_frame;
+
+    link->frame_count_in  = job->frame_count_in;
+    link->frame_count_out = job->frame_count_out;
+    link->current_pts     = job->current_pts;
+    link->current_pts_us  = job->current_pts_us;
+    copy->is_disabled     = job->is_disabled;
+
+    if (!filter_frame || (copy->is_disabled &&
+                          (copy->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC)))
+        filter_frame = default_filter_frame;
+    job->ret   = filter_frame(link, job->frame);
+    job->frame = NULL;
+    return 0;
+}
+
+static int frame_threads_run(AVFilterLink *link, int nb_jobs)
+{
+    AVFilterContext *dst = link->dst;
+    AVFilterLink *outlink = dst->outputs[0];
+    FrameThreadContext *ft = dst->internal->frame_threads;
+    int i, ret = 0;
+
+    for (i = 0; i < nb_jobs; i++) {
+        FrameThreadJob *job = &ft->jobs[i];
+
+        ff_inlink_consume_frame(link, &job->frame);
+        if (link->dstpad->flags & AVFILTERPAD_FLAG_NEEDS_WRITABLE) {
+            ret = ff_inlink_make_frame_writable(link, &job->frame);
+            if (ret < 0) {
+                av_frame_free(&job->frame);
+                break;
+            }
+        }
+        /* as seen by filter_frame(), see ff_filter_frame_to_filter() */
+        job->frame_count_in  = link->frame_count_in;
+        job->frame_count_out = link->frame_count_out - 1;
+        job->current_pts     = link->current_pts;
+        job->current_pts_us  = link->current_pts_us;
+        job->is_disabled     = dst->is_disabled;
+    }
+    nb_jobs = i;
+    filter_unblock(dst);
+
+    if (nb_jobs)
+        dst->graph->internal->thread_execute(dst, frame_thread_worker, ft, NULL, nb_jobs);
+
+    for (i = 0; i < nb_jobs; i++) {
+        AVFilterLink *out = ft->copies[i]->outputs[0];
+
+        while (ff_framequeue_queued_frames(&out->fifo)) {
+            AVFrame *frame = ff_framequeue_take(&out->fifo);
+
+            if (ret < 0)
+                av_frame_free(&frame);
+            else
+                ret = ff_filter_frame(outlink, frame);
+        }
+        if (ret >= 0)
+            ret = ft->jobs[i].ret;
+    }
+
+    if (ret < 0 && ret != link->status_out) {
+        ff_avfilter_link_set_out_status(link, ret, AV_NOPTS_VALUE);
+    } else {
+        ff_filter_set_ready(dst, 300);
+    }
+    return ret;
+}
+
+/**
+ * Filter the frames queued before a command changes the settings of the
+ * filter, so that the command applies to the same frames as without frame
+ * threading.
+ */
+static void frame_threads_flush(AVFilterContext *ctx)
+{
+    FrameThreadContext *ft = ctx->internal->frame_threads;
+    AVFilterLink *link = ctx->inputs[0];
+    size_t queued;
+
+    while (ft && !link->status_out &&
+           (queued = ff_framequeue_queued_frames(&link->fifo)))
+        frame_threads_run(link, FFMIN(queued, ft->nb_copies));
+}
+
+static int filter_frame_threaded(AVFilterLink *link)
+{
+    AVFilterContext *dst = link->dst;
+    FrameThreadContext *ft = dst->internal->frame_threads;
+    int ret, nb_jobs;
+
+    if (!ft) {
+        ret = frame_threads_init(dst);
+        if (ret < 0) {
+            av_log(dst, AV_LOG_WARNING, "Frame threading disabled: %s.\n",
+                   av_err2str(ret));
+            dst->thread_type &= ~AVFILTER_THREAD_FRAME;
+            ff_filter_set_ready(dst, 300);
+            return 0;
+        }
+        ft = dst->internal->frame_threads;
+    }
+
+    /* Wait until there is a frame for every copy, unless no more frames
+       can come or be sent. */
+    nb_jobs = FFMIN(ff_framequeue_queued_frames(&link->fifo), ft->nb_copies);
+    if (nb_jobs < ft->nb_copies && !link->status_in &&
+        !ff_outlink_get_status(dst->outputs[0])) {
+        ff_inlink_request_frame(link);
+        return 0;
+    }
+
+    return frame_threads_run(link, nb_jobs);
+}
+
 static int ff_filter_frame_to_filter(AVFilterLink *link)
 {
     AVFrame *frame = NULL;
     AVFilterContext *dst = link->dst;
     int ret;
 
+    if (dst->thread_type & AVFILTER_THREAD_FRAME) {
+        if (!dst->command_queue)
+            return filter_frame_threaded(link);
+        /* queued commands are run in ff_filter_frame_framed(), one frame
+           at a time, and change the settings the copies were made with */
+        frame_threads_free(dst);
+    }
+
     av_assert1(ff_framequeue_queued_frames(&link->fifo));
     ret = link->min_samples ?
           ff_inlink_consume_samples(link, link->min_samples, link->max_samples, &frame) :
@@ -1352,21 +1718,100 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      [buffersrc1][testsrc1][buffersrc2][testsrc2]concat=v=2).
  */
 
+static int activate_filter(AVFilterContext *filter)
+{
+    int ret = filter->filter->activate ? filter->filter->activate(filter) :
+              ff_filter_activate_default(filter);
+    return ret == FFERROR_NOT_READY ? 0 : ret;
+}
+
+static int64_t stats_real_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    if (!clock_gettime(CLOCK_MONOTONIC, &ts))
+        return ts.tv_sec * INT64_C(1000000000) + ts.tv_nsec;
+#endif
+    return av_gettime_relative() * 1000;
+}
+
+static int64_t stats_cpu_time(void)
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_THREAD_CPUTIME_ID)
+    struct timespec ts;
+    if (!clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts))
+        return ts.tv_sec * INT64_C(1000000000) + ts.tv_nsec;
+#endif
+    return AV_NOPTS_VALUE;
+}
+
 int ff_filter_activate(AVFilterContext *filter)
 {
+    AVFilterInternal *fi = filter->internal;
+    int64_t real_time, cpu_time;
     int ret;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
     filter->ready = 0;
-    ret = filter->filter->activate ? filter->filter->activate(filter) :
-          ff_filter_activate_default(filter);
-    if (ret == FFERROR_NOT_READY)
-        ret = 0;
+    if (!filter->graph->stats)
+        return activate_filter(filter);
+
+    real_time = stats_real_time();
+    cpu_time  = stats_cpu_time();
+    ret = activate_filter(filter);
+    fi->real_time_ns += stats_real_time() - real_time;
+    if (cpu_time != AV_NOPTS_VALUE)
+        fi->cpu_time_ns += stats_cpu_time() - cpu_time;
+    fi->stats.nb_activations++;
     return ret;
 }
 
+const AVFilterStats *avfilter_get_stats(AVFilterContext *filter)
+{
+    AVFilterInternal *fi = filter->internal;
+    AVFilterStats *stats = &fi->stats;
+    unsigned i;
+
+    if (!filter->graph || !filter->graph->stats)
+        return NULL;
+
+    stats->nb_frames_in      = 0;
+    stats->nb_queued_frames  = 0;
+    stats->max_queued_frames = 0;
+    for (i = 0; i < filter->nb_inputs; i++) {
+        AVFilterLink *link = filter->inputs[i];
+        if (!link)
+            continue;
+        stats->nb_frames_in     += link->frame_count_out;
+        stats->nb_queued_frames += ff_framequeue_queued_frames(&link->fifo);
+        stats->max_queued_frames = FFMAX(stats->max_queued_frames,
+                                         link->max_queued_frames);
+    }
+    stats->nb_frames_out   = 0;
+    stats->bytes_allocated = 0;
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterLink *link = filter->outputs[i];
+        if (!link)
+            continue;
+        stats->nb_frames_out += link->frame_count_in;
+        if (link->frame_pool)
+            stats->bytes_allocated += ff_frame_pool_get_allocated(link->frame_pool);
+    }
+    if (fi->frame_threads) {
+        for (i = 0; i < fi->frame_threads->nb_copies; i++) {
+            AVFilterLink *link = fi->frame_threads->copies[i]->outputs[0];
+            if (link->frame_pool)
+                stats->bytes_allocated += ff_frame_pool_get_allocated(link->frame_pool);
+        }
+    }
+    stats->real_time = fi->real_time_ns / 1000;
+    stats->cpu_time  = HAVE_CLOCK_GETTIME && stats_cpu_time() != AV_NOPTS_VALUE ?
+                       fi->cpu_time_ns / 1000 : -1;
+    return stats;
+}
+
 int ff_inlink_acknowledge_status(AVFilterLink *link, int *rstatus, int64_t *rpts)
 {
     *rpts = link->current_pts;
@@ -141,6 +141,15 @@ enum AVMediaType avfilter_pad_get_type(const AVFilterPad *pads, int pad_idx);
  *   received by the filter on one of its inputs.
  */
 #define AVFILTER_FLAG_METADATA_ONLY         (1 << 3)
+/**
+ * The filter has one video input and one video output, and outputs exactly
+ * one frame for every input frame, without delay. It keeps no state between
+ * frames: once configured, filtering a frame only depends on the options,
+ * the link properties, the frame and, through the timeline, the frame
+ * count. Several frames can then be filtered concurrently by copies of the
+ * filter (see AVFILTER_THREAD_FRAME).
+ */
+#define AVFILTER_FLAG_FRAME_THREADS         (1 << 4)
 /**
  * Some filters support a generic "enable" expression option that can be used
  * to enable or disable a filter in the timeline. Filters supporting this
@@ -402,6 +411,20 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
 
+/**
+ * Activate filters of the graph that do not share any link concurrently.
+ * Only meaningful in AVFilterGraph.thread_type; the frames on each link stay
+ * in order. Has no effect when AVFilterGraph.execute is set.
+ */
+#define AVFILTER_THREAD_GRAPH (1 << 1)
+
+/**
+ * Filter several frames concurrently, on copies of a filter that keeps no
+ * state between frames. Output frames keep their order. Not set by default
+ * in AVFilterGraph.thread_type.
+ */
+#define AVFILTER_THREAD_FRAME (1 << 2)
+
 typedef struct AVFilterInternal AVFilterInternal;
 
 /** An instance of a filter */
@@ -717,6 +740,18 @@ struct AVFilterLink {
      */
     int status_out;
 
+    /**
+     * Serial number of the last batch of concurrently activated filters
+     * that used this link, see ff_filter_graph_run_once().
+     */
+    unsigned activate_serial;
+
+    /**
+     * Highest number of frames queued in fifo, if the graph collects
+     * statistics.
+     */
+    size_t max_queued_frames;
+
 #endif /* FF_INTERNAL_FIELDS */
 
 };
@@ -886,6 +921,10 @@ typedef struct AVFilterGraph {
      * bit AND with AVFilterContext.thread_type to get the final mask used for
      * determining allowed threading types. I.e. a threading type needs to be
      * set in both to be allowed.
+     *
+     * AVFILTER_THREAD_GRAPH and AVFILTER_THREAD_FRAME are not set by default.
+     * AVFILTER_THREAD_GRAPH applies to the graph as a whole; it must be set
+     * before adding any filters to the filtergraph.
      */
     int thread_type;
 
@@ -924,6 +963,23 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Collect statistics for every filter of the graph, see
+     * avfilter_get_stats(). Must be set before the graph is configured.
+     */
+    int stats;
+
+    /**
+     * Thread pool to run the jobs of the internal threading implementation
+     * on, instead of threads created for this graph. nb_threads still limits
+     * the number of threads working on one job batch at once. The graph
+     * keeps a reference to the pool, and passes it on to the scaling
+     * contexts of its scale filters.
+     *
+     * May be set by the caller before adding any filters to the graph.
+     */
+    struct AVThreadPool *thread_pool;
+
     /**
      * Private fields
      *
@@ -1169,6 +1225,67 @@ int avfilter_graph_queue_command(AVFilterGraph *graph, const char *target, const
  */
 char *avfilter_graph_dump(AVFilterGraph *graph, const char *options);
 
+/**
+ * Statistics collected for a filter when AVFilterGraph.stats is set.
+ *
+ * sizeof(AVFilterStats) is not a part of the public ABI, new fields may be
+ * added at the end with a minor version bump.
+ */
+typedef struct AVFilterStats {
+    /**
+     * Number of frames consumed on all the inputs of the filter.
+     */
+    int64_t nb_frames_in;
+
+    /**
+     * Number of frames sent on all the outputs of the filter.
+     */
+    int64_t nb_frames_out;
+
+    /**
+     * Number of times the filter was activated.
+     */
+    int64_t nb_activations;
+
+    /**
+     * Wall clock time spent in the filter, in microseconds.
+     */
+    int64_t real_time;
+
+    /**
+     * CPU time spent in the filter by the thread activating it, in
+     * microseconds; the work done in slice or frame threads is not
+     * included. -1 if not available on the platform.
+     */
+    int64_t cpu_time;
+
+    /**
+     * Number of frames currently queued on the inputs of the filter.
+     */
+    int64_t nb_queued_frames;
+
+    /**
+     * Highest number of frames queued on any input of the filter.
+     */
+    int64_t max_queued_frames;
+
+    /**
+     * Number of bytes allocated for the frames of the output links of the
+     * filter, not counting buffers that were reused.
+     */
+    int64_t bytes_allocated;
+} AVFilterStats;
+
+/**
+ * Get the statistics of a filter.
+ *
+ * @param filter a filter of a graph with AVFilterGraph.stats set
+ * @return statistics owned by the filter, updated by this function and
+ *         valid until the filter is freed, or NULL if the statistics are
+ *         not collected for this filter
+ */
+const AVFilterStats *avfilter_get_stats(AVFilterContext *filter);
+
 /**
  * Request a frame on the oldest sink link.
  *
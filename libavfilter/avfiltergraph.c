@@ -48,6 +48,8 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "frame", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_FRAME }, .flags = F|V|A, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -55,6 +57,8 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    {"stats"                , "collect per-filter statistics"       , OFFSET(stats)                 ,
+        AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, F|V|A },
     { NULL },
 };
 
@@ -91,6 +95,12 @@ AVFilterGraph *avfilter_graph_alloc(void)
         return NULL;
     }
 
+    if (ff_mutex_init(&ret->internal->activate_lock, NULL)) {
+        av_freep(&ret->internal);
+        av_freep(&ret);
+        return NULL;
+    }
+
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
@@ -131,6 +141,8 @@ void avfilter_graph_free(AVFilterGraph **graph)
     av_opt_free(*graph);
 
     av_freep(&(*graph)->filters);
+    av_freep(&(*graph)->internal->activate_batch);
+    ff_mutex_destroy(&(*graph)->internal->activate_lock);
     av_freep(&(*graph)->internal);
     av_freep(graph);
 }
@@ -1122,6 +1134,30 @@ static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
     return 0;
 }
 
+/**
+ * Frame threading holds frames back until there is one for every thread:
+ * disable it when a filter may send commands to other filters, so that the
+ * commands apply to the same frames.
+ */
+static void graph_config_frame_threads(AVFilterGraph *graph, void *log_ctx)
+{
+    unsigned i;
+
+    for (i = 0; i < graph->nb_filters; i++)
+        if (graph->filters[i]->filter->flags_internal & FF_FILTER_FLAG_GRAPH_ACCESS)
+            break;
+    if (i == graph->nb_filters)
+        return;
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        if (f->thread_type & AVFILTER_THREAD_FRAME) {
+            av_log(log_ctx, AV_LOG_VERBOSE, "Frame threading disabled for %s.\n",
+                   f->name);
+            f->thread_type &= ~AVFILTER_THREAD_FRAME;
+        }
+    }
+}
+
 static int graph_config_pointers(AVFilterGraph *graph, void *log_ctx)
 {
     unsigned i, j;
@@ -1177,6 +1213,7 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_pointers(graphctx, log_ctx)))
         return ret;
+    graph_config_frame_threads(graphctx, log_ctx);
 
     return 0;
 }
@@ -1336,6 +1373,78 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+static int link_claimed(AVFilterLink *link, unsigned serial, int claim)
+{
+    if (link->activate_serial == serial)
+        return 1;
+    if (claim)
+        link->activate_serial = serial;
+    return 0;
+}
+
+/**
+ * Check whether activating the filter may touch a link already claimed by
+ * the current batch, and claim its links if requested.
+ * Activating a filter changes its inputs and outputs, and also the outputs
+ * of the filters it sends frames or status changes to (frame_blocked_in).
+ */
+static int filter_links_claimed(AVFilterContext *filter, unsigned serial, int claim)
+{
+    int claimed = 0;
+    unsigned i, j;
+
+    for (i = 0; i < filter->nb_inputs; i++)
+        claimed |= link_claimed(filter->inputs[i], serial, claim);
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterContext *dst = filter->outputs[i]->dst;
+
+        claimed |= link_claimed(filter->outputs[i], serial, claim);
+        for (j = 0; j < dst->nb_outputs; j++)
+            claimed |= link_claimed(dst->outputs[j], serial, claim);
+    }
+    return claimed;
+}
+
+/**
+ * Activate the most ready filter together with all the other ready filters
+ * that share no link with it nor with each other.
+ */
+static int graph_activate_batch(AVFilterGraph *graph, AVFilterContext *first)
+{
+    AVFilterGraphInternal *gi = graph->internal;
+    unsigned i, nb_batch = 0, serial;
+
+    if (gi->activate_batch_size < graph->nb_filters) {
+        AVFilterContext **batch = av_realloc_array(gi->activate_batch, graph->nb_filters,
+                                                   sizeof(*batch));
+        if (!batch)
+            return ff_filter_activate(first);
+        gi->activate_batch      = batch;
+        gi->activate_batch_size = graph->nb_filters;
+    }
+
+    serial = ++gi->activate_serial;
+    if (!serial)
+        serial = ++gi->activate_serial;
+
+    filter_links_claimed(first, serial, 1);
+    gi->activate_batch[nb_batch++] = first;
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *filter = graph->filters[i];
+
+        if (filter == first || !filter->ready ||
+            filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_ACCESS ||
+            filter_links_claimed(filter, serial, 0))
+            continue;
+        filter_links_claimed(filter, serial, 1);
+        gi->activate_batch[nb_batch++] = filter;
+    }
+
+    if (nb_batch == 1)
+        return ff_filter_activate(first);
+    return gi->thread_activate(graph, gi->activate_batch, nb_batch);
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
     AVFilterContext *filter;
@@ -1348,5 +1457,8 @@ int ff_filter_graph_run_once(AVFilterGraph *graph)
             filter = graph->filters[i];
     if (!filter->ready)
         return AVERROR(EAGAIN);
+    if (graph->internal->thread_activate &&
+        !(filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_ACCESS))
+        return graph_activate_batch(graph, filter);
     return ff_filter_activate(filter);
 }
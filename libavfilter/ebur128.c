@@ -42,6 +42,7 @@
 */
 
 #include "ebur128.h"
+#include "ebur128dsp.h"
 
 #include <float.h>
 #include <limits.h>
@@ -80,12 +81,12 @@ struct FFEBUR128StateInternal {
     int *channel_map;
     /** How many samples fit in 100ms (rounded). */
     unsigned long samples_in_100ms;
-    /** BS.1770 filter coefficients (nominator). */
-    double b[5];
-    /** BS.1770 filter coefficients (denominator). */
-    double a[5];
+    /** BS.1770 K-weighting filter. */
+    EBUR128DSPContext dsp;
+    /** BS.1770 filter coefficients. */
+    double coeffs[EBUR128_NB_COEFFS];
     /** BS.1770 filter state. */
-    double v[5][5];
+    double v[5][EBUR128_STATE_SIZE];
     /** Histograms, used to calculate LRA. */
     unsigned long *block_energy_histogram;
     unsigned long *short_term_block_energy_histogram;
@@ -105,52 +106,9 @@ static DECLARE_ALIGNED(32, double, histogram_energy_boundaries)[1001];
 
 static void ebur128_init_filter(FFEBUR128State * st)
 {
-    int i, j;
-
-    double f0 = 1681.974450955533;
-    double G = 3.999843853973347;
-    double Q = 0.7071752369554196;
-
-    double K = tan(M_PI * f0 / (double) st->samplerate);
-    double Vh = pow(10.0, G / 20.0);
-    double Vb = pow(Vh, 0.4996667741545416);
-
-    double pb[3] = { 0.0, 0.0, 0.0 };
-    double pa[3] = { 1.0, 0.0, 0.0 };
-    double rb[3] = { 1.0, -2.0, 1.0 };
-    double ra[3] = { 1.0, 0.0, 0.0 };
-
-    double a0 = 1.0 + K / Q + K * K;
-    pb[0] = (Vh + Vb * K / Q + K * K) / a0;
-    pb[1] = 2.0 * (K * K - Vh) / a0;
-    pb[2] = (Vh - Vb * K / Q + K * K) / a0;
-    pa[1] = 2.0 * (K * K - 1.0) / a0;
-    pa[2] = (1.0 - K / Q + K * K) / a0;
-
-    f0 = 38.13547087602444;
-    Q = 0.5003270373238773;
-    K = tan(M_PI * f0 / (double) st->samplerate);
-
-    ra[1] = 2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
-    ra[2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
-
-    st->d->b[0] = pb[0] * rb[0];
-    st->d->b[1] = pb[0] * rb[1] + pb[1] * rb[0];
-    st->d->b[2] = pb[0] * rb[2] + pb[1] * rb[1] + pb[2] * rb[0];
-    st->d->b[3] = pb[1] * rb[2] + pb[2] * rb[1];
-    st->d->b[4] = pb[2] * rb[2];
-
-    st->d->a[0] = pa[0] * ra[0];
-    st->d->a[1] = pa[0] * ra[1] + pa[1] * ra[0];
-    st->d->a[2] = pa[0] * ra[2] + pa[1] * ra[1] + pa[2] * ra[0];
-    st->d->a[3] = pa[1] * ra[2] + pa[2] * ra[1];
-    st->d->a[4] = pa[2] * ra[2];
-
-    for (i = 0; i < 5; ++i) {
-        for (j = 0; j < 5; ++j) {
-            st->d->v[i][j] = 0.0;
-        }
-    }
+    ff_ebur128dsp_init(&st->d->dsp);
+    ff_ebur128_filter_coeffs(st->d->coeffs, st->samplerate);
+    memset(st->d->v, 0, sizeof(st->d->v));
 }
 
 static int ebur128_init_channel_map(FFEBUR128State * st)
@@ -314,56 +272,29 @@ void ff_ebur128_destroy(FFEBUR128State ** st)
     *st = NULL;
 }
 
-#define EBUR128_FILTER(type, scaling_factor)                                       \
-static void ebur128_filter_##type(FFEBUR128State* st, const type** srcs,           \
-                                  size_t src_index, size_t frames,                 \
-                                  int stride) {                                    \
-    double* audio_data = st->d->audio_data + st->d->audio_data_index;              \
-    size_t i, c;                                                                   \
-                                                                                   \
-    if ((st->mode & FF_EBUR128_MODE_SAMPLE_PEAK) == FF_EBUR128_MODE_SAMPLE_PEAK) { \
-        for (c = 0; c < st->channels; ++c) {                                       \
-            double max = 0.0;                                                      \
-            for (i = 0; i < frames; ++i) {                                         \
-                type v = srcs[c][src_index + i * stride];                          \
-                if (v > max) {                                                     \
-                    max =        v;                                                \
-                } else if (-v > max) {                                             \
-                    max = -1.0 * v;                                                \
-                }                                                                  \
-            }                                                                      \
-            max /= scaling_factor;                                                 \
-            if (max > st->d->sample_peak[c]) st->d->sample_peak[c] = max;          \
-        }                                                                          \
-    }                                                                              \
-    for (c = 0; c < st->channels; ++c) {                                           \
-        int ci = st->d->channel_map[c] - 1;                                        \
-        if (ci < 0) continue;                                                      \
-        else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */            \
-        for (i = 0; i < frames; ++i) {                                             \
-            st->d->v[ci][0] = (double) (srcs[c][src_index + i * stride] / scaling_factor) \
-                         - st->d->a[1] * st->d->v[ci][1]                           \
-                         - st->d->a[2] * st->d->v[ci][2]                           \
-                         - st->d->a[3] * st->d->v[ci][3]                           \
-                         - st->d->a[4] * st->d->v[ci][4];                          \
-            audio_data[i * st->channels + c] =                                     \
-                           st->d->b[0] * st->d->v[ci][0]                           \
-                         + st->d->b[1] * st->d->v[ci][1]                           \
-                         + st->d->b[2] * st->d->v[ci][2]                           \
-                         + st->d->b[3] * st->d->v[ci][3]                           \
-                         + st->d->b[4] * st->d->v[ci][4];                          \
-            st->d->v[ci][4] = st->d->v[ci][3];                                     \
-            st->d->v[ci][3] = st->d->v[ci][2];                                     \
-            st->d->v[ci][2] = st->d->v[ci][1];                                     \
-            st->d->v[ci][1] = st->d->v[ci][0];                                     \
-        }                                                                          \
-        st->d->v[ci][4] = fabs(st->d->v[ci][4]) < DBL_MIN ? 0.0 : st->d->v[ci][4]; \
-        st->d->v[ci][3] = fabs(st->d->v[ci][3]) < DBL_MIN ? 0.0 : st->d->v[ci][3]; \
-        st->d->v[ci][2] = fabs(st->d->v[ci][2]) < DBL_MIN ? 0.0 : st->d->v[ci][2]; \
-        st->d->v[ci][1] = fabs(st->d->v[ci][1]) < DBL_MIN ? 0.0 : st->d->v[ci][1]; \
-    }                                                                              \
+static void ebur128_filter_double(FFEBUR128State* st, const double** srcs,
+                                  size_t src_index, size_t frames,
+                                  int stride) {
+    double* audio_data = st->d->audio_data + st->d->audio_data_index;
+    size_t c;
+
+    if ((st->mode & FF_EBUR128_MODE_SAMPLE_PEAK) == FF_EBUR128_MODE_SAMPLE_PEAK) {
+        for (c = 0; c < st->channels; ++c) {
+            double max = st->d->dsp.find_peak(0.0, srcs[c] + src_index,
+                                              stride, frames);
+            if (max > st->d->sample_peak[c]) st->d->sample_peak[c] = max;
+        }
+    }
+    for (c = 0; c < st->channels; ++c) {
+        int ci = st->d->channel_map[c] - 1;
+        if (ci < 0) continue;
+        else if (ci == FF_EBUR128_DUAL_MONO - 1) ci = 0; /*dual mono */
+        /* stores the squared filtered samples */
+        st->d->dsp.filter_channel(audio_data + c, st->channels,
+                                  srcs[c] + src_index, stride, frames,
+                                  st->d->coeffs, st->d->v[ci]);
+    }
 }
-EBUR128_FILTER(double, 1.0)
 
 static double ebur128_energy_to_loudness(double energy)
 {
@@ -401,25 +332,19 @@ static void ebur128_calc_gating_block(FFEBUR128State * st,
         channel_sum = 0.0;
         if (st->d->audio_data_index < frames_per_block * st->channels) {
             for (i = 0; i < st->d->audio_data_index / st->channels; ++i) {
-                channel_sum += st->d->audio_data[i * st->channels + c] *
-                    st->d->audio_data[i * st->channels + c];
+                channel_sum += st->d->audio_data[i * st->channels + c];
             }
             for (i = st->d->audio_data_frames -
                  (frames_per_block -
                   st->d->audio_data_index / st->channels);
                  i < st->d->audio_data_frames; ++i) {
-                channel_sum += st->d->audio_data[i * st->channels + c] *
-                    st->d->audio_data[i * st->channels + c];
+                channel_sum += st->d->audio_data[i * st->channels + c];
             }
         } else {
             for (i =
                  st->d->audio_data_index / st->channels - frames_per_block;
                  i < st->d->audio_data_index / st->channels; ++i) {
-                channel_sum +=
-                    st->d->audio_data[i * st->channels +
-                                      c] * st->d->audio_data[i *
-                                                             st->channels +
-                                                             c];
+                channel_sum += st->d->audio_data[i * st->channels + c];
             }
         }
         if (st->d->channel_map[c] == FF_EBUR128_Mp110 ||
@@ -0,0 +1,106 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <float.h>
+#include <math.h>
+
+#include "libavutil/attributes.h"
+#include "libavutil/common.h"
+#include "libavutil/mathematics.h"
+#include "ebur128dsp.h"
+
+void ff_ebur128_filter_coeffs(double *coeffs, int sample_rate)
+{
+    /* Unofficial reversed parametrization of PRE
+     * and RLB from 48kHz */
+
+    double f0 = 1681.974450955533;
+    double G = 3.999843853973347;
+    double Q = 0.7071752369554196;
+
+    double K = tan(M_PI * f0 / (double)sample_rate);
+    double Vh = pow(10.0, G / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+
+    double a0 = 1.0 + K / Q + K * K;
+
+    coeffs[EBUR128_PRE_B0] = (Vh + Vb * K / Q + K * K) / a0;
+    coeffs[EBUR128_PRE_B1] = 2.0 * (K * K - Vh) / a0;
+    coeffs[EBUR128_PRE_B2] = (Vh - Vb * K / Q + K * K) / a0;
+    coeffs[EBUR128_PRE_A1] = 2.0 * (K * K - 1.0) / a0;
+    coeffs[EBUR128_PRE_A2] = (1.0 - K / Q + K * K) / a0;
+
+    f0 = 38.13547087602444;
+    Q = 0.5003270373238773;
+    K = tan(M_PI * f0 / (double)sample_rate);
+
+    coeffs[EBUR128_RLB_B0] = 1.0;
+    coeffs[EBUR128_RLB_B1] = -2.0;
+    coeffs[EBUR128_RLB_B2] = 1.0;
+    coeffs[EBUR128_RLB_A1] = 2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
+    coeffs[EBUR128_RLB_A2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
+}
+
+static void filter_channel_c(double *dst, ptrdiff_t dst_stride,
+                             const double *src, ptrdiff_t src_stride,
+                             int nb_samples, const double *coeffs, double *state)
+{
+    const double pb0 = coeffs[EBUR128_PRE_B0], pb1 = coeffs[EBUR128_PRE_B1];
+    const double pb2 = coeffs[EBUR128_PRE_B2], pa1 = coeffs[EBUR128_PRE_A1];
+    const double pa2 = coeffs[EBUR128_PRE_A2];
+    const double rb0 = coeffs[EBUR128_RLB_B0], rb1 = coeffs[EBUR128_RLB_B1];
+    const double rb2 = coeffs[EBUR128_RLB_B2], ra1 = coeffs[EBUR128_RLB_A1];
+    const double ra2 = coeffs[EBUR128_RLB_A2];
+    double x1 = state[0], x2 = state[1];
+    double y1 = state[2], y2 = state[3];
+    double z1 = state[4], z2 = state[5];
+
+    for (int i = 0; i < nb_samples; i++) {
+        const double x0 = src[i * src_stride];
+        /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
+        const double y0 = x0 * pb0 + x1 * pb1 + x2 * pb2 - y1 * pa1 - y2 * pa2;
+        const double z0 = y0 * rb0 + y1 * rb1 + y2 * rb2 - z1 * ra1 - z2 * ra2;
+
+        dst[i * dst_stride] = z0 * z0;
+        x2 = x1; x1 = x0;
+        y2 = y1; y1 = y0;
+        z2 = z1; z1 = z0;
+    }
+
+#define FLUSH(x) (fabs(x) < DBL_MIN ? 0.0 : (x))
+    state[0] = x1;
+    state[1] = x2;
+    state[2] = FLUSH(y1);
+    state[3] = FLUSH(y2);
+    state[4] = FLUSH(z1);
+    state[5] = FLUSH(z2);
+}
+
+static double find_peak_c(double peak, const double *src, ptrdiff_t stride,
+                          int nb_samples)
+{
+    for (int i = 0; i < nb_samples; i++)
+        peak = FFMAX(peak, fabs(src[i * stride]));
+    return peak;
+}
+
+av_cold void ff_ebur128dsp_init(EBUR128DSPContext *dsp)
+{
+    dsp->filter_channel = filter_channel_c;
+    dsp->find_peak      = find_peak_c;
+}
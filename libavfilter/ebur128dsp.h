@@ -0,0 +1,63 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_EBUR128DSP_H
+#define AVFILTER_EBUR128DSP_H
+
+#include <stddef.h>
+
+enum {
+    EBUR128_PRE_B0, EBUR128_PRE_B1, EBUR128_PRE_B2, EBUR128_PRE_A1, EBUR128_PRE_A2,
+    EBUR128_RLB_B0, EBUR128_RLB_B1, EBUR128_RLB_B2, EBUR128_RLB_A1, EBUR128_RLB_A2,
+    EBUR128_NB_COEFFS,
+};
+
+/** Per channel filter state: x[n-1], x[n-2], y[n-1], y[n-2], z[n-1], z[n-2] */
+#define EBUR128_STATE_SIZE 6
+
+typedef struct EBUR128DSPContext {
+    /**
+     * Apply the BS.1770 K-weighting filter (pre-filter followed by the
+     * RLB high-pass filter) to one channel and store the squared output.
+     *
+     * @param dst        squared filtered samples
+     * @param dst_stride distance between two output samples, in elements
+     * @param src        input samples
+     * @param src_stride distance between two input samples, in elements
+     * @param coeffs     EBUR128_NB_COEFFS filter coefficients
+     * @param state      EBUR128_STATE_SIZE values, updated on return
+     */
+    void (*filter_channel)(double *dst, ptrdiff_t dst_stride,
+                           const double *src, ptrdiff_t src_stride,
+                           int nb_samples, const double *coeffs, double *state);
+
+    /**
+     * Return the largest of peak and the absolute values of the samples.
+     */
+    double (*find_peak)(double peak, const double *src, ptrdiff_t stride,
+                        int nb_samples);
+} EBUR128DSPContext;
+
+/**
+ * Compute the K-weighting filter coefficients for the given sample rate.
+ */
+void ff_ebur128_filter_coeffs(double *coeffs, int sample_rate);
+
+void ff_ebur128dsp_init(EBUR128DSPContext *dsp);
+
+#endif /* AVFILTER_EBUR128DSP_H */
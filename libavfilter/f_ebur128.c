@@ -39,6 +39,7 @@
 #include "libswresample/swresample.h"
 #include "audio.h"
 #include "avfilter.h"
+#include "ebur128dsp.h"
 #include "filters.h"
 #include "formats.h"
 #include "internal.h"
@@ -111,15 +112,12 @@ typedef struct EBUR128Context {
     int idx_insample;               ///< current sample position of processed samples in single input frame
     AVFrame *insamples;             ///< input samples reference, updated regularly
 
-    /* Filter caches.
-     * The mult by 3 in the following is for X[i], X[i-1] and X[i-2] */
-    double *x;                      ///< 3 input samples cache for each channel
-    double *y;                      ///< 3 pre-filter samples cache for each channel
-    double *z;                      ///< 3 RLB-filter samples cache for each channel
-    double pre_b[3];                ///< pre-filter numerator coefficients
-    double pre_a[3];                ///< pre-filter denominator coefficients
-    double rlb_b[3];                ///< rlb-filter numerator coefficients
-    double rlb_a[3];                ///< rlb-filter denominator coefficients
+    /* K-weighting filter */
+    EBUR128DSPContext dsp;
+    double coeffs[EBUR128_NB_COEFFS]; ///< pre-filter and RLB-filter coefficients
+    double *filter_state;           ///< EBUR128_STATE_SIZE values for each channel
+    double *bins;                   ///< filtered energies of the current 100ms chunk, per channel
+    int bins_size;                  ///< number of bins per channel
 
     struct integrator i400;         ///< 400ms integrator, used for Momentary loudness  (M), and Integrated loudness (I)
     struct integrator i3000;        ///<    3s integrator, used for Short term loudness (S), and Loudness Range      (LRA)
@@ -381,34 +379,8 @@ static int config_audio_input(AVFilterLink *inlink)
     AVFilterContext *ctx = inlink->dst;
     EBUR128Context *ebur128 = ctx->priv;
 
-    /* Unofficial reversed parametrization of PRE
-     * and RLB from 48kHz */
-
-    double f0 = 1681.974450955533;
-    double G = 3.999843853973347;
-    double Q = 0.7071752369554196;
-
-    double K = tan(M_PI * f0 / (double)inlink->sample_rate);
-    double Vh = pow(10.0, G / 20.0);
-    double Vb = pow(Vh, 0.4996667741545416);
-
-    double a0 = 1.0 + K / Q + K * K;
-
-    ebur128->pre_b[0] = (Vh + Vb * K / Q + K * K) / a0;
-    ebur128->pre_b[1] = 2.0 * (K * K - Vh) / a0;
-    ebur128->pre_b[2] = (Vh - Vb * K / Q + K * K) / a0;
-    ebur128->pre_a[1] = 2.0 * (K * K - 1.0) / a0;
-    ebur128->pre_a[2] = (1.0 - K / Q + K * K) / a0;
-
-    f0 = 38.13547087602444;
-    Q = 0.5003270373238773;
-    K = tan(M_PI * f0 / (double)inlink->sample_rate);
-
-    ebur128->rlb_b[0] = 1.0;
-    ebur128->rlb_b[1] = -2.0;
-    ebur128->rlb_b[2] = 1.0;
-    ebur128->rlb_a[1] = 2.0 * (K * K - 1.0) / (1.0 + K / Q + K * K);
-    ebur128->rlb_a[2] = (1.0 - K / Q + K * K) / (1.0 + K / Q + K * K);
+    ff_ebur128_filter_coeffs(ebur128->coeffs, inlink->sample_rate);
+    ff_ebur128dsp_init(&ebur128->dsp);
 
     /* Force 100ms framing in case of metadata injection: the frames must have
      * a granularity of the window overlap to be accurately exploited.
@@ -434,11 +406,11 @@ static int config_audio_output(AVFilterLink *outlink)
                    AV_CH_SURROUND_DIRECT_LEFT               |AV_CH_SURROUND_DIRECT_RIGHT)
 
     ebur128->nb_channels  = nb_channels;
-    ebur128->x            = av_calloc(nb_channels, 3 * sizeof(*ebur128->x));
-    ebur128->y            = av_calloc(nb_channels, 3 * sizeof(*ebur128->y));
-    ebur128->z            = av_calloc(nb_channels, 3 * sizeof(*ebur128->z));
+    ebur128->bins_size    = FFMAX(outlink->sample_rate / 10, 1);
+    ebur128->filter_state = av_calloc(nb_channels, EBUR128_STATE_SIZE * sizeof(*ebur128->filter_state));
+    ebur128->bins         = av_calloc(nb_channels, ebur128->bins_size * sizeof(*ebur128->bins));
     ebur128->ch_weighting = av_calloc(nb_channels, sizeof(*ebur128->ch_weighting));
-    if (!ebur128->ch_weighting || !ebur128->x || !ebur128->y || !ebur128->z)
+    if (!ebur128->ch_weighting || !ebur128->filter_state || !ebur128->bins)
         return AVERROR(ENOMEM);
 
 #define I400_BINS(x)  ((x) * 4 / 10)
@@ -487,11 +459,11 @@ static int config_audio_output(AVFilterLink *outlink)
             !ebur128->true_peaks_per_frame || !ebur128->swr_ctx)
             return AVERROR(ENOMEM);
 
-        av_opt_set_chlayout(ebur128->swr_ctx, "in_ch_layout",   &outlink->ch_layout, 0);
+        av_opt_set_chlayout(ebur128->swr_ctx, "in_chlayout",    &outlink->ch_layout, 0);
         av_opt_set_int(ebur128->swr_ctx, "in_sample_rate",       outlink->sample_rate, 0);
         av_opt_set_sample_fmt(ebur128->swr_ctx, "in_sample_fmt", outlink->format, 0);
 
-        av_opt_set_chlayout(ebur128->swr_ctx, "out_ch_layout",   &outlink->ch_layout, 0);
+        av_opt_set_chlayout(ebur128->swr_ctx, "out_chlayout",    &outlink->ch_layout, 0);
         av_opt_set_int(ebur128->swr_ctx, "out_sample_rate",       192000, 0);
         av_opt_set_sample_fmt(ebur128->swr_ctx, "out_sample_fmt", outlink->format, 0);
 
@@ -613,6 +585,70 @@ static int gate_update(struct integrator *integ, double power,
     return gate_hist_pos;
 }
 
+typedef struct ThreadData {
+    const double *samples;          ///< first sample of the chunk
+    int nb_samples;                 ///< number of samples in the chunk
+    const double *swr_samples;      ///< over-sampled frame for true peaks, or NULL
+    int nb_swr_samples;
+} ThreadData;
+
+static int filter_channels(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    EBUR128Context *ebur128 = ctx->priv;
+    const ThreadData *td = arg;
+    const int nb_channels = ebur128->nb_channels;
+    const int start = (nb_channels *  jobnr     ) / nb_jobs;
+    const int end   = (nb_channels * (jobnr + 1)) / nb_jobs;
+
+    for (int ch = start; ch < end; ch++) {
+        const double *src = td->samples + ch;
+        double *bins = ebur128->bins + ch * ebur128->bins_size;
+        double *cache_400, *cache_3000, sum_400, sum_3000;
+        int bin_id_400  = ebur128->i400.cache_pos;
+        int bin_id_3000 = ebur128->i3000.cache_pos;
+
+        if (td->swr_samples) {
+            double peak = ebur128->dsp.find_peak(0.0, td->swr_samples + ch,
+                                                 nb_channels, td->nb_swr_samples);
+            ebur128->true_peaks_per_frame[ch] = peak;
+            ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], peak);
+        }
+
+        if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
+            ebur128->sample_peaks[ch] = ebur128->dsp.find_peak(ebur128->sample_peaks[ch], src,
+                                                               nb_channels, td->nb_samples);
+
+        if (!ebur128->ch_weighting[ch])
+            continue;
+
+        ebur128->dsp.filter_channel(bins, 1, src, nb_channels, td->nb_samples, ebur128->coeffs,
+                                    ebur128->filter_state + ch * EBUR128_STATE_SIZE);
+
+        /* add the new values, and limit the sums to the cache size (400ms or
+         * 3s) by removing the oldest ones, which are then overridden */
+        cache_400  = ebur128->i400.cache[ch];
+        cache_3000 = ebur128->i3000.cache[ch];
+        sum_400    = ebur128->i400.sum[ch];
+        sum_3000   = ebur128->i3000.sum[ch];
+        for (int i = 0; i < td->nb_samples; i++) {
+            const double bin = bins[i];
+
+            sum_400  = sum_400  + bin - cache_400 [bin_id_400];
+            sum_3000 = sum_3000 + bin - cache_3000[bin_id_3000];
+            cache_400 [bin_id_400 ] = bin;
+            cache_3000[bin_id_3000] = bin;
+            if (++bin_id_400 == ebur128->i400.cache_size)
+                bin_id_400 = 0;
+            if (++bin_id_3000 == ebur128->i3000.cache_size)
+                bin_id_3000 = 0;
+        }
+        ebur128->i400.sum[ch]  = sum_400;
+        ebur128->i3000.sum[ch] = sum_3000;
+    }
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
 {
     int i, ch, idx_insample;
@@ -620,88 +656,54 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *insamples)
     EBUR128Context *ebur128 = ctx->priv;
     const int nb_channels = ebur128->nb_channels;
     const int nb_samples  = insamples->nb_samples;
+    const int samples_100ms = inlink->sample_rate / 10;
+    const int nb_jobs = FFMIN(nb_channels, ff_filter_get_nb_threads(ctx));
     const double *samples = (double *)insamples->data[0];
     AVFrame *pic = ebur128->outpicref;
+    ThreadData td = { 0 };
 
 #if CONFIG_SWRESAMPLE
     if (ebur128->peak_mode & PEAK_MODE_TRUE_PEAKS && ebur128->idx_insample == 0) {
-        const double *swr_samples = ebur128->swr_buf;
         int ret = swr_convert(ebur128->swr_ctx, (uint8_t**)&ebur128->swr_buf, 19200,
                               (const uint8_t **)insamples->data, nb_samples);
         if (ret < 0)
             return ret;
-        for (ch = 0; ch < nb_channels; ch++)
-            ebur128->true_peaks_per_frame[ch] = 0.0;
-        for (idx_insample = 0; idx_insample < ret; idx_insample++) {
-            for (ch = 0; ch < nb_channels; ch++) {
-                ebur128->true_peaks[ch] = FFMAX(ebur128->true_peaks[ch], fabs(*swr_samples));
-                ebur128->true_peaks_per_frame[ch] = FFMAX(ebur128->true_peaks_per_frame[ch],
-                                                          fabs(*swr_samples));
-                swr_samples++;
-            }
-        }
+        /* the peaks are searched along with the first chunk */
+        td.swr_samples    = ebur128->swr_buf;
+        td.nb_swr_samples = ret;
     }
 #endif
 
     for (idx_insample = ebur128->idx_insample; idx_insample < nb_samples; idx_insample++) {
-        const int bin_id_400  = ebur128->i400.cache_pos;
-        const int bin_id_3000 = ebur128->i3000.cache_pos;
-
-#define MOVE_TO_NEXT_CACHED_ENTRY(time) do {                \
-    ebur128->i##time.cache_pos++;                           \
-    if (ebur128->i##time.cache_pos ==                       \
+        /* process up to the next 100ms boundary at once, one channel per job */
+        int nb_todo = samples_100ms > 0 ? FFMIN(nb_samples - idx_insample,
+                                                samples_100ms - ebur128->sample_count) : 1;
+
+        td.samples    = samples + idx_insample * nb_channels;
+        td.nb_samples = nb_todo;
+        ff_filter_execute(ctx, filter_channels, &td, NULL, nb_jobs);
+        td.swr_samples = NULL;
+
+#define MOVE_TO_NEXT_CACHED_ENTRIES(time, n) do {           \
+    ebur128->i##time.cache_pos += n;                        \
+    if (ebur128->i##time.cache_pos >=                       \
         ebur128->i##time.cache_size) {                      \
-        ebur128->i##time.filled    = 1;                     \
-        ebur128->i##time.cache_pos = 0;                     \
+        ebur128->i##time.filled     = 1;                    \
+        ebur128->i##time.cache_pos -= ebur128->i##time.cache_size; \
     }                                                       \
 } while (0)
 
-        MOVE_TO_NEXT_CACHED_ENTRY(400);
-        MOVE_TO_NEXT_CACHED_ENTRY(3000);
-
-        for (ch = 0; ch < nb_channels; ch++) {
-            double bin;
-
-            if (ebur128->peak_mode & PEAK_MODE_SAMPLES_PEAKS)
-                ebur128->sample_peaks[ch] = FFMAX(ebur128->sample_peaks[ch], fabs(samples[idx_insample * nb_channels + ch]));
+        MOVE_TO_NEXT_CACHED_ENTRIES(400,  nb_todo);
+        MOVE_TO_NEXT_CACHED_ENTRIES(3000, nb_todo);
 
-            ebur128->x[ch * 3] = samples[idx_insample * nb_channels + ch]; // set X[i]
-
-            if (!ebur128->ch_weighting[ch])
-                continue;
-
-            /* Y[i] = X[i]*b0 + X[i-1]*b1 + X[i-2]*b2 - Y[i-1]*a1 - Y[i-2]*a2 */
-#define FILTER(Y, X, NUM, DEN) do {                                             \
-            double *dst = ebur128->Y + ch*3;                                    \
-            double *src = ebur128->X + ch*3;                                    \
-            dst[2] = dst[1];                                                    \
-            dst[1] = dst[0];                                                    \
-            dst[0] = src[0]*NUM[0] + src[1]*NUM[1] + src[2]*NUM[2]              \
-                                   - dst[1]*DEN[1] - dst[2]*DEN[2];             \
-} while (0)
-
-            // TODO: merge both filters in one?
-            FILTER(y, x, ebur128->pre_b, ebur128->pre_a);  // apply pre-filter
-            ebur128->x[ch * 3 + 2] = ebur128->x[ch * 3 + 1];
-            ebur128->x[ch * 3 + 1] = ebur128->x[ch * 3    ];
-            FILTER(z, y, ebur128->rlb_b, ebur128->rlb_a);  // apply RLB-filter
-
-            bin = ebur128->z[ch * 3] * ebur128->z[ch * 3];
-
-            /* add the new value, and limit the sum to the cache size (400ms or 3s)
-             * by removing the oldest one */
-            ebur128->i400.sum [ch] = ebur128->i400.sum [ch] + bin - ebur128->i400.cache [ch][bin_id_400];
-            ebur128->i3000.sum[ch] = ebur128->i3000.sum[ch] + bin - ebur128->i3000.cache[ch][bin_id_3000];
-
-            /* override old cache entry with the new value */
-            ebur128->i400.cache [ch][bin_id_400 ] = bin;
-            ebur128->i3000.cache[ch][bin_id_3000] = bin;
-        }
+        /* idx_insample is now the last sample of the chunk */
+        idx_insample          += nb_todo - 1;
+        ebur128->sample_count += nb_todo;
 
         /* For integrated loudness, gating blocks are 400ms long with 75%
          * overlap (see BS.1770-2 p5), so a re-computation is needed each 100ms
          * (4800 samples at 48kHz). */
-        if (++ebur128->sample_count == inlink->sample_rate / 10) {
+        if (ebur128->sample_count == samples_100ms) {
             double loudness_400, loudness_3000;
             double power_400 = 1e-12, power_3000 = 1e-12;
             AVFilterLink *outlink = ctx->outputs[0];
@@ -1055,9 +1057,8 @@ static av_cold void uninit(AVFilterContext *ctx)
     av_log(ctx, AV_LOG_INFO, "\n");
 
     av_freep(&ebur128->y_line_ref);
-    av_freep(&ebur128->x);
-    av_freep(&ebur128->y);
-    av_freep(&ebur128->z);
+    av_freep(&ebur128->filter_state);
+    av_freep(&ebur128->bins);
     av_freep(&ebur128->ch_weighting);
     av_freep(&ebur128->true_peaks);
     av_freep(&ebur128->sample_peaks);
@@ -1100,5 +1101,5 @@ const AVFilter ff_af_ebur128 = {
     .outputs       = NULL,
     FILTER_QUERY_FUNC(query_formats),
     .priv_class    = &ebur128_class,
-    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS,
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
+
 #include "framepool.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
@@ -46,8 +48,20 @@ struct FFFramePool {
     int linesize[4];
     AVBufferPool *pools[4];
 
+    AVBufferRef* (*alloc)(size_t size);
+    atomic_size_t allocated;
 };
 
+static AVBufferRef *pool_alloc(void *opaque, size_t size)
+{
+    FFFramePool *pool = opaque;
+    AVBufferRef *buf = pool->alloc ? pool->alloc(size) : av_buffer_alloc(size);
+
+    if (buf)
+        atomic_fetch_add_explicit(&pool->allocated, size, memory_order_relaxed);
+    return buf;
+}
+
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
                                       int width,
                                       int height,
@@ -64,6 +78,7 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
         return NULL;
 
     pool->type = AVMEDIA_TYPE_VIDEO;
+    pool->alloc = alloc;
     pool->width = width;
     pool->height = height;
     pool->format = format;
@@ -99,7 +114,8 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
     for (i = 0; i < 4 && sizes[i]; i++) {
         if (sizes[i] > SIZE_MAX - align)
             goto fail;
-        pool->pools[i] = av_buffer_pool_init(sizes[i] + align, alloc);
+        pool->pools[i] = av_buffer_pool_init2(sizes[i] + align, pool,
+                                              pool_alloc, NULL);
         if (!pool->pools[i])
             goto fail;
     }
@@ -127,6 +143,7 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
     planar = av_sample_fmt_is_planar(format);
 
     pool->type = AVMEDIA_TYPE_AUDIO;
+    pool->alloc = alloc;
     pool->planes = planar ? channels : 1;
     pool->channels = channels;
     pool->nb_samples = nb_samples;
@@ -138,7 +155,8 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
     if (ret < 0)
         goto fail;
 
-    pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
+    pool->pools[0] = av_buffer_pool_init2(pool->linesize[0], pool,
+                                          pool_alloc, NULL);
     if (!pool->pools[0])
         goto fail;
 
@@ -187,6 +205,21 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
     return 0;
 }
 
+size_t ff_frame_pool_get_allocated(FFFramePool *pool)
+{
+    return atomic_load_explicit(&pool->allocated, memory_order_relaxed);
+}
+
+void ff_frame_pool_replace(FFFramePool **pool, FFFramePool *new_pool)
+{
+    if (new_pool && *pool)
+        atomic_store_explicit(&new_pool->allocated,
+                              ff_frame_pool_get_allocated(*pool),
+                              memory_order_relaxed);
+    ff_frame_pool_uninit(pool);
+    *pool = new_pool;
+}
+
 AVFrame *ff_frame_pool_get(FFFramePool *pool)
 {
     int i;
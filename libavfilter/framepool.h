@@ -115,5 +115,23 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
  */
 AVFrame *ff_frame_pool_get(FFFramePool *pool);
 
+/**
+ * Get the number of bytes allocated by the pool so far; buffers reused
+ * from the pool are not counted again.
+ *
+ * @param pool pointer to the frame pool
+ * @return number of bytes allocated
+ */
+size_t ff_frame_pool_get_allocated(FFFramePool *pool);
+
+/**
+ * Uninit a frame pool and allocate a new one with a different configuration,
+ * carrying over the number of bytes allocated so far.
+ *
+ * @param pool pointer to the frame pool to replace, set to NULL on failure
+ * @param new_pool newly allocated frame pool, or NULL on failure
+ */
+void ff_frame_pool_replace(FFFramePool **pool, FFFramePool *new_pool);
+
 
 #endif /* AVFILTER_FRAMEPOOL_H */
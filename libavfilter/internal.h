@@ -25,6 +25,7 @@
  */
 
 #include "libavutil/internal.h"
+#include "libavutil/thread.h"
 #include "avfilter.h"
 #include "formats.h"
 #include "framequeue.h"
@@ -129,14 +130,46 @@ struct AVFilterPad {
     int (*config_props)(AVFilterLink *link);
 };
 
+typedef int (avfilter_activate_func)(AVFilterGraph *graph,
+                                     AVFilterContext **filters, int nb_filters);
+
 struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Activate filters sharing no link concurrently, set when
+     * AVFILTER_THREAD_GRAPH is enabled. Returns the first error, or 0.
+     */
+    avfilter_activate_func *thread_activate;
+    /**
+     * Set while thread_activate() runs; filter readiness and the sink links
+     * heap are then only updated with activate_lock held.
+     */
+    int activate_running;
+    AVMutex activate_lock;
+    AVFilterContext **activate_batch;
+    unsigned activate_batch_size;
+    unsigned activate_serial;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+
+    /**
+     * Copies of the filter used for frame threading, allocated on the first
+     * frame when AVFILTER_THREAD_FRAME is in use.
+     */
+    struct FrameThreadContext *frame_threads;
+
+    /**
+     * Statistics returned by avfilter_get_stats(); the times are
+     * accumulated in nanoseconds in real_time_ns and cpu_time_ns.
+     */
+    AVFilterStats stats;
+    int64_t real_time_ns;
+    int64_t cpu_time_ns;
 };
 
 static av_always_inline int ff_filter_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -369,6 +402,12 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses other filters or links of its graph, and must not be
+ * activated concurrently with any other filter (see AVFILTER_THREAD_GRAPH).
+ */
+#define FF_FILTER_FLAG_GRAPH_ACCESS (1 << 1)
+
 /**
  * Run one round of processing on a filter graph.
  */
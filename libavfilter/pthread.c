@@ -27,6 +27,7 @@
 #include "libavutil/macros.h"
 #include "libavutil/mem.h"
 #include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 
 #include "avfilter.h"
 #include "internal.h"
@@ -41,6 +42,13 @@ typedef struct ThreadContext {
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
+
+    /* graph-level threading, see thread_activate() */
+    AVSliceThread *activate_thread;
+    AVMutex execute_lock;
+    AVFilterContext **activate_filters;
+    int *activate_rets;
+    unsigned activate_rets_size;
 } ThreadContext;
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
@@ -51,9 +59,20 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
         c->rets[jobnr] = ret;
 }
 
+static void activate_worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    ThreadContext *c = priv;
+    c->activate_rets[jobnr] = ff_filter_activate(c->activate_filters[jobnr]);
+}
+
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    if (c->activate_thread) {
+        avpriv_slicethread_free(&c->activate_thread);
+        ff_mutex_destroy(&c->execute_lock);
+    }
+    av_freep(&c->activate_rets);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -63,18 +82,68 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+
+    /* filters activated concurrently share the slice threads */
+    if (c->activate_thread)
+        ff_mutex_lock(&c->execute_lock);
+
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
     c->rets        = ret;
 
     avpriv_slicethread_execute(c->thread, nb_jobs, 0);
+
+    if (c->activate_thread)
+        ff_mutex_unlock(&c->execute_lock);
+    return 0;
+}
+
+static int thread_activate(AVFilterGraph *graph, AVFilterContext **filters, int nb_filters)
+{
+    ThreadContext *c = graph->internal->thread;
+    int i, ret = 0;
+
+    av_fast_malloc(&c->activate_rets, &c->activate_rets_size,
+                   nb_filters * sizeof(*c->activate_rets));
+    if (!c->activate_rets)
+        return ff_filter_activate(filters[0]);
+    c->activate_filters = filters;
+
+    graph->internal->activate_running = 1;
+    avpriv_slicethread_execute(c->activate_thread, nb_filters, 0);
+    graph->internal->activate_running = 0;
+
+    for (i = 0; i < nb_filters; i++)
+        if (c->activate_rets[i] < 0) {
+            ret = c->activate_rets[i];
+            break;
+        }
+    return ret;
+}
+
+static int activate_init(ThreadContext *c, int nb_threads)
+{
+    int ret;
+
+    ret = ff_mutex_init(&c->execute_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
+    ret = avpriv_slicethread_create_pool(&c->activate_thread, c->graph->thread_pool,
+                                         c, activate_worker_func, NULL, nb_threads);
+    if (ret <= 1) {
+        avpriv_slicethread_free(&c->activate_thread);
+        ff_mutex_destroy(&c->execute_lock);
+        return ret < 0 ? ret : AVERROR(ENOSYS);
+    }
     return 0;
 }
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
-    nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
+    nb_threads = avpriv_slicethread_create_pool(&c->thread, c->graph->thread_pool,
+                                                c, worker_func, NULL, nb_threads);
     if (nb_threads <= 1)
         avpriv_slicethread_free(&c->thread);
     return FFMAX(nb_threads, 1);
@@ -82,6 +151,7 @@ static int thread_init_internal(ThreadContext *c, int nb_threads)
 
 int ff_graph_thread_init(AVFilterGraph *graph)
 {
+    ThreadContext *c;
     int ret;
 
     if (graph->nb_threads == 1) {
@@ -89,11 +159,12 @@ int ff_graph_thread_init(AVFilterGraph *graph)
         return 0;
     }
 
-    graph->internal->thread = av_mallocz(sizeof(ThreadContext));
-    if (!graph->internal->thread)
+    graph->internal->thread = c = av_mallocz(sizeof(ThreadContext));
+    if (!c)
         return AVERROR(ENOMEM);
+    c->graph = graph;
 
-    ret = thread_init_internal(graph->internal->thread, graph->nb_threads);
+    ret = thread_init_internal(c, graph->nb_threads);
     if (ret <= 1) {
         av_freep(&graph->internal->thread);
         graph->thread_type = 0;
@@ -104,6 +175,17 @@ int ff_graph_thread_init(AVFilterGraph *graph)
 
     graph->internal->thread_execute = thread_execute;
 
+    if (graph->thread_type & AVFILTER_THREAD_GRAPH) {
+        ret = activate_init(c, graph->nb_threads);
+        if (ret < 0) {
+            av_log(graph, AV_LOG_WARNING, "Graph-level threading unavailable: %s.\n",
+                   av_err2str(ret));
+            graph->thread_type &= ~AVFILTER_THREAD_GRAPH;
+        } else {
+            graph->internal->thread_activate = thread_activate;
+        }
+    }
+
     return 0;
 }
 
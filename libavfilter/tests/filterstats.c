@@ -0,0 +1,96 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run a small graph with AVFilterGraph.stats set and print the statistics
+ * which do not depend on timing. Only whether a filter allocated frames is
+ * printed, as the allocated sizes depend on the CPU alignment.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+
+static const char *graph_desc =
+    "testsrc=size=64x48:rate=25:duration=1, format=yuv420p, split [a][b];"
+    "[a] negate, buffersink@a;"
+    "[b] hflip, vflip, buffersink@b";
+
+int main(void)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterContext *sinks[2];
+    AVFrame *frame = av_frame_alloc();
+    int i, eof = 0, ret;
+
+    if (!graph || !frame)
+        return 1;
+    graph->stats = 1;
+    graph->nb_threads = 1;
+
+    ret = avfilter_graph_parse_ptr(graph, graph_desc, NULL, NULL, NULL);
+    if (ret >= 0)
+        ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Could not set up the graph: %s\n", av_err2str(ret));
+        goto end;
+    }
+    sinks[0] = avfilter_graph_get_filter(graph, "buffersink@a");
+    sinks[1] = avfilter_graph_get_filter(graph, "buffersink@b");
+
+    while (eof != 3) {
+        for (i = 0; i < 2; i++) {
+            if (eof & (1 << i))
+                continue;
+            ret = av_buffersink_get_frame(sinks[i], frame);
+            if (ret == AVERROR_EOF) {
+                eof |= 1 << i;
+            } else if (ret < 0) {
+                fprintf(stderr, "Error while filtering: %s\n", av_err2str(ret));
+                goto end;
+            }
+            av_frame_unref(frame);
+        }
+    }
+
+    for (i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        const AVFilterStats *st = avfilter_get_stats(f);
+
+        if (!st) {
+            fprintf(stderr, "No statistics for %s\n", f->name);
+            ret = AVERROR_BUG;
+            goto end;
+        }
+        printf("%-16s in %2"PRId64" out %2"PRId64" queued %"PRId64" max %"PRId64
+               " alloc %d activated %d timed %d\n",
+               f->filter->name, st->nb_frames_in, st->nb_frames_out,
+               st->nb_queued_frames, st->max_queued_frames, st->bytes_allocated > 0,
+               st->nb_activations > 0, st->real_time >= 0 && st->cpu_time >= -1);
+    }
+    ret = 0;
+
+end:
+    av_frame_free(&frame);
+    avfilter_graph_free(&graph);
+    return !!ret;
+}
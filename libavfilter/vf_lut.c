@@ -600,7 +600,8 @@ static const AVFilterPad outputs[] = {
         FILTER_OUTPUTS(outputs),                                        \
         FILTER_QUERY_FUNC(query_formats),                               \
         .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |       \
-                         AVFILTER_FLAG_SLICE_THREADS,                   \
+                         AVFILTER_FLAG_SLICE_THREADS |                  \
+                         AVFILTER_FLAG_FRAME_THREADS,                   \
         .process_command = process_command,                             \
     }
 
@@ -77,9 +77,9 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
         if (pool_width != w || pool_height != h ||
             pool_format != link->format || pool_align != align) {
 
-            ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
-                                                        link->format, align);
+            ff_frame_pool_replace((FFFramePool **)&link->frame_pool,
+                                  ff_frame_pool_video_init(av_buffer_allocz, w, h,
+                                                           link->format, align));
             if (!link->frame_pool)
                 return NULL;
         }
@@ -412,6 +412,15 @@ int ffurl_read_complete(URLContext *h, unsigned char *buf, int size)
     return retry_transfer_wrapper(h, buf, size, size, h->prot->url_read);
 }
 
+int ffurl_read_indirect(URLContext *h, const uint8_t **data, int size)
+{
+    if (!(h->flags & AVIO_FLAG_READ))
+        return AVERROR(EIO);
+    if (!h->prot->url_read_indirect)
+        return AVERROR(ENOSYS);
+    return h->prot->url_read_indirect(h, data, size);
+}
+
 int ffurl_write(URLContext *h, const unsigned char *buf, int size)
 {
     if (!(h->flags & AVIO_FLAG_WRITE))
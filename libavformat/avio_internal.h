@@ -105,8 +105,9 @@ void ffio_init_context(FFIOContext *s,
  * @param size number of bytes requested
  * @param data address at which to store pointer: this will be a
  *    a direct pointer into the underlying buffer if the requested
- *    number of bytes are available at contiguous addresses, otherwise
- *    will be a copy of buf
+ *    number of bytes are available at contiguous addresses, or into
+ *    the memory of the protocol if the buffer is empty and the protocol
+ *    supports it, otherwise will be a copy of buf
  * @return number of bytes read or AVERROR
  */
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data);
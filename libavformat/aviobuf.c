@@ -700,14 +700,41 @@ int ffio_read_size(AVIOContext *s, unsigned char *buf, int size)
 
 int ffio_read_indirect(AVIOContext *s, unsigned char *buf, int size, const unsigned char **data)
 {
+    URLContext *h;
+
     if (s->buf_end - s->buf_ptr >= size && !s->write_flag) {
         *data = s->buf_ptr;
         s->buf_ptr += size;
         return size;
-    } else {
-        *data = buf;
-        return avio_read(s, buf, size);
     }
+
+    /* Only for seekable inputs, seeking back must not rely on the buffer. */
+    if (s->buf_ptr == s->buf_end && !s->write_flag && !s->update_checksum &&
+        !s->eof_reached && (s->seekable & AVIO_SEEKABLE_NORMAL) &&
+        (h = ffio_geturlcontext(s))) {
+        // bypass the buffer and point into the memory of the protocol
+        int len = ffurl_read_indirect(h, data, size);
+        if (len != AVERROR(ENOSYS)) {
+            if (len == AVERROR_EOF || !len) {
+                s->eof_reached = 1;
+                return AVERROR_EOF;
+            } else if (len < 0) {
+                s->eof_reached = 1;
+                s->error = len;
+                return len;
+            }
+            s->pos += len;
+            ffiocontext(s)->bytes_read += len;
+            s->bytes_read = ffiocontext(s)->bytes_read;
+            // reset the buffer
+            s->buf_ptr = s->buffer;
+            s->buf_end = s->buffer;
+            return len;
+        }
+    }
+
+    *data = buf;
+    return avio_read(s, buf, size);
 }
 
 int avio_read_partial(AVIOContext *s, unsigned char *buf, int size)
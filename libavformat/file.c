@@ -19,6 +19,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#define _DEFAULT_SOURCE
+
 #include "config_components.h"
 
 #include "libavutil/avstring.h"
@@ -37,6 +39,21 @@
 #endif
 #include <sys/stat.h>
 #include <stdlib.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#if HAVE_LINUX_IO_URING_H && HAVE_MMAP
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define USE_IO_URING 1
+#endif
+#endif
+#ifndef USE_IO_URING
+#define USE_IO_URING 0
+#endif
 #include "os_support.h"
 #include "url.h"
 
@@ -69,6 +86,43 @@
 
 /* standard file protocol */
 
+/* Amount of data ahead of the read position the kernel is asked to
+ * prefetch when reading through a memory mapping. */
+#define MMAP_READAHEAD (4 << 20)
+
+#if USE_IO_URING
+enum FileURingSlotState {
+    SLOT_IDLE,
+    SLOT_INFLIGHT,
+    SLOT_DONE,
+};
+
+typedef struct FileURingSlot {
+    int64_t offset;      ///< file offset the slot buffer was read from
+    int res;             ///< completion result, bytes read or -errno
+    enum FileURingSlotState state;
+} FileURingSlot;
+
+typedef struct FileURing {
+    int fd;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_size, cq_ring_size, sqes_size;
+    unsigned to_submit;
+    int registered;      ///< buffers are registered, use fixed reads
+
+    uint8_t *buf;        ///< depth blocks of block_size bytes
+    struct iovec *iov;
+    FileURingSlot *slots;
+    int head;            ///< slot holding the current read position
+    int count;           ///< number of slots queued ahead of the reader
+    int64_t next_offset; ///< file offset of the next block to queue
+} FileURing;
+#endif
+
 typedef struct FileContext {
     const AVClass *class;
     int fd;
@@ -76,8 +130,26 @@ typedef struct FileContext {
     int blocksize;
     int follow;
     int seekable;
+    int use_mmap;
+    int64_t mmap_window;
+    int use_io_uring;
+    int io_uring_depth;
+    int io_uring_block_size;
 #if HAVE_DIRENT_H
     DIR *dir;
+#endif
+    int64_t pos;         ///< logical read position in mmap and io_uring modes
+    int64_t file_size;   ///< file size at open time in mmap and io_uring modes
+#if HAVE_MMAP
+    int mapped;          ///< reads are served from the mapping
+    uint8_t *map;        ///< currently mapped window, NULL if none
+    size_t map_size;     ///< size of the mapped window
+    int64_t map_offset;  ///< file offset of the mapped window
+    int64_t hint_end;    ///< end of the region last passed to madvise
+    long page_size;
+#endif
+#if USE_IO_URING
+    FileURing *ring;     ///< reads are served by io_uring if non-NULL
 #endif
 } FileContext;
 
@@ -86,6 +158,11 @@ static const AVOption file_options[] = {
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "mmap", "read regular files through a memory mapping", offsetof(FileContext, use_mmap), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "mmap_window", "set the size of the file region mapped at once", offsetof(FileContext, mmap_window), AV_OPT_TYPE_INT64, { .i64 = 64 << 20 }, 1 << 20, INT64_MAX, AV_OPT_FLAG_DECODING_PARAM },
+    { "io_uring", "read regular files asynchronously through io_uring", offsetof(FileContext, use_io_uring), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
+    { "io_uring_depth", "set the number of reads kept in flight", offsetof(FileContext, io_uring_depth), AV_OPT_TYPE_INT, { .i64 = 8 }, 1, 256, AV_OPT_FLAG_DECODING_PARAM },
+    { "io_uring_block_size", "set the size of each read", offsetof(FileContext, io_uring_block_size), AV_OPT_TYPE_INT, { .i64 = 1 << 20 }, 4096, 1 << 28, AV_OPT_FLAG_DECODING_PARAM },
     { NULL }
 };
 
@@ -108,11 +185,404 @@ static const AVClass pipe_class = {
     .version    = LIBAVUTIL_VERSION_INT,
 };
 
+#if HAVE_MMAP
+static void file_mmap_unmap(FileContext *c)
+{
+    if (c->map)
+        munmap(c->map, c->map_size);
+    c->map      = NULL;
+    c->map_size = 0;
+}
+
+/* Map the window of the file containing c->pos. */
+static int file_mmap_window(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    int64_t offset = c->pos - c->pos % c->page_size;
+    int64_t size   = FFMIN(c->mmap_window, c->file_size - offset);
+    void *map;
+
+    file_mmap_unmap(c);
+
+    if (size > SIZE_MAX)
+        size = SIZE_MAX - SIZE_MAX % c->page_size;
+    map = mmap(NULL, size, PROT_READ, MAP_SHARED, c->fd, offset);
+    if (map == MAP_FAILED) {
+        int err = AVERROR(errno);
+        av_log(h, AV_LOG_ERROR, "Cannot map %"PRId64" bytes at offset %"PRId64"\n",
+               size, offset);
+        return err;
+    }
+    c->map        = map;
+    c->map_size   = size;
+    c->map_offset = offset;
+    c->hint_end   = offset;
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise(c->map, c->map_size, POSIX_MADV_SEQUENTIAL);
+#endif
+    return 0;
+}
+
+/* Make the mapping cover size bytes at c->pos, if possible, and return the
+ * number of bytes available from c->pos in the mapped window. */
+static int64_t file_mmap_prepare(URLContext *h, int size)
+{
+    FileContext *c = h->priv_data;
+    int64_t map_end;
+    int ret;
+
+    if (!c->map || c->pos < c->map_offset ||
+        c->pos + FFMIN(size, c->file_size - c->pos) > c->map_offset + (int64_t)c->map_size) {
+        ret = file_mmap_window(h);
+        if (ret < 0)
+            return ret;
+    }
+    map_end = c->map_offset + c->map_size;
+
+#ifdef POSIX_MADV_WILLNEED
+    /* Keep the kernel prefetching ahead of the reader; re-issue the hint
+     * once half of the previously hinted region has been consumed. */
+    if (c->pos + MMAP_READAHEAD / 2 >= c->hint_end && c->hint_end < map_end) {
+        int64_t start = FFMAX(c->hint_end, c->pos - c->pos % c->page_size);
+        int64_t end   = FFMIN(c->pos + MMAP_READAHEAD, map_end);
+        posix_madvise(c->map + (start - c->map_offset), end - start,
+                      POSIX_MADV_WILLNEED);
+        c->hint_end = end;
+    }
+#endif
+
+    return map_end - c->pos;
+}
+
+static int file_mmap_read(URLContext *h, unsigned char *buf, int size)
+{
+    FileContext *c = h->priv_data;
+    int64_t avail;
+
+    if (c->pos >= c->file_size)
+        return AVERROR_EOF;
+
+    avail = file_mmap_prepare(h, size);
+    if (avail < 0)
+        return avail;
+
+    size = FFMIN(size, avail);
+    memcpy(buf, c->map + (c->pos - c->map_offset), size);
+    c->pos += size;
+    return size;
+}
+#endif /* HAVE_MMAP */
+
+#if USE_IO_URING
+static int uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags)
+{
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                   NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void *arg,
+                          unsigned nr_args)
+{
+    return syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static unsigned uring_load(const unsigned *p)
+{
+    return atomic_load_explicit((const _Atomic unsigned *)p, memory_order_acquire);
+}
+
+static void uring_store(unsigned *p, unsigned v)
+{
+    atomic_store_explicit((_Atomic unsigned *)p, v, memory_order_release);
+}
+
+/* Collect completions, waiting for at least one if wait is set. */
+static int uring_reap(FileContext *c, int wait)
+{
+    FileURing *r = c->ring;
+    unsigned head = *r->cq_head;
+
+    if (wait && head == uring_load(r->cq_tail)) {
+        if (uring_enter(r->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+            return AVERROR(errno);
+    }
+    while (head != uring_load(r->cq_tail)) {
+        const struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+        FileURingSlot *slot = &r->slots[cqe->user_data];
+        slot->res   = cqe->res;
+        slot->state = SLOT_DONE;
+        head++;
+    }
+    uring_store(r->cq_head, head);
+    return 0;
+}
+
+static int uring_submit(FileContext *c)
+{
+    FileURing *r = c->ring;
+
+    while (r->to_submit) {
+        int ret = uring_enter(r->fd, r->to_submit, 0, 0);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return AVERROR(errno);
+        }
+        r->to_submit -= ret;
+    }
+    return 0;
+}
+
+/* Queue reads until depth blocks ahead of the reader are in flight. */
+static int uring_fill(FileContext *c)
+{
+    FileURing *r = c->ring;
+    int depth = c->io_uring_depth;
+    int ret;
+
+    while (r->count < depth && r->next_offset < c->file_size) {
+        int idx = (r->head + r->count) % depth;
+        FileURingSlot *slot = &r->slots[idx];
+        struct io_uring_sqe *sqe;
+        unsigned tail, index;
+
+        /* A slot dropped by a seek may still be in flight; its buffer
+         * cannot be reused before the kernel is done with it. */
+        while (slot->state == SLOT_INFLIGHT)
+            if ((ret = uring_reap(c, 1)) < 0)
+                return ret;
+
+        tail  = *r->sq_tail;
+        index = tail & *r->sq_mask;
+        sqe   = &r->sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->fd        = c->fd;
+        sqe->off       = r->next_offset;
+        sqe->user_data = idx;
+        if (r->registered) {
+            sqe->opcode    = IORING_OP_READ_FIXED;
+            sqe->addr      = (uintptr_t)r->iov[idx].iov_base;
+            sqe->len       = r->iov[idx].iov_len;
+            sqe->buf_index = idx;
+        } else {
+            sqe->opcode    = IORING_OP_READV;
+            sqe->addr      = (uintptr_t)&r->iov[idx];
+            sqe->len       = 1;
+        }
+        r->sq_array[index] = index;
+        uring_store(r->sq_tail, tail + 1);
+        r->to_submit++;
+
+        slot->offset = r->next_offset;
+        slot->state  = SLOT_INFLIGHT;
+        r->next_offset += c->io_uring_block_size;
+        r->count++;
+    }
+    return uring_submit(c);
+}
+
+/* Drop the queued blocks and restart reading ahead at c->pos. */
+static void uring_restart(FileContext *c)
+{
+    FileURing *r = c->ring;
+    r->count       = 0;
+    r->next_offset = c->pos;
+}
+
+static void uring_seek(FileContext *c)
+{
+    FileURing *r = c->ring;
+    int block = c->io_uring_block_size;
+
+    /* Keep the blocks at or after the new position if it lies within the
+     * queued range. */
+    if (r->count && c->pos >= r->slots[r->head].offset && c->pos < r->next_offset) {
+        while (c->pos >= r->slots[r->head].offset + block) {
+            r->head = (r->head + 1) % c->io_uring_depth;
+            r->count--;
+        }
+    } else {
+        uring_restart(c);
+    }
+}
+
+static int file_uring_read(URLContext *h, unsigned char *buf, int size)
+{
+    FileContext *c = h->priv_data;
+    FileURing *r = c->ring;
+    FileURingSlot *slot;
+    int64_t skip;
+    int ret;
+
+    if (c->pos >= c->file_size)
+        return AVERROR_EOF;
+
+    for (;;) {
+        if ((ret = uring_fill(c)) < 0)
+            return ret;
+
+        slot = &r->slots[r->head];
+        while (slot->state == SLOT_INFLIGHT)
+            if ((ret = uring_reap(c, 1)) < 0)
+                return ret;
+
+        if (slot->res < 0) {
+            ret = AVERROR(-slot->res);
+            uring_restart(c);
+            return ret;
+        }
+        skip = c->pos - slot->offset;
+        if (skip < slot->res)
+            break;
+        /* Short read: the file was truncated or the kernel returned less
+         * than requested, read again from the current position. */
+        if (!slot->res)
+            return AVERROR_EOF;
+        uring_restart(c);
+    }
+
+    size = FFMIN(size, slot->res - skip);
+    memcpy(buf, r->buf + (size_t)r->head * c->io_uring_block_size + skip, size);
+    c->pos += size;
+
+    if (c->pos - slot->offset == slot->res) {
+        if (slot->res < c->io_uring_block_size) {
+            uring_restart(c);
+        } else {
+            r->head = (r->head + 1) % c->io_uring_depth;
+            r->count--;
+        }
+    }
+    return size;
+}
+
+static void file_uring_close(FileContext *c)
+{
+    FileURing *r = c->ring;
+    int i;
+
+    if (!r)
+        return;
+
+    if (r->fd >= 0) {
+        /* The kernel may still write into the buffers. */
+        for (i = 0; i < c->io_uring_depth && r->slots; i++)
+            while (r->slots[i].state == SLOT_INFLIGHT)
+                if (uring_reap(c, 1) < 0)
+                    break;
+        if (r->registered)
+            uring_register(r->fd, IORING_UNREGISTER_BUFFERS, NULL, 0);
+        close(r->fd);
+    }
+    if (r->sqes)
+        munmap(r->sqes, r->sqes_size);
+    if (r->cq_ring)
+        munmap(r->cq_ring, r->cq_ring_size);
+    if (r->sq_ring)
+        munmap(r->sq_ring, r->sq_ring_size);
+    av_freep(&r->buf);
+    av_freep(&r->iov);
+    av_freep(&r->slots);
+    av_freep(&c->ring);
+}
+
+static int file_uring_open(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    struct io_uring_params p = { 0 };
+    FileURing *r;
+    int depth = c->io_uring_depth;
+    uint8_t *ptr;
+    int i, ret;
+
+    r = c->ring = av_mallocz(sizeof(*r));
+    if (!r)
+        return AVERROR(ENOMEM);
+    r->fd = -1;
+
+    r->buf   = av_malloc((size_t)depth * c->io_uring_block_size);
+    r->iov   = av_calloc(depth, sizeof(*r->iov));
+    r->slots = av_calloc(depth, sizeof(*r->slots));
+    if (!r->buf || !r->iov || !r->slots) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (i = 0; i < depth; i++) {
+        r->iov[i].iov_base = r->buf + (size_t)i * c->io_uring_block_size;
+        r->iov[i].iov_len  = c->io_uring_block_size;
+    }
+
+    r->fd = uring_setup(depth, &p);
+    if (r->fd < 0) {
+        ret = AVERROR(errno);
+        goto fail;
+    }
+
+    r->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_size = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    r->sqes_size    = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    ptr = mmap(NULL, r->sq_ring_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED, r->fd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED)
+        goto fail_errno;
+    r->sq_ring  = ptr;
+    r->sq_head  = (unsigned *)(ptr + p.sq_off.head);
+    r->sq_tail  = (unsigned *)(ptr + p.sq_off.tail);
+    r->sq_mask  = (unsigned *)(ptr + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(ptr + p.sq_off.array);
+
+    ptr = mmap(NULL, r->cq_ring_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED, r->fd, IORING_OFF_CQ_RING);
+    if (ptr == MAP_FAILED)
+        goto fail_errno;
+    r->cq_ring = ptr;
+    r->cq_head = (unsigned *)(ptr + p.cq_off.head);
+    r->cq_tail = (unsigned *)(ptr + p.cq_off.tail);
+    r->cq_mask = (unsigned *)(ptr + p.cq_off.ring_mask);
+    r->cqes    = (struct io_uring_cqe *)(ptr + p.cq_off.cqes);
+
+    ptr = mmap(NULL, r->sqes_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED, r->fd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED)
+        goto fail_errno;
+    r->sqes = (struct io_uring_sqe *)ptr;
+
+    /* Registered buffers save the per-read page pinning, but count against
+     * RLIMIT_MEMLOCK; plain vectored reads are used if that fails. */
+    r->registered = uring_register(r->fd, IORING_REGISTER_BUFFERS, r->iov, depth) >= 0;
+    if (!r->registered)
+        av_log(h, AV_LOG_VERBOSE, "Cannot register io_uring buffers: %s\n",
+               av_err2str(AVERROR(errno)));
+
+    return 0;
+fail_errno:
+    ret = AVERROR(errno);
+fail:
+    file_uring_close(c);
+    return ret;
+}
+#endif /* USE_IO_URING */
+
 static int file_read(URLContext *h, unsigned char *buf, int size)
 {
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
+#if USE_IO_URING
+    if (c->ring)
+        return file_uring_read(h, buf, size);
+#endif
+#if HAVE_MMAP
+    if (c->mapped)
+        return file_mmap_read(h, buf, size);
+#endif
     ret = read(c->fd, buf, size);
     if (ret == 0 && c->follow)
         return AVERROR(EAGAIN);
@@ -121,6 +591,32 @@ static int file_read(URLContext *h, unsigned char *buf, int size)
     return (ret == -1) ? AVERROR(errno) : ret;
 }
 
+static int file_read_indirect(URLContext *h, const uint8_t **data, int size)
+{
+#if HAVE_MMAP
+    FileContext *c = h->priv_data;
+    int64_t avail;
+
+    if (c->mapped) {
+        if (c->pos >= c->file_size)
+            return AVERROR_EOF;
+
+        avail = file_mmap_prepare(h, size);
+        if (avail < 0)
+            return avail;
+        /* a read larger than the window has to be copied */
+        if (avail < FFMIN(size, c->file_size - c->pos))
+            return AVERROR(ENOSYS);
+
+        size  = FFMIN(size, avail);
+        *data = c->map + (c->pos - c->map_offset);
+        c->pos += size;
+        return size;
+    }
+#endif
+    return AVERROR(ENOSYS);
+}
+
 static int file_write(URLContext *h, const unsigned char *buf, int size)
 {
     FileContext *c = h->priv_data;
@@ -245,9 +741,45 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (c->seekable >= 0)
         h->is_streamed = !c->seekable;
 
+    c->file_size = fstat(fd, &st) ? -1 : st.st_size;
+    c->pos       = 0;
+
+    if (c->use_io_uring && !(flags & AVIO_FLAG_WRITE)) {
+#if USE_IO_URING
+        int ret = AVERROR(ENOSYS);
+        if (!c->follow && c->file_size >= 0 && S_ISREG(st.st_mode))
+            ret = file_uring_open(h);
+        if (ret >= 0)
+            return 0;
+        av_log(h, AV_LOG_VERBOSE, "io_uring not available: %s\n", av_err2str(ret));
+#else
+        av_log(h, AV_LOG_VERBOSE, "io_uring not available\n");
+#endif
+    }
+
+    if (c->use_mmap && !(flags & AVIO_FLAG_WRITE)) {
+#if HAVE_MMAP
+        if (!c->follow && c->file_size >= 0 && S_ISREG(st.st_mode)) {
+            c->page_size = sysconf(_SC_PAGESIZE);
+            if (c->page_size <= 0)
+                c->page_size = 4096;
+            c->mmap_window = FFMAX(c->mmap_window / c->page_size, 1) * c->page_size;
+            c->mapped      = 1;
+        } else
+#endif
+            av_log(h, AV_LOG_VERBOSE, "Memory mapping not available, "
+                   "falling back to read()\n");
+    }
+
     return 0;
 }
 
+#if USE_IO_URING
+#define FILE_LOGICAL_POS(c) ((c)->mapped || (c)->ring)
+#elif HAVE_MMAP
+#define FILE_LOGICAL_POS(c) ((c)->mapped)
+#endif
+
 /* XXX: use llseek */
 static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 {
@@ -260,6 +792,25 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
         return ret < 0 ? AVERROR(errno) : (S_ISFIFO(st.st_mode) ? 0 : st.st_size);
     }
 
+#if HAVE_MMAP || USE_IO_URING
+    if (FILE_LOGICAL_POS(c)) {
+        switch (whence) {
+        case SEEK_SET:                        break;
+        case SEEK_CUR: pos += c->pos;         break;
+        case SEEK_END: pos += c->file_size;   break;
+        default: return AVERROR(EINVAL);
+        }
+        if (pos < 0)
+            return AVERROR(EINVAL);
+        c->pos = pos;
+#if USE_IO_URING
+        if (c->ring)
+            uring_seek(c);
+#endif
+        return pos;
+    }
+#endif
+
     ret = lseek(c->fd, pos, whence);
 
     return ret < 0 ? AVERROR(errno) : ret;
@@ -268,7 +819,14 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
-    int ret = close(c->fd);
+    int ret;
+#if HAVE_MMAP
+    file_mmap_unmap(c);
+#endif
+#if USE_IO_URING
+    file_uring_close(c);
+#endif
+    ret = close(c->fd);
     return (ret == -1) ? AVERROR(errno) : 0;
 }
 
@@ -360,6 +918,7 @@ const URLProtocol ff_file_protocol = {
     .name                = "file",
     .url_open            = file_open,
     .url_read            = file_read,
+    .url_read_indirect   = file_read_indirect,
     .url_write           = file_write,
     .url_seek            = file_seek,
     .url_close           = file_close,
@@ -99,20 +99,26 @@ typedef struct IMFVirtualTrackResourcePlaybackCtx {
     IMFAssetLocator *locator;          /**< Location of the resource */
     FFIMFTrackFileResource *resource;  /**< Underlying IMF CPL resource */
     AVFormatContext *ctx;              /**< Context associated with the resource */
-    AVRational start_time;             /**< inclusive start time of the resource on the CPL timeline (s) */
-    AVRational end_time;               /**< exclusive end time of the resource on the CPL timeline (s) */
-    AVRational ts_offset;              /**< start_time minus the entry point into the resource (s) */
+    int64_t start_time;                /**< inclusive start time of the resource on the CPL timeline (ticks) */
+    int64_t end_time;                  /**< exclusive end time of the resource on the CPL timeline (ticks) */
+    int64_t ts_offset;                 /**< start_time minus the entry point into the resource (ticks) */
+    int64_t tb_ticks;                  /**< time base of the resource stream (ticks), 0 until opened */
+    int64_t delta_ts;                  /**< ts_offset in the resource stream time base,
+                                            or AV_NOPTS_VALUE if it is not a whole number */
 } IMFVirtualTrackResourcePlaybackCtx;
 
 typedef struct IMFVirtualTrackPlaybackCtx {
     int32_t index;                                 /**< Track index in playlist */
-    AVRational current_timestamp;                  /**< Current temporal position */
-    AVRational duration;                           /**< Overall duration */
+    int64_t current_timestamp;                     /**< Current temporal position (ticks) */
+    int64_t duration;                              /**< Overall duration (ticks) */
     uint32_t resource_count;                       /**< Number of resources (<= INT32_MAX) */
     unsigned int resources_alloc_sz;               /**< Size of the buffer holding the resource */
     IMFVirtualTrackResourcePlaybackCtx *resources; /**< Buffer holding the resources */
     int32_t current_resource_index;                /**< Index of the current resource in resources,
                                                         or < 0 if a current resource has yet to be selected */
+    AVPacket *pcm_pkt;                             /**< PCM data read but not yet returned,
+                                                        or NULL if audio is not re-chunked */
+    int pcm_block_align;                           /**< Size of one PCM sample for all channels (bytes) */
 } IMFVirtualTrackPlaybackCtx;
 
 typedef struct IMFContext {
@@ -125,6 +131,9 @@ typedef struct IMFContext {
     IMFAssetLocatorMap asset_locator_map;
     uint32_t track_count;
     IMFVirtualTrackPlaybackCtx **tracks;
+    AVRational tick;               /**< Time base of the timestamps of the virtual tracks,
+                                        of which all edit rates and stream time bases are multiples */
+    int audio_frame_size;
 } IMFContext;
 
 static int imf_uri_is_url(const char *string)
@@ -154,21 +163,46 @@ static int imf_uri_is_dos_abs_path(const char *string)
     return 0;
 }
 
-static int imf_time_to_ts(int64_t *ts, AVRational t, AVRational time_base)
+/**
+ * Refine the tick of the virtual track timelines so that time_base is a
+ * multiple of it, and rescale the timestamps already computed accordingly.
+ */
+static int imf_update_tick(AVFormatContext *s, AVRational time_base)
 {
-    int dst_num;
-    int dst_den;
-    AVRational r;
-
-    r = av_div_q(t, time_base);
+    IMFContext *c = s->priv_data;
+    AVRational tick;
+    int64_t scale;
 
-    if ((av_reduce(&dst_num, &dst_den, r.num, r.den, INT64_MAX) != 1))
-        return 1;
+    if (time_base.num <= 0 || time_base.den <= 0) {
+        av_log(s, AV_LOG_ERROR, "Invalid time base " AVRATIONAL_FORMAT "\n",
+               AVRATIONAL_ARG(time_base));
+        return AVERROR_INVALIDDATA;
+    }
 
-    if (dst_den != 1)
-        return 1;
+    tick = av_gcd_q(c->tick, time_base, INT_MAX, av_make_q(0, 1));
+    if (!tick.num) {
+        av_log(s, AV_LOG_ERROR, "No common time base for " AVRATIONAL_FORMAT
+               " and " AVRATIONAL_FORMAT "\n",
+               AVRATIONAL_ARG(c->tick), AVRATIONAL_ARG(time_base));
+        return AVERROR_PATCHWELCOME;
+    }
+    if (!av_cmp_q(tick, c->tick))
+        return 0;
 
-    *ts = dst_num;
+    av_q2ticks(&scale, c->tick, tick);
+    for (uint32_t i = 0; i < c->track_count; i++) {
+        IMFVirtualTrackPlaybackCtx *track = c->tracks[i];
+
+        track->current_timestamp *= scale;
+        track->duration          *= scale;
+        for (uint32_t j = 0; j < track->resource_count; j++) {
+            track->resources[j].start_time *= scale;
+            track->resources[j].end_time   *= scale;
+            track->resources[j].ts_offset  *= scale;
+            track->resources[j].tb_ticks   *= scale;
+        }
+    }
+    c->tick = tick;
 
     return 0;
 }
@@ -407,16 +441,28 @@ static int open_track_resource_context(AVFormatContext *s,
 
     st = track_resource->ctx->streams[0];
 
+    if ((ret = imf_update_tick(s, st->time_base)) < 0) {
+        avformat_close_input(&track_resource->ctx);
+        return ret;
+    }
+    av_q2ticks(&track_resource->tb_ticks, st->time_base, c->tick);
+    if (track_resource->ts_offset % track_resource->tb_ticks)
+        track_resource->delta_ts = AV_NOPTS_VALUE;
+    else
+        track_resource->delta_ts = track_resource->ts_offset / track_resource->tb_ticks;
+
     /* Determine the seek offset into the Track File, taking into account:
      * - the current timestamp within the virtual track
      * - the entry point of the resource
      */
-    if (imf_time_to_ts(&seek_offset,
-                       av_sub_q(track->current_timestamp, track_resource->ts_offset),
-                       st->time_base))
+    if ((track->current_timestamp - track_resource->ts_offset) % track_resource->tb_ticks)
         av_log(s, AV_LOG_WARNING, "Incoherent stream timebase " AVRATIONAL_FORMAT
-               "and composition timeline position: " AVRATIONAL_FORMAT "\n",
-               AVRATIONAL_ARG(st->time_base), AVRATIONAL_ARG(track->current_timestamp));
+               "and composition timeline position: %" PRId64 " * " AVRATIONAL_FORMAT "\n",
+               AVRATIONAL_ARG(st->time_base), track->current_timestamp,
+               AVRATIONAL_ARG(c->tick));
+    else
+        seek_offset = (track->current_timestamp - track_resource->ts_offset) /
+                      track_resource->tb_ticks;
 
     if (seek_offset) {
         av_log(s, AV_LOG_DEBUG, "Seek at resource %s entry point: %" PRIi64 "\n",
@@ -449,6 +495,7 @@ static int open_track_file_resource(AVFormatContext *s,
 {
     IMFContext *c = s->priv_data;
     IMFAssetLocator *asset_locator;
+    int64_t edit_unit;
     void *tmp;
 
     asset_locator = find_asset_map_locator(&c->asset_locator_map, track_file_resource->track_file_uuid);
@@ -476,6 +523,9 @@ static int open_track_file_resource(AVFormatContext *s,
         return AVERROR(ENOMEM);
     track->resources = tmp;
 
+    /* the tick divides all the edit rates, see open_cpl_tracks() */
+    av_q2ticks(&edit_unit, av_inv_q(track_file_resource->base.edit_rate), c->tick);
+
     for (uint32_t i = 0; i < track_file_resource->base.repeat_count; i++) {
         IMFVirtualTrackResourcePlaybackCtx vt_ctx;
 
@@ -483,13 +533,10 @@ static int open_track_file_resource(AVFormatContext *s,
         vt_ctx.resource = track_file_resource;
         vt_ctx.ctx = NULL;
         vt_ctx.start_time = track->duration;
-        vt_ctx.ts_offset = av_sub_q(vt_ctx.start_time,
-                                    av_div_q(av_make_q((int)track_file_resource->base.entry_point, 1),
-                                             track_file_resource->base.edit_rate));
-        vt_ctx.end_time = av_add_q(track->duration,
-                                   av_make_q((int)track_file_resource->base.duration
-                                                 * track_file_resource->base.edit_rate.den,
-                                             track_file_resource->base.edit_rate.num));
+        vt_ctx.ts_offset = vt_ctx.start_time - track_file_resource->base.entry_point * edit_unit;
+        vt_ctx.end_time = vt_ctx.start_time + track_file_resource->base.duration * edit_unit;
+        vt_ctx.tb_ticks = 0;
+        vt_ctx.delta_ts = AV_NOPTS_VALUE;
         track->resources[track->resource_count++] = vt_ctx;
         track->duration = vt_ctx.end_time;
     }
@@ -503,6 +550,7 @@ static void imf_virtual_track_playback_context_deinit(IMFVirtualTrackPlaybackCtx
         avformat_close_input(&track->resources[i].ctx);
 
     av_freep(&track->resources);
+    av_packet_free(&track->pcm_pkt);
 }
 
 static int open_virtual_track(AVFormatContext *s,
@@ -518,7 +566,7 @@ static int open_virtual_track(AVFormatContext *s,
         return AVERROR(ENOMEM);
     track->current_resource_index = -1;
     track->index = track_index;
-    track->duration = av_make_q(0, 1);
+    track->duration = 0;
 
     for (uint32_t i = 0; i < virtual_track->resource_count; i++) {
         av_log(s,
@@ -535,7 +583,7 @@ static int open_virtual_track(AVFormatContext *s,
         }
     }
 
-    track->current_timestamp = av_make_q(0, track->duration.den);
+    track->current_timestamp = 0;
 
     if (c->track_count == UINT32_MAX) {
         ret = AVERROR(ENOMEM);
@@ -589,8 +637,21 @@ static int set_context_streams_from_tracks(AVFormatContext *s)
                             first_resource_stream->pts_wrap_bits,
                             first_resource_stream->time_base.num,
                             first_resource_stream->time_base.den);
-        asset_stream->duration = (int64_t)av_q2d(av_mul_q(c->tracks[i]->duration,
-                                                          av_inv_q(asset_stream->time_base)));
+        asset_stream->duration = c->tracks[i]->duration / c->tracks[i]->resources[0].tb_ticks;
+
+        /* AV_CODEC_ID_PCM_S24LE is the only PCM format supported in IMF */
+        if (c->audio_frame_size > 0 &&
+            asset_stream->codecpar->codec_id == AV_CODEC_ID_PCM_S24LE) {
+            c->tracks[i]->pcm_pkt = av_packet_alloc();
+            if (!c->tracks[i]->pcm_pkt)
+                return AVERROR(ENOMEM);
+            c->tracks[i]->pcm_block_align = asset_stream->codecpar->ch_layout.nb_channels *
+                (av_get_exact_bits_per_sample(asset_stream->codecpar->codec_id) >> 3);
+            if (c->tracks[i]->pcm_block_align <= 0 ||
+                asset_stream->codecpar->sample_rate <= 0 ||
+                c->audio_frame_size > INT_MAX / c->tracks[i]->pcm_block_align)
+                return AVERROR_INVALIDDATA;
+        }
     }
 
     return 0;
@@ -602,6 +663,25 @@ static int open_cpl_tracks(AVFormatContext *s)
     int32_t track_index = 0;
     int ret;
 
+    /* express the timelines in a tick dividing all the edit rates */
+    c->tick = av_make_q(0, 1);
+    if ((ret = imf_update_tick(s, av_inv_q(c->cpl->edit_rate))) < 0)
+        return ret;
+    if (c->cpl->main_image_2d_track) {
+        for (uint32_t i = 0; i < c->cpl->main_image_2d_track->resource_count; i++) {
+            ret = imf_update_tick(s, av_inv_q(c->cpl->main_image_2d_track->resources[i].base.edit_rate));
+            if (ret < 0)
+                return ret;
+        }
+    }
+    for (uint32_t i = 0; i < c->cpl->main_audio_track_count; i++) {
+        for (uint32_t j = 0; j < c->cpl->main_audio_tracks[i].resource_count; j++) {
+            ret = imf_update_tick(s, av_inv_q(c->cpl->main_audio_tracks[i].resources[j].base.edit_rate));
+            if (ret < 0)
+                return ret;
+        }
+    }
+
     if (c->cpl->main_image_2d_track) {
         if ((ret = open_virtual_track(s, c->cpl->main_image_2d_track, track_index++)) != 0) {
             av_log(s, AV_LOG_ERROR, "Could not open image track " FF_IMF_UUID_FORMAT "\n",
@@ -686,84 +766,106 @@ static IMFVirtualTrackPlaybackCtx *get_next_track_with_minimum_timestamp(AVForma
     IMFContext *c = s->priv_data;
     IMFVirtualTrackPlaybackCtx *track;
 
-    AVRational minimum_timestamp = av_make_q(INT32_MAX, 1);
+    int64_t minimum_timestamp = INT64_MAX;
     for (uint32_t i = c->track_count; i > 0; i--) {
-        av_log(s, AV_LOG_TRACE, "Compare track %d timestamp " AVRATIONAL_FORMAT
-               " to minimum " AVRATIONAL_FORMAT
-               " (over duration: " AVRATIONAL_FORMAT ")\n", i,
-               AVRATIONAL_ARG(c->tracks[i - 1]->current_timestamp),
-               AVRATIONAL_ARG(minimum_timestamp),
-               AVRATIONAL_ARG(c->tracks[i - 1]->duration));
-
-        if (av_cmp_q(c->tracks[i - 1]->current_timestamp, minimum_timestamp) <= 0) {
+        av_log(s, AV_LOG_TRACE, "Compare track %d timestamp %" PRId64
+               " to minimum %" PRId64 " (over duration: %" PRId64 ")\n", i,
+               c->tracks[i - 1]->current_timestamp,
+               minimum_timestamp,
+               c->tracks[i - 1]->duration);
+
+        if (c->tracks[i - 1]->current_timestamp <= minimum_timestamp) {
             track = c->tracks[i - 1];
             minimum_timestamp = track->current_timestamp;
         }
     }
 
-    av_log(s, AV_LOG_DEBUG, "Found next track to read: %d (timestamp: %lf / %lf)\n",
-           track->index, av_q2d(track->current_timestamp), av_q2d(minimum_timestamp));
+    av_log(s, AV_LOG_DEBUG, "Found next track to read: %d (timestamp: %lf)\n",
+           track->index, minimum_timestamp * av_q2d(c->tick));
     return track;
 }
 
 static int get_resource_context_for_timestamp(AVFormatContext *s, IMFVirtualTrackPlaybackCtx *track, IMFVirtualTrackResourcePlaybackCtx **resource)
 {
+    IMFContext *c = s->priv_data;
+    uint32_t lo = 0, hi = track->resource_count;
+    uint32_t i;
+
     *resource = NULL;
 
-    if (av_cmp_q(track->current_timestamp, track->duration) >= 0) {
+    if (track->current_timestamp >= track->duration) {
         av_log(s, AV_LOG_DEBUG, "Reached the end of the virtual track\n");
         return AVERROR_EOF;
     }
 
+    /* most packets are read from the resource already open */
+    if (track->current_resource_index >= 0) {
+        IMFVirtualTrackResourcePlaybackCtx *current = track->resources + track->current_resource_index;
+
+        if (current->start_time <= track->current_timestamp &&
+            current->end_time   >  track->current_timestamp) {
+            *resource = current;
+            return 0;
+        }
+    }
+
     av_log(s,
            AV_LOG_TRACE,
            "Looking for track %d resource for timestamp = %lf / %lf\n",
            track->index,
-           av_q2d(track->current_timestamp),
-           av_q2d(track->duration));
-    for (uint32_t i = 0; i < track->resource_count; i++) {
-
-        if (av_cmp_q(track->resources[i].end_time, track->current_timestamp) > 0) {
-            av_log(s, AV_LOG_DEBUG, "Found resource %d in track %d to read at timestamp %lf: "
-                   "entry=%" PRIu32 ", duration=%" PRIu32 ", editrate=" AVRATIONAL_FORMAT "\n",
-                   i, track->index, av_q2d(track->current_timestamp),
-                   track->resources[i].resource->base.entry_point,
-                   track->resources[i].resource->base.duration,
-                   AVRATIONAL_ARG(track->resources[i].resource->base.edit_rate));
-
-            if (track->current_resource_index != i) {
-                int ret;
-
-                av_log(s, AV_LOG_TRACE, "Switch resource on track %d: re-open context\n",
-                       track->index);
-
-                ret = open_track_resource_context(s, track, i);
-                if (ret != 0)
-                    return ret;
-                if (track->current_resource_index > 0)
-                    avformat_close_input(&track->resources[track->current_resource_index].ctx);
-                track->current_resource_index = i;
-            }
+           track->current_timestamp * av_q2d(c->tick),
+           track->duration * av_q2d(c->tick));
 
-            *resource = track->resources + track->current_resource_index;
-            return 0;
-        }
+    /* the end times are the prefix sums of the resource durations:
+     * find the first resource ending after the timestamp */
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+
+        if (track->resources[mid].end_time > track->current_timestamp)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    i = lo;
+
+    if (i == track->resource_count) {
+        av_log(s, AV_LOG_ERROR, "Could not find IMF track resource to read\n");
+        return AVERROR_STREAM_NOT_FOUND;
+    }
+
+    av_log(s, AV_LOG_DEBUG, "Found resource %d in track %d to read at timestamp %lf: "
+           "entry=%" PRIu32 ", duration=%" PRIu32 ", editrate=" AVRATIONAL_FORMAT "\n",
+           i, track->index, track->current_timestamp * av_q2d(c->tick),
+           track->resources[i].resource->base.entry_point,
+           track->resources[i].resource->base.duration,
+           AVRATIONAL_ARG(track->resources[i].resource->base.edit_rate));
+
+    if (track->current_resource_index != i) {
+        int ret;
+
+        av_log(s, AV_LOG_TRACE, "Switch resource on track %d: re-open context\n",
+               track->index);
+
+        ret = open_track_resource_context(s, track, i);
+        if (ret != 0)
+            return ret;
+        if (track->current_resource_index > 0)
+            avformat_close_input(&track->resources[track->current_resource_index].ctx);
+        track->current_resource_index = i;
     }
 
-    av_log(s, AV_LOG_ERROR, "Could not find IMF track resource to read\n");
-    return AVERROR_STREAM_NOT_FOUND;
+    *resource = track->resources + track->current_resource_index;
+    return 0;
 }
 
-static int imf_read_packet(AVFormatContext *s, AVPacket *pkt)
+static int imf_read_resource_packet(AVFormatContext *s, IMFVirtualTrackPlaybackCtx *track,
+                                    AVPacket *pkt)
 {
+    IMFContext *c = s->priv_data;
     IMFVirtualTrackResourcePlaybackCtx *resource = NULL;
     int ret = 0;
-    IMFVirtualTrackPlaybackCtx *track;
-    int64_t delta_ts;
     AVStream *st;
-    AVRational next_timestamp;
-
-    track = get_next_track_with_minimum_timestamp(s);
+    int64_t next_timestamp;
 
     ret = get_resource_context_for_timestamp(s, track, &resource);
     if (ret)
@@ -788,39 +890,32 @@ static int imf_read_packet(AVFormatContext *s, AVPacket *pkt)
 
     /* adjust the packet PTS and DTS based on the temporal position of the resource within the timeline */
 
-    ret = imf_time_to_ts(&delta_ts, resource->ts_offset, st->time_base);
-
-    if (!ret) {
+    if (resource->delta_ts != AV_NOPTS_VALUE) {
         if (pkt->pts != AV_NOPTS_VALUE)
-            pkt->pts += delta_ts;
+            pkt->pts += resource->delta_ts;
         if (pkt->dts != AV_NOPTS_VALUE)
-            pkt->dts += delta_ts;
+            pkt->dts += resource->delta_ts;
     } else {
-        av_log(s, AV_LOG_WARNING, "Incoherent time stamp " AVRATIONAL_FORMAT
+        av_log(s, AV_LOG_WARNING, "Incoherent time stamp %" PRId64 " * " AVRATIONAL_FORMAT
                " for time base " AVRATIONAL_FORMAT,
-               AVRATIONAL_ARG(resource->ts_offset),
+               resource->ts_offset, AVRATIONAL_ARG(c->tick),
                AVRATIONAL_ARG(pkt->time_base));
     }
 
     /* advance the track timestamp by the packet duration */
 
-    next_timestamp = av_add_q(track->current_timestamp,
-                              av_mul_q(av_make_q((int)pkt->duration, 1), st->time_base));
+    next_timestamp = track->current_timestamp + pkt->duration * resource->tb_ticks;
 
     /* if necessary, clamp the next timestamp to the end of the current resource */
 
-    if (av_cmp_q(next_timestamp, resource->end_time) > 0) {
+    if (next_timestamp > resource->end_time) {
 
-        int64_t new_pkt_dur;
+        int64_t new_pkt_dur = resource->end_time - track->current_timestamp;
 
         /* shrink the packet duration */
 
-        ret = imf_time_to_ts(&new_pkt_dur,
-                             av_sub_q(resource->end_time, track->current_timestamp),
-                             st->time_base);
-
-        if (!ret)
-            pkt->duration = new_pkt_dur;
+        if (!(new_pkt_dur % resource->tb_ticks))
+            pkt->duration = new_pkt_dur / resource->tb_ticks;
         else
             av_log(s, AV_LOG_WARNING, "Incoherent time base in packet duration calculation\n");
 
@@ -840,11 +935,13 @@ static int imf_read_packet(AVFormatContext *s, AVPacket *pkt)
 
             } else {
                 /* in all other cases, use side data to skip samples */
-                int64_t skip_samples;
+                int64_t skip_samples = next_timestamp - resource->end_time;
+                int64_t sample_ticks;
 
-                ret = imf_time_to_ts(&skip_samples,
-                                     av_sub_q(next_timestamp, resource->end_time),
-                                     av_make_q(1, st->codecpar->sample_rate));
+                ret = !av_q2ticks(&sample_ticks, av_make_q(1, st->codecpar->sample_rate), c->tick) ||
+                      !sample_ticks || skip_samples % sample_ticks;
+                if (!ret)
+                    skip_samples /= sample_ticks;
 
                 if (ret || skip_samples < 0 || skip_samples > UINT32_MAX) {
                     av_log(s, AV_LOG_WARNING, "Cannot skip audio samples\n");
@@ -870,6 +967,106 @@ static int imf_read_packet(AVFormatContext *s, AVPacket *pkt)
     return 0;
 }
 
+static void pcm_packet_consume(AVPacket *pkt, int64_t duration, int size)
+{
+    pkt->data += size;
+    pkt->size -= size;
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts += duration;
+    if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts += duration;
+    if (!pkt->size)
+        av_packet_unref(pkt);
+}
+
+/**
+ * Return PCM audio of a track in packets of audio_frame_size samples,
+ * regardless of the size of the essence packets and resource boundaries.
+ * Packets are references into the essence packets whenever they do not
+ * straddle two of them, and copied otherwise.
+ *
+ * @param flush only return the data already read from the track
+ */
+static int imf_read_pcm_packet(AVFormatContext *s, IMFVirtualTrackPlaybackCtx *track,
+                               AVPacket *pkt, int flush)
+{
+    IMFContext *c = s->priv_data;
+    AVStream *st = s->streams[track->index];
+    AVPacket *pending = track->pcm_pkt;
+    AVRational sample_tb = av_make_q(1, st->codecpar->sample_rate);
+    int block_align = track->pcm_block_align;
+    int frame_bytes = c->audio_frame_size * block_align;
+    int filled = 0, ret, size;
+
+    while (filled < frame_bytes) {
+        if (!pending->size) {
+            ret = flush ? AVERROR_EOF : imf_read_resource_packet(s, track, pending);
+            if (ret == AVERROR_EOF && filled)
+                break;
+            if (ret < 0)
+                goto fail;
+            pending->size -= pending->size % block_align;
+            if (!pending->size)
+                av_packet_unref(pending);
+            continue;
+        }
+
+        if (!filled && pending->size >= frame_bytes) {
+            /* the whole packet lies within one essence packet */
+            if ((ret = av_packet_ref(pkt, pending)) < 0)
+                goto fail;
+            pkt->size = size = frame_bytes;
+        } else {
+            if (!filled) {
+                if ((ret = av_new_packet(pkt, frame_bytes)) < 0)
+                    goto fail;
+                if ((ret = av_packet_copy_props(pkt, pending)) < 0)
+                    goto fail;
+            }
+            size = FFMIN(pending->size, frame_bytes - filled);
+            memcpy(pkt->data + filled, pending->data, size);
+        }
+        filled += size;
+        pcm_packet_consume(pending, av_rescale_q(size / block_align, sample_tb, st->time_base), size);
+    }
+
+    if (filled < frame_bytes)
+        av_shrink_packet(pkt, filled);
+    pkt->stream_index = track->index;
+    pkt->time_base    = st->time_base;
+    pkt->duration     = av_rescale_q(filled / block_align, sample_tb, st->time_base);
+
+    return 0;
+
+fail:
+    av_packet_unref(pkt);
+    return ret;
+}
+
+static int imf_read_packet(AVFormatContext *s, AVPacket *pkt)
+{
+    IMFContext *c = s->priv_data;
+    IMFVirtualTrackPlaybackCtx *track;
+    int ret;
+
+    track = get_next_track_with_minimum_timestamp(s);
+
+    if (track->pcm_pkt)
+        ret = imf_read_pcm_packet(s, track, pkt, 0);
+    else
+        ret = imf_read_resource_packet(s, track, pkt);
+
+    if (ret == AVERROR_EOF) {
+        /* return the audio remaining in the other tracks before signalling EOF */
+        for (uint32_t i = 0; i < c->track_count; i++) {
+            if (c->tracks[i]->pcm_pkt && c->tracks[i]->pcm_pkt->size)
+                return imf_read_pcm_packet(s, c->tracks[i], pkt, 1);
+        }
+    }
+
+    return ret;
+}
+
 static int imf_close(AVFormatContext *s)
 {
     IMFContext *c = s->priv_data;
@@ -950,7 +1147,7 @@ static int imf_seek(AVFormatContext *s, int stream_index, int64_t min_ts,
     for (i = 0; i < c->track_count; i++) {
         AVStream *st = s->streams[i];
         IMFVirtualTrackPlaybackCtx *t = c->tracks[i];
-        int64_t dts;
+        int64_t dts, tb_ticks;
 
         if (!coherent_ts(ts, av_make_q(c->cpl->edit_rate.den, c->cpl->edit_rate.num),
                          st->time_base))
@@ -963,7 +1160,10 @@ static int imf_seek(AVFormatContext *s, int stream_index, int64_t min_ts,
         av_log(s, AV_LOG_DEBUG, "Seeking to dts=%" PRId64 " on stream_index=%d\n",
                dts, i);
 
-        t->current_timestamp = av_mul_q(av_make_q(dts, 1), st->time_base);
+        av_q2ticks(&tb_ticks, st->time_base, c->tick);
+        t->current_timestamp = dts * tb_ticks;
+        if (t->pcm_pkt)
+            av_packet_unref(t->pcm_pkt);
         if (t->current_resource_index >= 0) {
             avformat_close_input(&t->resources[t->current_resource_index].ctx);
             t->current_resource_index = -1;
@@ -984,6 +1184,18 @@ static const AVOption imf_options[] = {
         .default_val = {.str = NULL},
         .flags       = AV_OPT_FLAG_DECODING_PARAM,
     },
+    {
+        .name        = "audio_frame_size",
+        .help        = "Number of samples per packet for PCM audio tracks, "
+                       "regardless of resource boundaries. "
+                       "0 returns the packets as stored in the track files.",
+        .offset      = offsetof(IMFContext, audio_frame_size),
+        .type        = AV_OPT_TYPE_INT,
+        .default_val = {.i64 = 0},
+        .min         = 0,
+        .max         = INT_MAX,
+        .flags       = AV_OPT_FLAG_DECODING_PARAM,
+    },
     {NULL},
 };
 
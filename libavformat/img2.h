@@ -62,6 +62,9 @@ typedef struct VideoDemuxData {
     int frame_size;
     int ts_from_file;
     int export_path_metadata; /**< enabled when set to 1. */
+    int prefetch;           /**< number of files read ahead, 0 to disable */
+    int prefetch_threads;   /**< number of threads reading ahead */
+    struct ImagePrefetch *prefetch_ctx;
 } VideoDemuxData;
 
 typedef struct IdStrMap {
@@ -31,6 +31,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/parseutils.h"
 #include "libavutil/intreadwrite.h"
+#include "libavutil/thread.h"
 #include "libavcodec/gif.h"
 #include "avformat.h"
 #include "avio_internal.h"
@@ -404,6 +405,370 @@ static int add_filename_as_pkt_side_data(char *filename, AVPacket *pkt) {
     return 0;
 }
 
+static int set_packet_info(AVFormatContext *s1, AVPacket *pkt,
+                           const char *filename)
+{
+    VideoDemuxData *s = s1->priv_data;
+    int res;
+
+    pkt->stream_index = 0;
+    pkt->flags       |= AV_PKT_FLAG_KEY;
+    if (s->ts_from_file) {
+        struct stat img_stat;
+        if (stat(filename, &img_stat))
+            return AVERROR(EIO);
+        pkt->pts = (int64_t)img_stat.st_mtime;
+#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
+        if (s->ts_from_file == 2)
+            pkt->pts = 1000000000*pkt->pts + img_stat.st_mtim.tv_nsec;
+#endif
+        av_add_index_entry(s1->streams[0], s->img_number, pkt->pts, 0, 0, AVINDEX_KEYFRAME);
+    } else if (!s->is_pipe) {
+        pkt->pts      = s->pts;
+    }
+
+    /*
+     * export_path_metadata must be explicitly enabled via
+     * command line options for path metadata to be exported
+     * as packet side_data.
+     */
+    if (!s->is_pipe && s->export_path_metadata == 1) {
+        res = add_filename_as_pkt_side_data((char *)filename, pkt);
+        if (res < 0)
+            return res;
+    }
+    return 0;
+}
+
+static void probe_codec(AVFormatContext *s1, const uint8_t *header, int size,
+                        const char *filename)
+{
+    AVCodecParameters *par = s1->streams[0]->codecpar;
+    AVProbeData pd = { 0 };
+    const AVInputFormat *ifmt;
+    int score = 0;
+
+    pd.buf = (uint8_t *)header;
+    pd.buf_size = size;
+    pd.filename = filename;
+
+    ifmt = av_probe_input_format3(&pd, 1, &score);
+    if (ifmt && ifmt->read_packet == ff_img_read_packet && ifmt->raw_codec_id)
+        par->codec_id = ifmt->raw_codec_id;
+}
+
+#if HAVE_THREADS
+enum PrefetchState {
+    PREFETCH_FREE,
+    PREFETCH_QUEUED,
+    PREFETCH_LOADING,
+    PREFETCH_DONE,
+};
+
+typedef struct PrefetchEntry {
+    enum PrefetchState state;
+    int number;
+    int discard;            ///< the queue was flushed while loading
+    int ret;
+    AVIOContext *pb;        ///< opened and closed by the demuxer thread
+    AVBufferRef *buf;
+    int size;
+    char filename[1024];
+} PrefetchEntry;
+
+/* Files are read ahead into a ring of entries holding consecutive image
+ * numbers, starting with the one read_packet returns next. The io_open and
+ * io_close callbacks need not be thread-safe, so the files are opened and
+ * closed by the demuxer thread and the workers only read them. */
+typedef struct ImagePrefetch {
+    pthread_t *threads;
+    int nb_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    PrefetchEntry *entries;
+    int nb_entries;
+    int head;
+    int count;
+    int next_number;        ///< image number of the next entry to queue
+    int exit;
+} ImagePrefetch;
+
+static int get_filename(VideoDemuxData *s, int number, char *buf, int size)
+{
+    if (s->pattern_type == PT_NONE) {
+        av_strlcpy(buf, s->path, size);
+    } else if (s->use_glob) {
+#if HAVE_GLOB
+        av_strlcpy(buf, s->globstate.gl_pathv[number], size);
+#endif
+    } else {
+        if (av_get_frame_filename(buf, size, s->path, number) < 0 && number > 1)
+            return AVERROR(EIO);
+    }
+    return 0;
+}
+
+static int prefetch_load(AVIOContext *pb, AVBufferRef **pbuf, int *psize)
+{
+    int64_t size = avio_size(pb);
+    int ret;
+
+    if (size < 0 || size > INT_MAX - AV_INPUT_BUFFER_PADDING_SIZE)
+        return size < 0 ? size : AVERROR(ERANGE);
+    *pbuf = av_buffer_alloc(size + AV_INPUT_BUFFER_PADDING_SIZE);
+    if (!*pbuf)
+        return AVERROR(ENOMEM);
+    ret = avio_read(pb, (*pbuf)->data, size);
+    if (ret == 0)
+        ret = AVERROR_EOF;
+    if (ret < 0) {
+        av_buffer_unref(pbuf);
+        return ret;
+    }
+    memset((*pbuf)->data + ret, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    *psize = ret;
+    return ret;
+}
+
+static void *prefetch_worker(void *arg)
+{
+    ImagePrefetch *p = arg;
+
+    pthread_mutex_lock(&p->lock);
+    while (!p->exit) {
+        PrefetchEntry *e = NULL;
+        AVBufferRef *buf = NULL;
+        int size = 0, ret;
+
+        for (int i = 0; i < p->count; i++) {
+            PrefetchEntry *c = &p->entries[(p->head + i) % p->nb_entries];
+            if (c->state == PREFETCH_QUEUED) {
+                e = c;
+                break;
+            }
+        }
+        if (!e) {
+            pthread_cond_wait(&p->cond, &p->lock);
+            continue;
+        }
+
+        e->state = PREFETCH_LOADING;
+        pthread_mutex_unlock(&p->lock);
+        ret = prefetch_load(e->pb, &buf, &size);
+        pthread_mutex_lock(&p->lock);
+
+        if (e->discard) {
+            av_buffer_unref(&buf);
+            e->discard = 0;
+            e->state   = PREFETCH_FREE;
+        } else {
+            e->buf   = buf;
+            e->size  = size;
+            e->ret   = ret;
+            e->state = PREFETCH_DONE;
+        }
+        pthread_cond_broadcast(&p->cond);
+    }
+    pthread_mutex_unlock(&p->lock);
+
+    return NULL;
+}
+
+static void prefetch_free(AVFormatContext *s1)
+{
+    VideoDemuxData *s = s1->priv_data;
+    ImagePrefetch *p = s->prefetch_ctx;
+
+    if (!p)
+        return;
+
+    pthread_mutex_lock(&p->lock);
+    p->exit = 1;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->lock);
+    for (int i = 0; i < p->nb_threads; i++)
+        pthread_join(p->threads[i], NULL);
+
+    for (int i = 0; i < p->nb_entries; i++) {
+        av_buffer_unref(&p->entries[i].buf);
+        ff_format_io_close(s1, &p->entries[i].pb);
+    }
+    pthread_cond_destroy(&p->cond);
+    pthread_mutex_destroy(&p->lock);
+    av_freep(&p->entries);
+    av_freep(&p->threads);
+    av_freep(&s->prefetch_ctx);
+}
+
+static av_cold int prefetch_init(AVFormatContext *s1)
+{
+    VideoDemuxData *s = s1->priv_data;
+    ImagePrefetch *p;
+    int ret;
+
+    p = s->prefetch_ctx = av_mallocz(sizeof(*p));
+    if (!p)
+        return AVERROR(ENOMEM);
+    p->nb_entries = s->prefetch;
+    p->entries    = av_calloc(p->nb_entries, sizeof(*p->entries));
+    p->threads    = av_calloc(FFMIN(s->prefetch_threads, s->prefetch), sizeof(*p->threads));
+    if (!p->entries || !p->threads) {
+        av_freep(&p->entries);
+        av_freep(&p->threads);
+        av_freep(&s->prefetch_ctx);
+        return AVERROR(ENOMEM);
+    }
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->cond, NULL);
+
+    for (int i = 0; i < FFMIN(s->prefetch_threads, s->prefetch); i++) {
+        ret = pthread_create(&p->threads[i], NULL, prefetch_worker, p);
+        if (ret) {
+            prefetch_free(s1);
+            return AVERROR(ret);
+        }
+        p->nb_threads++;
+    }
+    return 0;
+}
+
+/* Open and queue the files following the current one; called with the lock
+ * held, which is released while opening. */
+static void prefetch_fill(AVFormatContext *s1)
+{
+    VideoDemuxData *s = s1->priv_data;
+    ImagePrefetch *p = s->prefetch_ctx;
+
+    while (p->count < p->nb_entries) {
+        PrefetchEntry *e = &p->entries[(p->head + p->count) % p->nb_entries];
+        int ret;
+
+        if (p->next_number > s->img_last) {
+            if (!s->loop)
+                break;
+            p->next_number = s->img_first;
+        }
+        /* an entry dropped by a flush is reused once its read is done */
+        if (e->state != PREFETCH_FREE)
+            break;
+        if (get_filename(s, p->next_number, e->filename, sizeof(e->filename)) < 0)
+            break;
+        e->number = p->next_number++;
+
+        /* the workers do not access free entries */
+        pthread_mutex_unlock(&p->lock);
+        ff_format_io_close(s1, &e->pb);
+        ret = s1->io_open(s1, &e->pb, e->filename, AVIO_FLAG_READ, NULL);
+        if (ret < 0)
+            av_log(s1, AV_LOG_ERROR, "Could not open file : %s\n", e->filename);
+        pthread_mutex_lock(&p->lock);
+
+        if (ret < 0) {
+            e->ret   = AVERROR(EIO);
+            e->state = PREFETCH_DONE;
+        } else {
+            e->state = PREFETCH_QUEUED;
+            pthread_cond_broadcast(&p->cond);
+        }
+        p->count++;
+    }
+}
+
+/* Drop the queued files, e.g. after a seek; called with the lock held. The
+ * files of entries still being read are closed when the entries are
+ * reused. */
+static void prefetch_flush(AVFormatContext *s1)
+{
+    VideoDemuxData *s = s1->priv_data;
+    ImagePrefetch *p = s->prefetch_ctx;
+
+    for (int i = 0; i < p->count; i++) {
+        PrefetchEntry *e = &p->entries[(p->head + i) % p->nb_entries];
+        if (e->state == PREFETCH_LOADING) {
+            e->discard = 1;
+        } else {
+            av_buffer_unref(&e->buf);
+            ff_format_io_close(s1, &e->pb);
+            e->state = PREFETCH_FREE;
+        }
+    }
+    p->count       = 0;
+    p->next_number = s->img_number;
+}
+
+static int read_prefetched_packet(AVFormatContext *s1, AVPacket *pkt)
+{
+    VideoDemuxData *s = s1->priv_data;
+    AVCodecParameters *par = s1->streams[0]->codecpar;
+    ImagePrefetch *p;
+    PrefetchEntry *e;
+    char filename[1024];
+    int ret, size;
+
+    if (!s->prefetch_ctx && (ret = prefetch_init(s1)) < 0)
+        return ret;
+    p = s->prefetch_ctx;
+
+    pthread_mutex_lock(&p->lock);
+    if (!p->count || p->entries[p->head].number != s->img_number)
+        prefetch_flush(s1);
+    for (;;) {
+        prefetch_fill(s1);
+        e = &p->entries[p->head];
+        if (p->count && e->state == PREFETCH_DONE)
+            break;
+        if (!p->count && e->state == PREFETCH_FREE) {
+            /* nothing could be queued */
+            pthread_mutex_unlock(&p->lock);
+            return AVERROR(EIO);
+        }
+        pthread_cond_wait(&p->cond, &p->lock);
+    }
+
+    ret      = e->ret;
+    size     = e->size;
+    pkt->buf = e->buf;
+    e->buf   = NULL;
+    e->state = PREFETCH_FREE;
+    av_strlcpy(filename, e->filename, sizeof(filename));
+    p->head  = (p->head + 1) % p->nb_entries;
+    p->count--;
+    pthread_mutex_unlock(&p->lock);
+
+    /* the workers do not access free entries */
+    ff_format_io_close(s1, &e->pb);
+
+    pthread_mutex_lock(&p->lock);
+    prefetch_fill(s1);
+    pthread_mutex_unlock(&p->lock);
+
+    if (ret < 0)
+        return ret;
+
+    pkt->data = pkt->buf->data;
+    pkt->size = size;
+
+    if (par->codec_id == AV_CODEC_ID_NONE) {
+        uint8_t header[PROBE_BUF_MIN + AVPROBE_PADDING_SIZE] = { 0 };
+        int header_size = FFMIN(pkt->size, PROBE_BUF_MIN);
+
+        memcpy(header, pkt->data, header_size);
+        probe_codec(s1, header, header_size, filename);
+    }
+    if (par->codec_id == AV_CODEC_ID_RAWVIDEO && !par->width)
+        infer_size(&par->width, &par->height, pkt->size);
+
+    ret = set_packet_info(s1, pkt, filename);
+    if (ret < 0)
+        return ret;
+
+    s->img_count++;
+    s->img_number++;
+    s->pts++;
+    return 0;
+}
+#endif /* HAVE_THREADS */
+
 int ff_img_read_packet(AVFormatContext *s1, AVPacket *pkt)
 {
     VideoDemuxData *s = s1->priv_data;
@@ -421,6 +786,10 @@ int ff_img_read_packet(AVFormatContext *s1, AVPacket *pkt)
         }
         if (s->img_number > s->img_last)
             return AVERROR_EOF;
+#if HAVE_THREADS
+        if (s->prefetch && !s->split_planes && !s1->pb)
+            return read_prefetched_packet(s1, pkt);
+#endif
         if (s->pattern_type == PT_NONE) {
             av_strlcpy(filename_bytes, s->path, sizeof(filename_bytes));
         } else if (s->use_glob) {
@@ -454,24 +823,15 @@ int ff_img_read_packet(AVFormatContext *s1, AVPacket *pkt)
         }
 
         if (par->codec_id == AV_CODEC_ID_NONE) {
-            AVProbeData pd = { 0 };
-            const AVInputFormat *ifmt;
             uint8_t header[PROBE_BUF_MIN + AVPROBE_PADDING_SIZE];
             int ret;
-            int score = 0;
 
             ret = avio_read(f[0], header, PROBE_BUF_MIN);
             if (ret < 0)
                 return ret;
             memset(header + ret, 0, sizeof(header) - ret);
             avio_skip(f[0], -ret);
-            pd.buf = header;
-            pd.buf_size = ret;
-            pd.filename = filename;
-
-            ifmt = av_probe_input_format3(&pd, 1, &score);
-            if (ifmt && ifmt->read_packet == ff_img_read_packet && ifmt->raw_codec_id)
-                par->codec_id = ifmt->raw_codec_id;
+            probe_codec(s1, header, ret, filename);
         }
 
         if (par->codec_id == AV_CODEC_ID_RAWVIDEO && !par->width)
@@ -495,38 +855,13 @@ int ff_img_read_packet(AVFormatContext *s1, AVPacket *pkt)
     if (res < 0) {
         goto fail;
     }
-    pkt->stream_index = 0;
-    pkt->flags       |= AV_PKT_FLAG_KEY;
-    if (s->ts_from_file) {
-        struct stat img_stat;
-        if (stat(filename, &img_stat)) {
-            res = AVERROR(EIO);
-            goto fail;
-        }
-        pkt->pts = (int64_t)img_stat.st_mtime;
-#if HAVE_STRUCT_STAT_ST_MTIM_TV_NSEC
-        if (s->ts_from_file == 2)
-            pkt->pts = 1000000000*pkt->pts + img_stat.st_mtim.tv_nsec;
-#endif
-        av_add_index_entry(s1->streams[0], s->img_number, pkt->pts, 0, 0, AVINDEX_KEYFRAME);
-    } else if (!s->is_pipe) {
-        pkt->pts      = s->pts;
-    }
+    res = set_packet_info(s1, pkt, filename);
+    if (res < 0)
+        goto fail;
 
     if (s->is_pipe)
         pkt->pos = avio_tell(f[0]);
 
-    /*
-     * export_path_metadata must be explicitly enabled via
-     * command line options for path metadata to be exported
-     * as packet side_data.
-     */
-    if (!s->is_pipe && s->export_path_metadata == 1) {
-        res = add_filename_as_pkt_side_data(filename, pkt);
-        if (res < 0)
-            goto fail;
-    }
-
     pkt->size = 0;
     for (i = 0; i < 3; i++) {
         if (f[i]) {
@@ -574,8 +909,13 @@ fail:
 
 static int img_read_close(struct AVFormatContext* s1)
 {
-#if HAVE_GLOB
+#if HAVE_THREADS || HAVE_GLOB
     VideoDemuxData *s = s1->priv_data;
+#endif
+#if HAVE_THREADS
+    prefetch_free(s1);
+#endif
+#if HAVE_GLOB
     if (s->use_glob) {
         globfree(&s->globstate);
     }
@@ -626,6 +966,8 @@ const AVOption ff_img_options[] = {
     { "sec",  "second precision",       0, AV_OPT_TYPE_CONST,    {.i64 = 1   }, 0, 2,       DEC, "ts_type" },
     { "ns",   "nano second precision",  0, AV_OPT_TYPE_CONST,    {.i64 = 2   }, 0, 2,       DEC, "ts_type" },
     { "export_path_metadata", "enable metadata containing input path information", OFFSET(export_path_metadata), AV_OPT_TYPE_BOOL,   {.i64 = 0   }, 0, 1,       DEC }, \
+    { "prefetch",     "set number of files to read ahead",   OFFSET(prefetch),     AV_OPT_TYPE_INT,    {.i64 = 0   }, 0, 1024,    DEC },
+    { "prefetch_threads", "set number of threads reading ahead", OFFSET(prefetch_threads), AV_OPT_TYPE_INT, {.i64 = 4 }, 1, 256,    DEC },
     COMMON_OPTIONS
 };
 
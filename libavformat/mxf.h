@@ -53,6 +53,7 @@ enum MXFMetadataSetType {
     AudioChannelLabelSubDescriptor,
     SoundfieldGroupLabelSubDescriptor,
     GroupOfSoundfieldGroupsLabelSubDescriptor,
+    JPEG2000SubDescriptor,
 };
 
 enum MXFFrameLayout {
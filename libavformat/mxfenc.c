@@ -48,8 +48,10 @@
 #include "libavutil/mastering_display_metadata.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/time_internal.h"
+#include "libavcodec/bytestream.h"
 #include "libavcodec/golomb.h"
 #include "libavcodec/h264.h"
+#include "libavcodec/jpeg2000.h"
 #include "libavcodec/packet_internal.h"
 #include "libavcodec/startcode.h"
 #include "avformat.h"
@@ -73,6 +75,22 @@ typedef struct MXFIndexEntry {
     uint8_t flags;
 } MXFIndexEntry;
 
+#define MXF_J2K_MAX_COMPONENTS 4
+
+typedef struct MXFJPEG2000Info {
+    uint16_t rsiz;           ///< codestream capabilities (profile)
+    uint32_t xsiz, ysiz;     ///< reference grid size
+    uint32_t x0siz, y0siz;   ///< image area offset
+    uint32_t xtsiz, ytsiz;   ///< tile size
+    uint32_t xt0siz, yt0siz; ///< tile offset
+    uint16_t csiz;           ///< number of components
+    uint8_t  comp_sizing[3 * MXF_J2K_MAX_COMPONENTS]; ///< Ssiz, XRsiz, YRsiz for each component
+    uint8_t  cod[64];        ///< COD marker segment, without marker and length
+    int      cod_size;
+    uint8_t  qcd[256];       ///< QCD marker segment, without marker and length
+    int      qcd_size;
+} MXFJPEG2000Info;
+
 typedef struct MXFStreamContext {
     int64_t pkt_cnt;         ///< pkt counter for muxed packets
     UID track_essence_element_key;
@@ -98,6 +116,7 @@ typedef struct MXFStreamContext {
     int b_picture_count;     ///< maximum number of consecutive b pictures, used in mpeg-2 descriptor
     int low_delay;           ///< low delay, used in mpeg-2 descriptor
     int avc_intra;
+    MXFJPEG2000Info j2k_info;
 } MXFStreamContext;
 
 typedef struct MXFContainerEssenceEntry {
@@ -147,6 +166,7 @@ static void mxf_write_wav_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_aes3_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_mpegvideo_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_h264_desc(AVFormatContext *s, AVStream *st);
+static void mxf_write_jpeg2000_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_cdci_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_generic_sound_desc(AVFormatContext *s, AVStream *st);
 static void mxf_write_s436m_anc_desc(AVFormatContext *s, AVStream *st);
@@ -188,7 +208,7 @@ static const MXFContainerEssenceEntry mxf_essence_container_uls[] = {
     { { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x07,0x0d,0x01,0x03,0x01,0x02,0x0c,0x01,0x00 },
       { 0x06,0x0e,0x2b,0x34,0x01,0x02,0x01,0x01,0x0d,0x01,0x03,0x01,0x15,0x01,0x08,0x00 },
       { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x07,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x00 },
-      mxf_write_cdci_desc },
+      mxf_write_jpeg2000_desc },
     // H.264
     { { 0x06,0x0E,0x2B,0x34,0x04,0x01,0x01,0x0a,0x0D,0x01,0x03,0x01,0x02,0x10,0x60,0x01 },
       { 0x06,0x0E,0x2B,0x34,0x01,0x02,0x01,0x01,0x0D,0x01,0x03,0x01,0x15,0x01,0x05,0x00 },
@@ -346,6 +366,10 @@ static const MXFLocalTagPair mxf_local_tag_batch[] = {
     { 0x3304, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x01,0x04,0x01,0x05,0x03,0x03,0x00,0x00,0x00}}, /* Black Ref level */
     { 0x3305, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x01,0x04,0x01,0x05,0x03,0x04,0x00,0x00,0x00}}, /* White Ref level */
     { 0x3306, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x02,0x04,0x01,0x05,0x03,0x05,0x00,0x00,0x00}}, /* Color Range */
+    // RGBA Picture Essence Descriptor
+    { 0x3406, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x05,0x04,0x01,0x05,0x03,0x0B,0x00,0x00,0x00}}, /* Component Max Ref */
+    { 0x3407, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x05,0x04,0x01,0x05,0x03,0x0C,0x00,0x00,0x00}}, /* Component Min Ref */
+    { 0x3401, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x02,0x04,0x01,0x05,0x03,0x06,0x00,0x00,0x00}}, /* Pixel Layout */
     // Generic Sound Essence Descriptor
     { 0x3D02, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x04,0x04,0x02,0x03,0x01,0x04,0x00,0x00,0x00}}, /* Locked/Unlocked */
     { 0x3D03, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x05,0x04,0x02,0x03,0x01,0x01,0x01,0x00,0x00}}, /* Audio sampling rate */
@@ -381,6 +405,20 @@ static const MXFLocalTagPair mxf_local_tag_batch[] = {
     { 0x8200, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0E,0x04,0x01,0x06,0x06,0x01,0x0E,0x00,0x00}}, /* AVC Decoding Delay */
     { 0x8201, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0E,0x04,0x01,0x06,0x06,0x01,0x0A,0x00,0x00}}, /* AVC Profile */
     { 0x8202, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0E,0x04,0x01,0x06,0x06,0x01,0x0D,0x00,0x00}}, /* AVC Level */
+    // mxf_jpeg2000_subdescriptor_local_tags
+    { 0x8401, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x01,0x00,0x00,0x00}}, /* Rsiz */
+    { 0x8402, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x02,0x00,0x00,0x00}}, /* Xsiz */
+    { 0x8403, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x03,0x00,0x00,0x00}}, /* Ysiz */
+    { 0x8404, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x04,0x00,0x00,0x00}}, /* XOsiz */
+    { 0x8405, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x05,0x00,0x00,0x00}}, /* YOsiz */
+    { 0x8406, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x06,0x00,0x00,0x00}}, /* XTsiz */
+    { 0x8407, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x07,0x00,0x00,0x00}}, /* YTsiz */
+    { 0x8408, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x08,0x00,0x00,0x00}}, /* XTOsiz */
+    { 0x8409, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x09,0x00,0x00,0x00}}, /* YTOsiz */
+    { 0x840A, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x0A,0x00,0x00,0x00}}, /* Csiz */
+    { 0x840B, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x0B,0x00,0x00,0x00}}, /* Picture Component Sizing */
+    { 0x840C, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x0C,0x00,0x00,0x00}}, /* Coding Style Default */
+    { 0x840D, {0x06,0x0E,0x2B,0x34,0x01,0x01,0x01,0x0A,0x04,0x01,0x06,0x03,0x0D,0x00,0x00,0x00}}, /* Quantization Default */
     // ff_mxf_mastering_display_local_tags
     { 0x8301, FF_MXF_MasteringDisplayPrimaries },
     { 0x8302, FF_MXF_MasteringDisplayWhitePointChromaticity },
@@ -517,18 +555,41 @@ static void mxf_mark_tag_unused(MXFContext *mxf, int tag)
     mxf->unused_tags[pair - mxf_local_tag_batch] = 1;
 }
 
+static int mxf_jpeg2000_is_rgb(AVStream *st)
+{
+    MXFStreamContext *sc = st->priv_data;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(st->codecpar->format);
+
+    if (st->codecpar->codec_id != AV_CODEC_ID_JPEG2000 || sc->j2k_info.csiz < 3)
+        return 0;
+    if (st->codecpar->format == AV_PIX_FMT_XYZ12LE ||
+        st->codecpar->format == AV_PIX_FMT_XYZ12BE)
+        return 1;
+    if (desc)
+        return !!(desc->flags & AV_PIX_FMT_FLAG_RGB);
+    // without a pixel format, only digital cinema codestreams are known not to be YUV
+    return sc->j2k_info.rsiz == FF_PROFILE_JPEG2000_DCINEMA_2K ||
+           sc->j2k_info.rsiz == FF_PROFILE_JPEG2000_DCINEMA_4K;
+}
+
 static void mxf_write_primer_pack(AVFormatContext *s)
 {
     MXFContext *mxf = s->priv_data;
     AVIOContext *pb = s->pb;
     int local_tag_number = MXF_NUM_TAGS, i;
-    int will_have_avc_tags = 0, will_have_mastering_tags = 0;
+    int will_have_avc_tags = 0, will_have_mastering_tags = 0, will_have_jpeg2000_tags = 0;
+    int will_have_rgba_tags = 0;
 
     for (i = 0; i < s->nb_streams; i++) {
         MXFStreamContext *sc = s->streams[i]->priv_data;
         if (s->streams[i]->codecpar->codec_id == AV_CODEC_ID_H264 && !sc->avc_intra) {
             will_have_avc_tags = 1;
         }
+        if (s->streams[i]->codecpar->codec_id == AV_CODEC_ID_JPEG2000 && sc->j2k_info.csiz) {
+            will_have_jpeg2000_tags = 1;
+            if (mxf_jpeg2000_is_rgb(s->streams[i]))
+                will_have_rgba_tags = 1;
+        }
         if (av_stream_get_side_data(s->streams[i], AV_PKT_DATA_MASTERING_DISPLAY_METADATA, NULL)) {
             will_have_mastering_tags = 1;
         }
@@ -540,8 +601,10 @@ static void mxf_write_primer_pack(AVFormatContext *s)
         mxf_mark_tag_unused(mxf, 0x5003);
     }
 
-    if (!will_have_avc_tags) {
+    if (!will_have_avc_tags && !will_have_jpeg2000_tags)
         mxf_mark_tag_unused(mxf, 0x8100);
+
+    if (!will_have_avc_tags) {
         mxf_mark_tag_unused(mxf, 0x8200);
         mxf_mark_tag_unused(mxf, 0x8201);
         mxf_mark_tag_unused(mxf, 0x8202);
@@ -554,6 +617,17 @@ static void mxf_write_primer_pack(AVFormatContext *s)
         mxf_mark_tag_unused(mxf, 0x8304);
     }
 
+    if (!will_have_jpeg2000_tags) {
+        for (i = 0x8401; i <= 0x840D; i++)
+            mxf_mark_tag_unused(mxf, i);
+    }
+
+    if (!will_have_rgba_tags) {
+        mxf_mark_tag_unused(mxf, 0x3401);
+        mxf_mark_tag_unused(mxf, 0x3406);
+        mxf_mark_tag_unused(mxf, 0x3407);
+    }
+
     for (i = 0; i < MXF_NUM_TAGS; i++) {
         if (mxf->unused_tags[i]) {
             local_tag_number--;
@@ -1090,9 +1164,11 @@ static const UID mxf_mpegvideo_descriptor_key = { 0x06,0x0E,0x2B,0x34,0x02,0x53,
 static const UID mxf_wav_descriptor_key       = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0d,0x01,0x01,0x01,0x01,0x01,0x48,0x00 };
 static const UID mxf_aes3_descriptor_key      = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0d,0x01,0x01,0x01,0x01,0x01,0x47,0x00 };
 static const UID mxf_cdci_descriptor_key      = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0D,0x01,0x01,0x01,0x01,0x01,0x28,0x00 };
+static const UID mxf_rgba_descriptor_key      = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0D,0x01,0x01,0x01,0x01,0x01,0x29,0x00 };
 static const UID mxf_generic_sound_descriptor_key = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0D,0x01,0x01,0x01,0x01,0x01,0x42,0x00 };
 
 static const UID mxf_avc_subdescriptor_key = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0d,0x01,0x01,0x01,0x01,0x01,0x6E,0x00 };
+static const UID mxf_jpeg2000_subdescriptor_key = { 0x06,0x0E,0x2B,0x34,0x02,0x53,0x01,0x01,0x0d,0x01,0x01,0x01,0x01,0x01,0x5A,0x00 };
 
 static inline uint16_t rescale_mastering_chroma(AVRational q)
 {
@@ -1128,6 +1204,15 @@ static int64_t mxf_write_cdci_common(AVFormatContext *s, AVStream *st, const UID
         else if (st->codecpar->height == 720)
             stored_width = 1280;
     }
+    if (st->codecpar->codec_id == AV_CODEC_ID_JPEG2000 && sc->j2k_info.csiz) {
+        // the codestream carries the exact image area, there is no macroblock padding
+        stored_width  = sc->j2k_info.xsiz - sc->j2k_info.x0siz;
+        stored_height = sc->j2k_info.ysiz - sc->j2k_info.y0siz;
+        // stored height is written per field below, a codestream smaller
+        // than the frame already holds a single field
+        if (sc->interlaced && stored_height < st->codecpar->height)
+            stored_height <<= 1;
+    }
     if (!stored_width)
         stored_width = (st->codecpar->width+15)/16*16;
 
@@ -1194,41 +1279,72 @@ static int64_t mxf_write_cdci_common(AVFormatContext *s, AVStream *st, const UID
         avio_wb32(pb, -((st->codecpar->height - display_height)&1));
     }
 
-    // component depth
-    mxf_write_local_tag(s, 4, 0x3301);
-    avio_wb32(pb, sc->component_depth);
-
-    // horizontal subsampling
-    mxf_write_local_tag(s, 4, 0x3302);
-    avio_wb32(pb, sc->h_chroma_sub_sample);
-
-    // vertical subsampling
-    mxf_write_local_tag(s, 4, 0x3308);
-    avio_wb32(pb, sc->v_chroma_sub_sample);
-
-    // color siting
-    mxf_write_local_tag(s, 1, 0x3303);
-    avio_w8(pb, sc->color_siting);
-
-    // Padding Bits
-    mxf_write_local_tag(s, 2, 0x3307);
-    avio_wb16(pb, 0);
-
-    if (st->codecpar->color_range != AVCOL_RANGE_UNSPECIFIED) {
-        int black = 0,
-            white = (1<<sc->component_depth) - 1,
-            color = (1<<sc->component_depth);
+    if (!memcmp(key, mxf_rgba_descriptor_key, 16)) {
+        const MXFJPEG2000Info *j2k = &sc->j2k_info;
+        // without a pixel format only digital cinema codestreams get here
+        int xyz = st->codecpar->format == AV_PIX_FMT_XYZ12LE ||
+                  st->codecpar->format == AV_PIX_FMT_XYZ12BE ||
+                  !av_pix_fmt_desc_get(st->codecpar->format);
+        int max_ref = (1<<sc->component_depth) - 1,
+            min_ref = 0;
         if (st->codecpar->color_range == AVCOL_RANGE_MPEG) {
-            black = 1   << (sc->component_depth - 4);
-            white = 235 << (sc->component_depth - 8);
-            color = (14 << (sc->component_depth - 4)) + 1;
+            min_ref = 16  << (sc->component_depth - 8);
+            max_ref = 235 << (sc->component_depth - 8);
+        }
+        mxf_write_local_tag(s, 4, 0x3406);
+        avio_wb32(pb, max_ref);
+        mxf_write_local_tag(s, 4, 0x3407);
+        avio_wb32(pb, min_ref);
+
+        // pixel layout, one code and depth pair per codestream component
+        mxf_write_local_tag(s, 16, 0x3401);
+        for (int i = 0; i < 8; i++) {
+            static const uint8_t rgba_codes[] = { 'R', 'G', 'B', 'A' };
+            static const uint8_t xyz_codes[]  = { 0xD8, 0xD9, 0xDA };
+            if (i < FFMIN(j2k->csiz, xyz ? 3 : 4)) {
+                avio_w8(pb, xyz ? xyz_codes[i] : rgba_codes[i]);
+                avio_w8(pb, (j2k->comp_sizing[3 * i] & 0x7F) + 1);
+            } else {
+                avio_wb16(pb, 0);
+            }
+        }
+    } else {
+        // component depth
+        mxf_write_local_tag(s, 4, 0x3301);
+        avio_wb32(pb, sc->component_depth);
+
+        // horizontal subsampling
+        mxf_write_local_tag(s, 4, 0x3302);
+        avio_wb32(pb, sc->h_chroma_sub_sample);
+
+        // vertical subsampling
+        mxf_write_local_tag(s, 4, 0x3308);
+        avio_wb32(pb, sc->v_chroma_sub_sample);
+
+        // color siting
+        mxf_write_local_tag(s, 1, 0x3303);
+        avio_w8(pb, sc->color_siting);
+
+        // Padding Bits
+        mxf_write_local_tag(s, 2, 0x3307);
+        avio_wb16(pb, 0);
+
+        if (st->codecpar->color_range != AVCOL_RANGE_UNSPECIFIED) {
+            int black = 0,
+                white = (1<<sc->component_depth) - 1,
+                color = (1<<sc->component_depth);
+            if (st->codecpar->color_range == AVCOL_RANGE_MPEG) {
+                black = 1   << (sc->component_depth - 4);
+                white = 235 << (sc->component_depth - 8);
+                color = (14 << (sc->component_depth - 4)) + 1;
+            }
+            mxf_write_local_tag(s, 4, 0x3304);
+            avio_wb32(pb, black);
+            mxf_write_local_tag(s, 4, 0x3305);
+            avio_wb32(pb, white);
+            mxf_write_local_tag(s, 4, 0x3306);
+            avio_wb32(pb, color);
         }
-        mxf_write_local_tag(s, 4, 0x3304);
-        avio_wb32(pb, black);
-        mxf_write_local_tag(s, 4, 0x3305);
-        avio_wb32(pb, white);
-        mxf_write_local_tag(s, 4, 0x3306);
-        avio_wb32(pb, color);
     }
 
     if (sc->signal_standard) {
@@ -1325,6 +1441,13 @@ static int64_t mxf_write_cdci_common(AVFormatContext *s, AVStream *st, const UID
         mxf_write_uuid(pb, AVCSubDescriptor, 0);
     }
 
+    if (st->codecpar->codec_id == AV_CODEC_ID_JPEG2000 && sc->j2k_info.csiz) {
+        // write jpeg2000 sub descriptor ref
+        mxf_write_local_tag(s, 8 + 16, 0x8100);
+        mxf_write_refs_count(pb, 1);
+        mxf_write_uuid(pb, JPEG2000SubDescriptor, st->index);
+    }
+
     return pos;
 }
 
@@ -1361,6 +1484,64 @@ static void mxf_write_avc_subdesc(AVFormatContext *s, AVStream *st)
     mxf_update_klv_size(s->pb, pos);
 }
 
+static void mxf_write_jpeg2000_subdesc(AVFormatContext *s, AVStream *st)
+{
+    MXFStreamContext *sc = st->priv_data;
+    const MXFJPEG2000Info *j2k = &sc->j2k_info;
+    AVIOContext *pb = s->pb;
+    int64_t pos;
+
+    avio_write(pb, mxf_jpeg2000_subdescriptor_key, 16);
+    klv_encode_ber4_length(pb, 0);
+    pos = avio_tell(pb);
+
+    mxf_write_local_tag(s, 16, 0x3C0A);
+    mxf_write_uuid(pb, JPEG2000SubDescriptor, st->index);
+
+    mxf_write_local_tag(s, 2, 0x8401);
+    avio_wb16(pb, j2k->rsiz);
+
+    mxf_write_local_tag(s, 4, 0x8402);
+    avio_wb32(pb, j2k->xsiz);
+
+    mxf_write_local_tag(s, 4, 0x8403);
+    avio_wb32(pb, j2k->ysiz);
+
+    mxf_write_local_tag(s, 4, 0x8404);
+    avio_wb32(pb, j2k->x0siz);
+
+    mxf_write_local_tag(s, 4, 0x8405);
+    avio_wb32(pb, j2k->y0siz);
+
+    mxf_write_local_tag(s, 4, 0x8406);
+    avio_wb32(pb, j2k->xtsiz);
+
+    mxf_write_local_tag(s, 4, 0x8407);
+    avio_wb32(pb, j2k->ytsiz);
+
+    mxf_write_local_tag(s, 4, 0x8408);
+    avio_wb32(pb, j2k->xt0siz);
+
+    mxf_write_local_tag(s, 4, 0x8409);
+    avio_wb32(pb, j2k->yt0siz);
+
+    mxf_write_local_tag(s, 2, 0x840A);
+    avio_wb16(pb, j2k->csiz);
+
+    mxf_write_local_tag(s, 8 + 3 * j2k->csiz, 0x840B);
+    avio_wb32(pb, j2k->csiz); // num of entries
+    avio_wb32(pb, 3);         // size of one entry
+    avio_write(pb, j2k->comp_sizing, 3 * j2k->csiz);
+
+    mxf_write_local_tag(s, j2k->cod_size, 0x840C);
+    avio_write(pb, j2k->cod, j2k->cod_size);
+
+    mxf_write_local_tag(s, j2k->qcd_size, 0x840D);
+    avio_write(pb, j2k->qcd, j2k->qcd_size);
+
+    mxf_update_klv_size(s->pb, pos);
+}
+
 static void mxf_write_cdci_desc(AVFormatContext *s, AVStream *st)
 {
     int64_t pos = mxf_write_cdci_common(s, st, mxf_cdci_descriptor_key);
@@ -1371,6 +1552,16 @@ static void mxf_write_cdci_desc(AVFormatContext *s, AVStream *st)
     }
 }
 
+static void mxf_write_jpeg2000_desc(AVFormatContext *s, AVStream *st)
+{
+    MXFStreamContext *sc = st->priv_data;
+    int64_t pos = mxf_write_cdci_common(s, st, mxf_jpeg2000_is_rgb(st) ?
+                                        mxf_rgba_descriptor_key : mxf_cdci_descriptor_key);
+    mxf_update_klv_size(s->pb, pos);
+    if (sc->j2k_info.csiz)
+        mxf_write_jpeg2000_subdesc(s, st);
+}
+
 static void mxf_write_h264_desc(AVFormatContext *s, AVStream *st)
 {
     MXFStreamContext *sc = st->priv_data;
@@ -2037,6 +2228,122 @@ static int mxf_parse_prores_frame(AVFormatContext *s, AVStream *st, AVPacket *pk
     return 1;
 }
 
+static const struct {
+    uint16_t rsiz;
+    UID codec_ul;
+} mxf_jpeg2000_codec_uls[] = {
+    { FF_PROFILE_JPEG2000_DCINEMA_2K, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x09,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x03 } }, // 2K Digital Cinema
+    { FF_PROFILE_JPEG2000_DCINEMA_4K, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x09,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x04 } }, // 4K Digital Cinema
+    { 0x0101, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x11 } }, // Broadcast Contribution Single Tile, Level 1
+    { 0x0102, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x12 } }, // Broadcast Contribution Single Tile, Level 2
+    { 0x0103, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x13 } }, // Broadcast Contribution Single Tile, Level 3
+    { 0x0104, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x14 } }, // Broadcast Contribution Single Tile, Level 4
+    { 0x0105, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x15 } }, // Broadcast Contribution Single Tile, Level 5
+    { 0x0106, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x16 } }, // Broadcast Contribution Single Tile, Level 6
+    { 0x0107, { 0x06,0x0e,0x2b,0x34,0x04,0x01,0x01,0x0d,0x04,0x01,0x02,0x02,0x03,0x01,0x01,0x17 } }, // Broadcast Contribution Single Tile, Level 7
+};
+
+static int mxf_parse_jpeg2000_frame(AVFormatContext *s, AVStream *st,
+                                    AVPacket *pkt, MXFIndexEntry *e)
+{
+    MXFContext *mxf = s->priv_data;
+    MXFStreamContext *sc = st->priv_data;
+    MXFJPEG2000Info *j2k = &sc->j2k_info;
+    GetByteContext g;
+    int i, marker, len;
+
+    e->flags |= 0x80; // every codestream is a random access point
+
+    if (mxf->header_written)
+        return 1;
+
+    bytestream2_init(&g, pkt->data, pkt->size);
+    if (bytestream2_get_be16(&g) != JPEG2000_SOC) {
+        // e.g. JP2 files, the default output of the jpeg2000 encoder
+        av_log(s, AV_LOG_WARNING, "jpeg2000 packet is not a raw codestream, "
+               "writing the picture descriptor without JPEG 2000 sub-descriptor\n");
+        return 1;
+    }
+
+    // walk the main header up to the first tile-part
+    while (bytestream2_get_bytes_left(&g) >= 4) {
+        marker = bytestream2_get_be16(&g);
+        if (marker == JPEG2000_SOT)
+            break;
+        len = bytestream2_get_be16(&g);
+        if (len < 2 || len - 2 > bytestream2_get_bytes_left(&g)) {
+            av_log(s, AV_LOG_ERROR, "invalid jpeg2000 marker segment length %d\n", len);
+            return 0;
+        }
+        len -= 2;
+
+        switch (marker) {
+        case JPEG2000_SIZ:
+            if (len < 36)
+                return 0;
+            j2k->rsiz   = bytestream2_get_be16u(&g);
+            j2k->xsiz   = bytestream2_get_be32u(&g);
+            j2k->ysiz   = bytestream2_get_be32u(&g);
+            j2k->x0siz  = bytestream2_get_be32u(&g);
+            j2k->y0siz  = bytestream2_get_be32u(&g);
+            j2k->xtsiz  = bytestream2_get_be32u(&g);
+            j2k->ytsiz  = bytestream2_get_be32u(&g);
+            j2k->xt0siz = bytestream2_get_be32u(&g);
+            j2k->yt0siz = bytestream2_get_be32u(&g);
+            j2k->csiz   = bytestream2_get_be16u(&g);
+            if (!j2k->csiz || j2k->csiz > MXF_J2K_MAX_COMPONENTS ||
+                len != 36 + 3 * j2k->csiz ||
+                j2k->x0siz >= j2k->xsiz || j2k->y0siz >= j2k->ysiz) {
+                av_log(s, AV_LOG_ERROR, "unsupported jpeg2000 image size marker\n");
+                j2k->csiz = 0;
+                return 0;
+            }
+            bytestream2_get_bufferu(&g, j2k->comp_sizing, 3 * j2k->csiz);
+            break;
+        case JPEG2000_COD:
+            if (len > sizeof(j2k->cod))
+                return 0;
+            j2k->cod_size = bytestream2_get_bufferu(&g, j2k->cod, len);
+            break;
+        case JPEG2000_QCD:
+            if (len > sizeof(j2k->qcd))
+                return 0;
+            j2k->qcd_size = bytestream2_get_bufferu(&g, j2k->qcd, len);
+            break;
+        default:
+            bytestream2_skipu(&g, len);
+            break;
+        }
+    }
+
+    if (!j2k->csiz || !j2k->cod_size || !j2k->qcd_size) {
+        av_log(s, AV_LOG_ERROR, "jpeg2000 main header is missing SIZ, COD or QCD\n");
+        return 0;
+    }
+
+    st->codecpar->profile = j2k->rsiz;
+    // other profiles keep the generic JPEG 2000 picture coding label
+    for (i = 0; i < FF_ARRAY_ELEMS(mxf_jpeg2000_codec_uls); i++) {
+        if (j2k->rsiz == mxf_jpeg2000_codec_uls[i].rsiz) {
+            sc->codec_ul = &mxf_jpeg2000_codec_uls[i].codec_ul;
+            break;
+        }
+    }
+    sc->interlaced = st->codecpar->field_order != AV_FIELD_UNKNOWN &&
+                     st->codecpar->field_order != AV_FIELD_PROGRESSIVE;
+    sc->component_depth = (j2k->comp_sizing[0] & 0x7F) + 1;
+    if (j2k->csiz >= 3) {
+        sc->h_chroma_sub_sample = j2k->comp_sizing[3 + 1];
+        sc->v_chroma_sub_sample = j2k->comp_sizing[3 + 2];
+    }
+    for (i = 1; i < j2k->csiz; i++) {
+        if ((j2k->comp_sizing[3 * i] & 0x7F) + 1 != sc->component_depth)
+            av_log(s, AV_LOG_WARNING, "jpeg2000 components have different bit depths\n");
+    }
+
+    return 1;
+}
+
 static const struct {
     uint16_t cid;
     uint8_t  interlaced;
@@ -2925,6 +3232,11 @@ static int mxf_write_packet(AVFormatContext *s, AVPacket *pkt)
             av_log(s, AV_LOG_ERROR, "could not get h264 profile\n");
             return -1;
         }
+    } else if (st->codecpar->codec_id == AV_CODEC_ID_JPEG2000) {
+        if (!mxf_parse_jpeg2000_frame(s, st, pkt, &ie)) {
+            av_log(s, AV_LOG_ERROR, "could not get jpeg2000 codestream parameters\n");
+            return -1;
+        }
     }
 
     if (mxf->cbr_index) {
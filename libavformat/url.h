@@ -75,6 +75,14 @@ typedef struct URLProtocol {
      * retry_transfer_wrapper in avio.c.
      */
     int     (*url_read)( URLContext *h, unsigned char *buf, int size);
+    /**
+     * Return a pointer to up to size bytes at the current position without
+     * copying them and advance the position. Fewer bytes may only be
+     * returned at the end of the resource. The data stays valid until the
+     * next call on the context. Return AVERROR(ENOSYS) if the data cannot
+     * be returned this way; url_read is used instead then.
+     */
+    int     (*url_read_indirect)(URLContext *h, const uint8_t **data, int size);
     int     (*url_write)(URLContext *h, const unsigned char *buf, int size);
     int64_t (*url_seek)( URLContext *h, int64_t pos, int whence);
     int     (*url_close)(URLContext *h);
@@ -190,6 +198,16 @@ int ffurl_read(URLContext *h, unsigned char *buf, int size);
  */
 int ffurl_read_complete(URLContext *h, unsigned char *buf, int size);
 
+/**
+ * Read up to size bytes from the resource accessed by h without copying
+ * them, see URLProtocol.url_read_indirect.
+ *
+ * @return number of bytes read with *data pointing to them, or a negative
+ * AVERROR code, AVERROR(ENOSYS) if the protocol cannot provide the data
+ * without a copy
+ */
+int ffurl_read_indirect(URLContext *h, const uint8_t **data, int size);
+
 /**
  * Write size bytes from buf to the resource accessed by h.
  *
@@ -24,6 +24,7 @@
 #include "buffer_internal.h"
 #include "common.h"
 #include "mem.h"
+#include "mem_internal.h"
 #include "thread.h"
 
 static AVBufferRef *buffer_create(AVBuffer *buf, uint8_t *data, size_t size,
@@ -74,11 +75,60 @@ void av_buffer_default_free(void *opaque, uint8_t *data)
     av_free(data);
 }
 
+typedef struct LargeBuffer {
+    size_t mapped;
+    int node;
+} LargeBuffer;
+
+static void large_buffer_free(void *opaque, uint8_t *data)
+{
+    LargeBuffer *large = opaque;
+
+    ff_large_free(data, large->mapped);
+    av_free(large);
+}
+
+/* the NUMA node of the data of a buffer, -1 if it was not placed */
+static int buffer_node(const AVBuffer *buf)
+{
+    return buf->free == large_buffer_free ?
+           ((LargeBuffer *)buf->opaque)->node : -1;
+}
+
+static AVBufferRef *large_buffer_alloc(size_t size)
+{
+    LargeBuffer *large;
+    AVBufferRef *ret;
+    uint8_t *data;
+
+    large = av_malloc(sizeof(*large));
+    if (!large)
+        return NULL;
+
+    data = ff_large_alloc(size, &large->mapped, &large->node);
+    if (!data) {
+        av_free(large);
+        return NULL;
+    }
+
+    ret = av_buffer_create(data, size, large_buffer_free, large, 0);
+    if (!ret)
+        large_buffer_free(large, data);
+
+    return ret;
+}
+
 AVBufferRef *av_buffer_alloc(size_t size)
 {
     AVBufferRef *ret = NULL;
     uint8_t    *data = NULL;
 
+    if (ff_large_alloc_flags(size) & (AV_MEM_LARGE_HUGETLB | AV_MEM_LARGE_NUMA)) {
+        ret = large_buffer_alloc(size);
+        if (ret)
+            return ret;
+    }
+
     data = av_malloc(size);
     if (!data)
         return NULL;
@@ -256,6 +306,19 @@ int av_buffer_replace(AVBufferRef **pdst, const AVBufferRef *src)
     return 0;
 }
 
+static void buffer_pool_init(AVBufferPool *pool, size_t size)
+{
+    ff_mutex_init(&pool->mutex, NULL);
+
+    pool->size = size;
+
+    atomic_init(&pool->free_list, 0);
+    atomic_init(&pool->empty_list, 0);
+    atomic_init(&pool->nb_free, 0);
+    atomic_init(&pool->max_free, 0);
+    atomic_init(&pool->refcount, 1);
+}
+
 AVBufferPool *av_buffer_pool_init2(size_t size, void *opaque,
                                    AVBufferRef* (*alloc)(void *opaque, size_t size),
                                    void (*pool_free)(void *opaque))
@@ -264,16 +327,13 @@ AVBufferPool *av_buffer_pool_init2(size_t size, void *opaque,
     if (!pool)
         return NULL;
 
-    ff_mutex_init(&pool->mutex, NULL);
+    buffer_pool_init(pool, size);
 
-    pool->size      = size;
     pool->opaque    = opaque;
     pool->alloc2    = alloc;
     pool->alloc     = av_buffer_alloc; // fallback
     pool->pool_free = pool_free;
 
-    atomic_init(&pool->refcount, 1);
-
     return pool;
 }
 
@@ -283,24 +343,90 @@ AVBufferPool *av_buffer_pool_init(size_t size, AVBufferRef* (*alloc)(size_t size
     if (!pool)
         return NULL;
 
-    ff_mutex_init(&pool->mutex, NULL);
-
-    pool->size     = size;
-    pool->alloc    = alloc ? alloc : av_buffer_alloc;
+    buffer_pool_init(pool, size);
 
-    atomic_init(&pool->refcount, 1);
+    pool->alloc = alloc ? alloc : av_buffer_alloc;
 
     return pool;
 }
 
-static void buffer_pool_flush(AVBufferPool *pool)
+static BufferPoolEntry *pool_entry(AVBufferPool *pool, unsigned index)
+{
+    unsigned chunk = av_log2(index / POOL_CHUNK_SIZE + 1);
+    return &pool->chunks[chunk][index - POOL_CHUNK_SIZE * ((1U << chunk) - 1)];
+}
+
+static void pool_push(atomic_uint_least64_t *list, BufferPoolEntry *buf)
+{
+    uint_least64_t head = atomic_load_explicit(list, memory_order_relaxed);
+    uint_least64_t new;
+
+    do {
+        atomic_store_explicit(&buf->next, (uint32_t)head, memory_order_relaxed);
+        new = (((head >> 32) + 1) << 32) | (buf->index + 1);
+    } while (!atomic_compare_exchange_weak_explicit(list, &head, new,
+                                                    memory_order_release,
+                                                    memory_order_relaxed));
+}
+
+static BufferPoolEntry *pool_pop(AVBufferPool *pool, atomic_uint_least64_t *list)
 {
-    while (pool->pool) {
-        BufferPoolEntry *buf = pool->pool;
-        pool->pool = buf->next;
+    /* without a tag, a pop could be fooled by concurrent ones (ABA) */
+    const int locked = sizeof(*list) < sizeof(uint64_t);
+    uint_least64_t head, new;
+    BufferPoolEntry *buf;
+
+    if (locked)
+        ff_mutex_lock(&pool->mutex);
+
+    head = atomic_load_explicit(list, memory_order_acquire);
+    do {
+        if (!(uint32_t)head) {
+            buf = NULL;
+            break;
+        }
+        buf = pool_entry(pool, (uint32_t)head - 1);
+        new = (((head >> 32) + 1) << 32) |
+              atomic_load_explicit(&buf->next, memory_order_relaxed);
+    } while (!atomic_compare_exchange_weak_explicit(list, &head, new,
+                                                    memory_order_acquire,
+                                                    memory_order_acquire));
+
+    if (locked)
+        ff_mutex_unlock(&pool->mutex);
 
-        buf->free(buf->opaque, buf->data);
-        av_freep(&buf);
+    return buf;
+}
+
+static BufferPoolEntry *pool_get_free(AVBufferPool *pool)
+{
+    BufferPoolEntry *buf = pool_pop(pool, &pool->free_list);
+    if (buf)
+        atomic_fetch_sub_explicit(&pool->nb_free, 1, memory_order_relaxed);
+    return buf;
+}
+
+static void pool_put_free(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    atomic_fetch_add_explicit(&pool->nb_free, 1, memory_order_relaxed);
+    pool_push(&pool->free_list, buf);
+}
+
+/* free the buffer of an entry and keep the entry for a later allocation */
+static void pool_discard(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    buf->free(buf->opaque, buf->data);
+    buf->data = NULL;
+    pool_push(&pool->empty_list, buf);
+}
+
+static void buffer_pool_trim(AVBufferPool *pool, size_t nb_free)
+{
+    while (atomic_load_explicit(&pool->nb_free, memory_order_relaxed) > nb_free) {
+        BufferPoolEntry *buf = pool_get_free(pool);
+        if (!buf)
+            break;
+        pool_discard(pool, buf);
     }
 }
 
@@ -310,7 +436,11 @@ static void buffer_pool_flush(AVBufferPool *pool)
  */
 static void buffer_pool_free(AVBufferPool *pool)
 {
-    buffer_pool_flush(pool);
+    int i;
+
+    buffer_pool_trim(pool, 0);
+    for (i = 0; i < POOL_MAX_CHUNKS; i++)
+        av_freep(&pool->chunks[i]);
     ff_mutex_destroy(&pool->mutex);
 
     if (pool->pool_free)
@@ -328,31 +458,74 @@ void av_buffer_pool_uninit(AVBufferPool **ppool)
     pool   = *ppool;
     *ppool = NULL;
 
-    ff_mutex_lock(&pool->mutex);
-    buffer_pool_flush(pool);
-    ff_mutex_unlock(&pool->mutex);
+    buffer_pool_trim(pool, 0);
 
     if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
 }
 
+void av_buffer_pool_trim(AVBufferPool *pool, size_t nb_free)
+{
+    buffer_pool_trim(pool, nb_free);
+}
+
+void av_buffer_pool_set_max_free(AVBufferPool *pool, size_t max_free)
+{
+    atomic_store_explicit(&pool->max_free, max_free, memory_order_relaxed);
+    if (max_free)
+        buffer_pool_trim(pool, max_free);
+}
+
 static void pool_release_buffer(void *opaque, uint8_t *data)
 {
     BufferPoolEntry *buf = opaque;
     AVBufferPool *pool = buf->pool;
+    size_t max_free = atomic_load_explicit(&pool->max_free, memory_order_relaxed);
 
-    if(CONFIG_MEMORY_POISONING)
-        memset(buf->data, FF_MEMORY_POISON, pool->size);
+    if (max_free &&
+        atomic_load_explicit(&pool->nb_free, memory_order_relaxed) >= max_free) {
+        pool_discard(pool, buf);
+    } else {
+        if(CONFIG_MEMORY_POISONING)
+            memset(buf->data, FF_MEMORY_POISON, pool->size);
 
-    ff_mutex_lock(&pool->mutex);
-    buf->next = pool->pool;
-    pool->pool = buf;
-    ff_mutex_unlock(&pool->mutex);
+        pool_put_free(pool, buf);
+    }
 
     if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
 }
 
+/* take an entry that has no buffer, growing the entry table if needed */
+static BufferPoolEntry *pool_new_entry(AVBufferPool *pool)
+{
+    BufferPoolEntry *buf = pool_pop(pool, &pool->empty_list);
+    unsigned chunk;
+
+    if (buf)
+        return buf;
+
+    ff_mutex_lock(&pool->mutex);
+    chunk = av_log2(pool->nb_entries / POOL_CHUNK_SIZE + 1);
+    if (chunk < POOL_MAX_CHUNKS && !pool->chunks[chunk]) {
+        unsigned i, first = POOL_CHUNK_SIZE * ((1U << chunk) - 1);
+
+        pool->chunks[chunk] = av_calloc(POOL_CHUNK_SIZE << chunk,
+                                        sizeof(*pool->chunks[chunk]));
+        if (pool->chunks[chunk]) {
+            for (i = 0; i < POOL_CHUNK_SIZE << chunk; i++) {
+                pool->chunks[chunk][i].pool  = pool;
+                pool->chunks[chunk][i].index = first + i;
+            }
+        }
+    }
+    if (chunk < POOL_MAX_CHUNKS && pool->chunks[chunk])
+        buf = pool_entry(pool, pool->nb_entries++);
+    ff_mutex_unlock(&pool->mutex);
+
+    return buf;
+}
+
 /* allocate a new buffer and override its free() callback so that
  * it is returned to the pool on free */
 static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
@@ -367,7 +540,7 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     if (!ret)
         return NULL;
 
-    buf = av_mallocz(sizeof(*buf));
+    buf = pool_new_entry(pool);
     if (!buf) {
         av_buffer_unref(&ret);
         return NULL;
@@ -376,7 +549,7 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     buf->data   = ret->buffer->data;
     buf->opaque = ret->buffer->opaque;
     buf->free   = ret->buffer->free;
-    buf->pool   = pool;
+    buf->node   = buffer_node(ret->buffer);
 
     ret->buffer->opaque = buf;
     ret->buffer->free   = pool_release_buffer;
@@ -384,26 +557,49 @@ static AVBufferRef *pool_alloc_buffer(AVBufferPool *pool)
     return ret;
 }
 
+/*
+ * Look for a free buffer placed on the NUMA node of the calling thread among
+ * the first few ones, starting with buf, and put the others back. Returns
+ * NULL if none is found, so that a buffer is allocated on that node.
+ */
+static BufferPoolEntry *pool_get_local(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    BufferPoolEntry *remote[POOL_NUMA_TRIES];
+    int node = ff_numa_node(), i;
+
+    if (node < 0)
+        return buf;
+
+    for (i = 0; buf && buf->node >= 0 && buf->node != node; i++) {
+        remote[i] = buf;
+        buf = i + 1 < POOL_NUMA_TRIES ? pool_get_free(pool) : NULL;
+    }
+    while (i--)
+        pool_put_free(pool, remote[i]);
+
+    return buf;
+}
+
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
 {
     AVBufferRef *ret;
     BufferPoolEntry *buf;
 
-    ff_mutex_lock(&pool->mutex);
-    buf = pool->pool;
+    buf = pool_get_free(pool);
+    if (buf && buf->node >= 0 &&
+        (ff_large_alloc_flags(pool->size) & AV_MEM_LARGE_NUMA))
+        buf = pool_get_local(pool, buf);
     if (buf) {
         memset(&buf->buffer, 0, sizeof(buf->buffer));
         ret = buffer_create(&buf->buffer, buf->data, pool->size,
                             pool_release_buffer, buf, 0);
-        if (ret) {
-            pool->pool = buf->next;
-            buf->next = NULL;
+        if (ret)
             buf->buffer.flags_internal |= BUFFER_FLAG_NO_FREE;
-        }
+        else
+            pool_put_free(pool, buf);
     } else {
         ret = pool_alloc_buffer(pool);
     }
-    ff_mutex_unlock(&pool->mutex);
 
     if (ret)
         atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
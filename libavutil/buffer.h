@@ -302,6 +302,28 @@ void av_buffer_pool_uninit(AVBufferPool **pool);
  */
 AVBufferRef *av_buffer_pool_get(AVBufferPool *pool);
 
+/**
+ * Free unused buffers held by the pool until at most nb_free of them remain.
+ * Buffers currently in use are not affected. This function may be called
+ * simultaneously with av_buffer_pool_get() and with buffers being returned
+ * to the pool.
+ *
+ * @param pool the pool to trim
+ * @param nb_free maximum number of unused buffers to keep
+ */
+void av_buffer_pool_trim(AVBufferPool *pool, size_t nb_free);
+
+/**
+ * Limit the number of unused buffers held by the pool. Once the limit is
+ * reached, buffers returned to the pool are freed instead of being kept for
+ * reuse. Unused buffers beyond the new limit are freed immediately.
+ *
+ * @param pool the pool to limit
+ * @param max_free maximum number of unused buffers to keep, 0 for no limit
+ *                 (the default)
+ */
+void av_buffer_pool_set_max_free(AVBufferPool *pool, size_t max_free);
+
 /**
  * Query the original opaque parameter of an allocated buffer in the pool.
  *
@@ -76,7 +76,16 @@ typedef struct BufferPoolEntry {
     void (*free)(void *opaque, uint8_t *data);
 
     AVBufferPool *pool;
-    struct BufferPoolEntry *next;
+
+    /* NUMA node the data is placed on, -1 if it was not placed */
+    int node;
+
+    /*
+     * Position of this entry in the pool entry table, and that position + 1
+     * of the entry below it on the stack it is on, 0 for the bottom one.
+     */
+    unsigned index;
+    atomic_uint next;
 
     /*
      * An AVBuffer structure to (re)use as AVBuffer for subsequent uses
@@ -85,9 +94,36 @@ typedef struct BufferPoolEntry {
     AVBuffer buffer;
 } BufferPoolEntry;
 
+/*
+ * The entries live in chunks that are never freed before the pool, chunk n
+ * holding POOL_CHUNK_SIZE << n of them. Entries are therefore named by their
+ * table index, and the lock-free stacks below store that index + 1 in the
+ * low 32 bits of their head, with a tag counting the updates in the high
+ * 32 bits to make a stale pop fail its compare-and-swap.
+ */
+#define POOL_CHUNK_SIZE 16
+#define POOL_MAX_CHUNKS 26
+
+/* number of free buffers looked at to find one on the node of the caller */
+#define POOL_NUMA_TRIES 4
+
 struct AVBufferPool {
+    /*
+     * Protects the growth of the entry table. It also serializes the pops
+     * where the stack heads cannot hold a tag.
+     */
     AVMutex mutex;
-    BufferPoolEntry *pool;
+
+    BufferPoolEntry *chunks[POOL_MAX_CHUNKS];
+    unsigned nb_entries;
+
+    /* entries holding an unused buffer */
+    atomic_uint_least64_t free_list;
+    /* entries whose buffer was freed by trimming or capping, for reuse */
+    atomic_uint_least64_t empty_list;
+
+    atomic_size_t nb_free;
+    atomic_size_t max_free;
 
     /*
      * This is used to track when the pool is to be freed.
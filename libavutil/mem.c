@@ -25,6 +25,9 @@
  */
 
 #define _XOPEN_SOURCE 600
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE
+#endif
 
 #include "config.h"
 
@@ -36,6 +39,13 @@
 #if HAVE_MALLOC_H
 #include <malloc.h>
 #endif
+#if HAVE_MMAP
+#include <sys/mman.h>
+#endif
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "attributes.h"
 #include "avassert.h"
@@ -45,6 +55,7 @@
 #include "intreadwrite.h"
 #include "macros.h"
 #include "mem.h"
+#include "mem_internal.h"
 
 #ifdef MALLOC_PREFIX
 
@@ -75,6 +86,104 @@ void av_max_alloc(size_t max){
     atomic_store_explicit(&max_alloc_size, max, memory_order_relaxed);
 }
 
+#define HUGE_PAGE_SIZE (2 << 20)
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+static atomic_int    large_alloc_flags    = ATOMIC_VAR_INIT(0);
+static atomic_size_t large_alloc_min_size = ATOMIC_VAR_INIT(HUGE_PAGE_SIZE);
+
+void av_mem_set_large_alloc(int flags, size_t min_size)
+{
+    atomic_store_explicit(&large_alloc_min_size,
+                          min_size ? min_size : HUGE_PAGE_SIZE,
+                          memory_order_relaxed);
+    atomic_store_explicit(&large_alloc_flags, flags, memory_order_relaxed);
+}
+
+int ff_large_alloc_flags(size_t size)
+{
+    if (size < atomic_load_explicit(&large_alloc_min_size, memory_order_relaxed))
+        return 0;
+    return atomic_load_explicit(&large_alloc_flags, memory_order_relaxed);
+}
+
+int ff_numa_node(void)
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned cpu, node;
+
+    if (!syscall(SYS_getcpu, &cpu, &node, NULL))
+        return node;
+#endif
+    return -1;
+}
+
+void *ff_large_alloc(size_t size, size_t *mapped, int *node)
+{
+#if HAVE_MMAP && defined(MAP_ANONYMOUS)
+    int flags = ff_large_alloc_flags(size);
+    void *ptr = MAP_FAILED;
+
+    *node = -1;
+    if (!(flags & (AV_MEM_LARGE_HUGETLB | AV_MEM_LARGE_NUMA)) ||
+        size > atomic_load_explicit(&max_alloc_size, memory_order_relaxed))
+        return NULL;
+
+#ifdef MAP_HUGETLB
+    if (flags & AV_MEM_LARGE_HUGETLB) {
+        *mapped = FFALIGN(size, HUGE_PAGE_SIZE);
+        ptr = mmap(NULL, *mapped, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if (ptr == MAP_FAILED) {
+        /* no huge pages reserved, or not enough of them left */
+        *mapped = size;
+        ptr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED)
+            return NULL;
+#ifdef MADV_HUGEPAGE
+        if (flags & AV_MEM_LARGE_THP)
+            madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+
+#if defined(__linux__) && defined(SYS_mbind)
+    if (flags & AV_MEM_LARGE_NUMA) {
+        int n = ff_numa_node();
+        unsigned long nodemask;
+
+        /* No page is touched yet, so they will all be allocated following
+         * the policy rather than on the node of the first thread using them. */
+        if (n >= 0 && n < sizeof(nodemask) * 8 - 1) {
+            nodemask = 1UL << n;
+            if (!syscall(SYS_mbind, ptr, *mapped, MPOL_PREFERRED,
+                         &nodemask, sizeof(nodemask) * 8, 0))
+                *node = n;
+        }
+    }
+#endif
+#if CONFIG_MEMORY_POISONING
+    memset(ptr, FF_MEMORY_POISON, size);
+#endif
+    return ptr;
+#else
+    return NULL;
+#endif
+}
+
+void ff_large_free(void *ptr, size_t mapped)
+{
+#if HAVE_MMAP && defined(MAP_ANONYMOUS)
+    if (ptr)
+        munmap(ptr, mapped);
+#endif
+}
+
 static int size_mult(size_t a, size_t b, size_t *r)
 {
     size_t t;
@@ -101,9 +210,22 @@ void *av_malloc(size_t size)
         return NULL;
 
 #if HAVE_POSIX_MEMALIGN
-    if (size) //OS X on SDK 10.6 has a broken posix_memalign implementation
-    if (posix_memalign(&ptr, ALIGN, size))
-        ptr = NULL;
+    if (size) { //OS X on SDK 10.6 has a broken posix_memalign implementation
+        size_t align = ALIGN;
+#ifdef MADV_HUGEPAGE
+        int thp = ff_large_alloc_flags(size) & AV_MEM_LARGE_THP;
+
+        /* huge pages can only back the aligned part of the block */
+        if (thp)
+            align = HUGE_PAGE_SIZE;
+#endif
+        if (posix_memalign(&ptr, align, size))
+            ptr = NULL;
+#ifdef MADV_HUGEPAGE
+        else if (thp)
+            madvise(ptr, size & ~(size_t)(HUGE_PAGE_SIZE - 1), MADV_HUGEPAGE);
+#endif
+    }
 #elif HAVE_ALIGNED_MALLOC
     ptr = _aligned_malloc(size, ALIGN);
 #elif HAVE_MEMALIGN
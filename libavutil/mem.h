@@ -689,6 +689,49 @@ int av_size_mult(size_t a, size_t b, size_t *r);
  */
 void av_max_alloc(size_t max);
 
+/**
+ * @defgroup lavu_mem_large_flags Large Allocation Flags
+ * Flags for av_mem_set_large_alloc().
+ * @{
+ */
+/**
+ * Ask for transparent huge pages for the allocated blocks.
+ */
+#define AV_MEM_LARGE_THP     (1 << 0)
+/**
+ * Map buffers on explicitly reserved huge pages, falling back to normal
+ * pages (with @ref AV_MEM_LARGE_THP if set) when none are available.
+ */
+#define AV_MEM_LARGE_HUGETLB (1 << 1)
+/**
+ * Place buffers on the NUMA node of the allocating thread. Buffer pools
+ * hand out buffers placed on the node of the calling thread if they have
+ * one available.
+ */
+#define AV_MEM_LARGE_NUMA    (1 << 2)
+/**
+ * @}
+ */
+
+/**
+ * Set how large blocks are allocated.
+ *
+ * @ref AV_MEM_LARGE_THP applies to av_malloc() and the functions built on
+ * it, the other flags to av_buffer_alloc(), av_buffer_allocz() and to the
+ * buffer pools using them, which includes the default buffers of AVFrame.
+ * The flags are hints: allocations are done normally on systems that do not
+ * support them.
+ *
+ * This function is not thread-safe with respect to allocations made
+ * concurrently; it should be called before the libraries are used.
+ *
+ * @param flags    combination of AV_MEM_LARGE_* flags, 0 (the default) to
+ *                 allocate large blocks like the others
+ * @param min_size minimum size of the blocks the flags apply to, 0 for the
+ *                 default of 2 MiB
+ */
+void av_mem_set_large_alloc(int flags, size_t min_size);
+
 /**
  * @}
  * @}
@@ -136,4 +136,29 @@
 #   define LOCAL_ALIGNED_32(t, v, ...) E1(LOCAL_ALIGNED_A(32, t, v, __VA_ARGS__,,))
 #endif
 
+/**
+ * @return the AV_MEM_LARGE_* flags applying to a block of size bytes
+ */
+int ff_large_alloc_flags(size_t size);
+
+/**
+ * Map a block following the AV_MEM_LARGE_HUGETLB and AV_MEM_LARGE_NUMA flags
+ * set with av_mem_set_large_alloc().
+ *
+ * @param[out] mapped size of the mapping, to be passed to ff_large_free()
+ * @param[out] node   NUMA node the block is placed on, -1 if none
+ * @return the block, NULL if none of these flags applies to size or on error
+ */
+void *ff_large_alloc(size_t size, size_t *mapped, int *node);
+
+/**
+ * Unmap a block allocated with ff_large_alloc().
+ */
+void ff_large_free(void *ptr, size_t mapped);
+
+/**
+ * @return the NUMA node of the CPU the calling thread runs on, -1 if unknown
+ */
+int ff_numa_node(void);
+
 #endif /* AVUTIL_MEM_INTERNAL_H */
@@ -191,3 +191,20 @@ AVRational av_gcd_q(AVRational a, AVRational b, int max_den, AVRational def)
     lcm = (a.den / gcd) * b.den;
     return lcm < max_den ? av_make_q(av_gcd(a.num, b.num), lcm) : def;
 }
+
+int av_q2ticks(int64_t *ticks, AVRational q, AVRational tick)
+{
+    int64_t num = (int64_t)q.num * tick.den;
+    int64_t den = (int64_t)q.den * tick.num;
+
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    } else if (!den) {
+        *ticks = 0;
+        return 0;
+    }
+
+    *ticks = av_rescale_rnd(num, 1, den, AV_ROUND_NEAR_INF);
+    return !(num % den);
+}
@@ -213,6 +213,20 @@ uint32_t av_q2intfloat(AVRational q);
  */
 AVRational av_gcd_q(AVRational a, AVRational b, int max_den, AVRational def);
 
+/**
+ * Convert a rational to a number of ticks of a given duration.
+ *
+ * Timestamps expressed once in a tick common to all the time bases of a
+ * timeline, e.g. as returned by av_gcd_q(), can then be added, compared and
+ * scaled as plain integers instead of going through av_reduce() each time.
+ *
+ * @param[out] ticks q / tick, rounded to the nearest integer if not exact
+ * @param q          Rational to convert
+ * @param tick       Duration of a tick, must be strictly positive
+ * @return 1 if the conversion is exact, 0 otherwise
+ */
+int av_q2ticks(int64_t *ticks, AVRational q, AVRational tick);
+
 /**
  * @}
  */
@@ -20,6 +20,7 @@
 #include "cpu.h"
 #include "internal.h"
 #include "slicethread.h"
+#include "threadpool.h"
 #include "mem.h"
 #include "thread.h"
 #include "avassert.h"
@@ -34,6 +35,18 @@ typedef struct WorkerContext {
     int             done;
 } WorkerContext;
 
+struct AVThreadPool {
+    pthread_t       *threads;
+    int             nb_threads;
+    atomic_int      refcount;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t  work_cond;      ///< signaled when an execute call is queued
+    pthread_cond_t  done_cond;      ///< signaled when the workers of an execute call are done
+    AVSliceThread   *first, *last;  ///< execute calls waiting for workers
+    int             finished;
+};
+
 struct AVSliceThread {
     WorkerContext   *workers;
     int             nb_threads;
@@ -50,13 +63,18 @@ struct AVSliceThread {
     void            *priv;
     void            (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads);
     void            (*main_func)(void *priv);
+
+    /* shared thread pool, the fields below are protected by pool->mutex */
+    AVThreadPool    *pool;
+    AVSliceThread   *prev, *next;
+    int             queued;
+    int             nb_pool_workers;
 };
 
-static int run_jobs(AVSliceThread *ctx)
+static int run_jobs_from(AVSliceThread *ctx, unsigned first_job)
 {
     unsigned nb_jobs    = ctx->nb_jobs;
     unsigned nb_active_threads = ctx->nb_active_threads;
-    unsigned first_job    = atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_acq_rel);
     unsigned current_job  = first_job;
 
     do {
@@ -66,6 +84,179 @@ static int run_jobs(AVSliceThread *ctx)
     return current_job == nb_jobs + nb_active_threads - 1;
 }
 
+static int run_jobs(AVSliceThread *ctx)
+{
+    return run_jobs_from(ctx, atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_acq_rel));
+}
+
+/**
+ * Run jobs as each of the threads that have not started yet, so that all
+ * the jobs are run even if no other thread joins.
+ */
+static void run_pool_jobs(AVSliceThread *ctx)
+{
+    unsigned first_job;
+
+    while ((first_job = atomic_fetch_add_explicit(&ctx->first_job, 1, memory_order_acq_rel)) <
+           ctx->nb_active_threads)
+        run_jobs_from(ctx, first_job);
+}
+
+static void pool_unlink(AVThreadPool *pool, AVSliceThread *ctx)
+{
+    if (ctx->prev)
+        ctx->prev->next = ctx->next;
+    else
+        pool->first = ctx->next;
+    if (ctx->next)
+        ctx->next->prev = ctx->prev;
+    else
+        pool->last = ctx->prev;
+    ctx->prev = ctx->next = NULL;
+    ctx->queued = 0;
+}
+
+static void pool_link(AVThreadPool *pool, AVSliceThread *ctx)
+{
+    ctx->prev = pool->last;
+    ctx->next = NULL;
+    if (pool->last)
+        pool->last->next = ctx;
+    else
+        pool->first = ctx;
+    pool->last  = ctx;
+    ctx->queued = 1;
+}
+
+static void *attribute_align_arg pool_worker(void *v)
+{
+    AVThreadPool *pool = v;
+
+    pthread_mutex_lock(&pool->mutex);
+    while (!pool->finished) {
+        AVSliceThread *ctx = pool->first;
+
+        if (!ctx) {
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+            continue;
+        }
+
+        /* The caller runs jobs too, so an execute call needs at most
+         * nb_active_threads - 1 workers. Until it has them, it is moved to
+         * the end of the queue so that the workers are shared between the
+         * calls running concurrently. */
+        pool_unlink(pool, ctx);
+        if (++ctx->nb_pool_workers < ctx->nb_active_threads - 1)
+            pool_link(pool, ctx);
+        pthread_mutex_unlock(&pool->mutex);
+
+        run_pool_jobs(ctx);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (!--ctx->nb_pool_workers)
+            pthread_cond_broadcast(&pool->done_cond);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    return NULL;
+}
+
+static void pool_execute(AVSliceThread *ctx)
+{
+    AVThreadPool *pool = ctx->pool;
+    int i;
+
+    if (ctx->nb_active_threads > 1) {
+        pthread_mutex_lock(&pool->mutex);
+        pool_link(pool, ctx);
+        for (i = 0; i < FFMIN(ctx->nb_active_threads - 1, pool->nb_threads); i++)
+            pthread_cond_signal(&pool->work_cond);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+
+    run_pool_jobs(ctx);
+
+    if (ctx->nb_active_threads > 1) {
+        /* Once the call is out of the queue, no other worker can join, and
+         * the jobs are all done when the workers that joined are. */
+        pthread_mutex_lock(&pool->mutex);
+        if (ctx->queued)
+            pool_unlink(pool, ctx);
+        while (ctx->nb_pool_workers)
+            pthread_cond_wait(&pool->done_cond, &pool->mutex);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static void pool_unref(AVThreadPool **ppool)
+{
+    AVThreadPool *pool = *ppool;
+    int i;
+
+    *ppool = NULL;
+    if (!pool || atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) > 1)
+        return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->finished = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (i = 0; i < pool->nb_threads; i++)
+        pthread_join(pool->threads[i], NULL);
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    av_freep(&pool->threads);
+    av_free(pool);
+}
+
+int av_thread_pool_alloc(AVThreadPool **ppool, int nb_threads)
+{
+    AVThreadPool *pool;
+    int i, ret;
+
+    *ppool = NULL;
+    av_assert0(nb_threads >= 0);
+    if (!nb_threads)
+        nb_threads = av_cpu_count();
+
+    pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return AVERROR(ENOMEM);
+    pool->threads = av_calloc(nb_threads, sizeof(*pool->threads));
+    if (!pool->threads) {
+        av_free(pool);
+        return AVERROR(ENOMEM);
+    }
+    atomic_init(&pool->refcount, 1);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (i = 0; i < nb_threads; i++) {
+        if (ret = pthread_create(&pool->threads[i], NULL, pool_worker, pool)) {
+            pool_unref(&pool);
+            return AVERROR(ret);
+        }
+        pool->nb_threads++;
+    }
+
+    *ppool = pool;
+    return 0;
+}
+
+void av_thread_pool_free(AVThreadPool **ppool)
+{
+    pool_unref(ppool);
+}
+
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool)
+{
+    return pool->nb_threads;
+}
+
 static void *attribute_align_arg thread_worker(void *v)
 {
     WorkerContext *w = v;
@@ -163,6 +354,37 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
     return nb_threads;
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads)
+{
+    AVSliceThread *ctx;
+
+    /* main_func may wait for the jobs, which is only safe with threads
+     * dedicated to them */
+    if (!pool || main_func)
+        return avpriv_slicethread_create(pctx, priv, worker_func, main_func, nb_threads);
+
+    av_assert0(nb_threads >= 0);
+    if (!nb_threads)
+        nb_threads = pool->nb_threads + 1;
+
+    *pctx = ctx = av_mallocz(sizeof(*ctx));
+    if (!ctx)
+        return AVERROR(ENOMEM);
+
+    ctx->priv        = priv;
+    ctx->worker_func = worker_func;
+    ctx->nb_threads  = nb_threads;
+    ctx->pool        = pool;
+    atomic_init(&ctx->first_job, 0);
+    atomic_init(&ctx->current_job, 0);
+    atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+
+    return nb_threads;
+}
+
 void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_main)
 {
     int nb_workers, i, is_last = 0;
@@ -172,6 +394,11 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     ctx->nb_active_threads = FFMIN(nb_jobs, ctx->nb_threads);
     atomic_store_explicit(&ctx->first_job, 0, memory_order_relaxed);
     atomic_store_explicit(&ctx->current_job, ctx->nb_active_threads, memory_order_relaxed);
+
+    if (ctx->pool) {
+        pool_execute(ctx);
+        return;
+    }
     nb_workers             = ctx->nb_active_threads;
     if (!ctx->main_func || !execute_main)
         nb_workers--;
@@ -207,6 +434,12 @@ void avpriv_slicethread_free(AVSliceThread **pctx)
         return;
 
     ctx = *pctx;
+    if (ctx->pool) {
+        pool_unref(&ctx->pool);
+        av_freep(pctx);
+        return;
+    }
+
     nb_workers = ctx->nb_threads;
     if (!ctx->main_func)
         nb_workers--;
@@ -249,9 +482,34 @@ void avpriv_slicethread_execute(AVSliceThread *ctx, int nb_jobs, int execute_mai
     av_assert0(0);
 }
 
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads)
+{
+    *pctx = NULL;
+    return AVERROR(ENOSYS);
+}
+
 void avpriv_slicethread_free(AVSliceThread **pctx)
 {
     av_assert0(!pctx || !*pctx);
 }
 
+int av_thread_pool_alloc(AVThreadPool **pool, int nb_threads)
+{
+    *pool = NULL;
+    return AVERROR(ENOSYS);
+}
+
+void av_thread_pool_free(AVThreadPool **pool)
+{
+    av_assert0(!pool || !*pool);
+}
+
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool)
+{
+    return 0;
+}
+
 #endif /* HAVE_PTHREADS || HAVE_W32THREADS || HAVE_OS32THREADS */
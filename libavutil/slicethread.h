@@ -19,6 +19,8 @@
 #ifndef AVUTIL_SLICETHREAD_H
 #define AVUTIL_SLICETHREAD_H
 
+#include "threadpool.h"
+
 typedef struct AVSliceThread AVSliceThread;
 
 /**
@@ -35,6 +37,26 @@ int avpriv_slicethread_create(AVSliceThread **pctx, void *priv,
                               void (*main_func)(void *priv),
                               int nb_threads);
 
+/**
+ * Create slice threading context running its jobs on a shared thread pool.
+ *
+ * The context has no threads of its own: the jobs are run by the caller of
+ * avpriv_slicethread_execute() and by the idle threads of the pool. As
+ * with avpriv_slicethread_create(), threadnr is unique among the jobs
+ * running concurrently and lower than the returned number of threads.
+ *
+ * @param pool thread pool, a reference is kept until the context is freed;
+ *             if NULL, or if main_func is set, this function is the same as
+ *             avpriv_slicethread_create()
+ * @param nb_threads maximal number of threads running the jobs of one
+ *                   execute call, 0 for the size of the pool plus one
+ * @see avpriv_slicethread_create() for the other parameters
+ */
+int avpriv_slicethread_create_pool(AVSliceThread **pctx, AVThreadPool *pool, void *priv,
+                                   void (*worker_func)(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads),
+                                   void (*main_func)(void *priv),
+                                   int nb_threads);
+
 /**
  * Execute slice threading.
  * @param ctx slice threading context
@@ -0,0 +1,274 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program checks AVBufferPool reuse, trimming and capping, and
+ * hammers a pool from several threads, with normal buffers and with buffers
+ * from the large allocation backend. Run it with -b [threads] [iterations]
+ * to benchmark av_buffer_pool_get() and av_buffer_unref() under contention.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+#define BUF_SIZE 64
+#define HELD     4
+
+static atomic_int nb_allocs;
+static atomic_int nb_frees;
+
+static void counting_free(void *opaque, uint8_t *data)
+{
+    atomic_fetch_add(&nb_frees, 1);
+    av_free(data);
+}
+
+static AVBufferRef *counting_alloc(void *opaque, size_t size)
+{
+    uint8_t *data = av_malloc(size);
+    AVBufferRef *ref;
+
+    if (!data)
+        return NULL;
+    ref = av_buffer_create(data, size, counting_free, NULL, 0);
+    if (!ref) {
+        av_free(data);
+        return NULL;
+    }
+    atomic_fetch_add(&nb_allocs, 1);
+    return ref;
+}
+
+static int get_bufs(AVBufferPool *pool, AVBufferRef **bufs, int nb)
+{
+    for (int i = 0; i < nb; i++) {
+        bufs[i] = av_buffer_pool_get(pool);
+        if (!bufs[i])
+            return -1;
+    }
+    return 0;
+}
+
+static void unref_bufs(AVBufferRef **bufs, int nb)
+{
+    for (int i = 0; i < nb; i++)
+        av_buffer_unref(&bufs[i]);
+}
+
+static void print_counts(const char *step)
+{
+    printf("%-12s allocs %d frees %d\n", step,
+           atomic_load(&nb_allocs), atomic_load(&nb_frees));
+}
+
+static int test_reuse(void)
+{
+    AVBufferRef *bufs[8];
+    AVBufferPool *pool = av_buffer_pool_init2(BUF_SIZE, NULL, counting_alloc, NULL);
+
+    if (!pool)
+        return -1;
+
+    if (get_bufs(pool, bufs, 8) < 0)
+        return -1;
+    unref_bufs(bufs, 8);
+    print_counts("get 8");
+
+    if (get_bufs(pool, bufs, 8) < 0)
+        return -1;
+    unref_bufs(bufs, 8);
+    print_counts("reuse 8");
+
+    av_buffer_pool_trim(pool, 3);
+    print_counts("trim 3");
+
+    av_buffer_pool_set_max_free(pool, 2);
+    print_counts("max_free 2");
+
+    if (get_bufs(pool, bufs, 6) < 0)
+        return -1;
+    unref_bufs(bufs, 6);
+    print_counts("get 6");
+
+    av_buffer_pool_set_max_free(pool, 0);
+    if (get_bufs(pool, bufs, 6) < 0)
+        return -1;
+    unref_bufs(bufs, 6);
+    print_counts("unlimited");
+
+    if (get_bufs(pool, bufs, 2) < 0)
+        return -1;
+    av_buffer_pool_uninit(&pool);
+    print_counts("uninit");
+    unref_bufs(bufs, 2);
+    print_counts("released");
+
+    return 0;
+}
+
+typedef struct ThreadArg {
+    AVBufferPool *pool;
+    _Atomic(AVBufferRef *) *mailbox;
+    int id;
+    int iterations;
+    int errors;
+} ThreadArg;
+
+static int check_owner(const AVBufferRef *buf)
+{
+    return AV_RN32(buf->data) == AV_RN32(buf->data + BUF_SIZE - 4);
+}
+
+static void *worker(void *opaque)
+{
+    ThreadArg *arg = opaque;
+    AVBufferRef *held[HELD] = { NULL };
+
+    for (int i = 0; i < arg->iterations; i++) {
+        AVBufferRef **slot = &held[i % HELD];
+        AVBufferRef *buf;
+        uint32_t tag = arg->id << 24 | (i & 0xFFFFFF);
+
+        if (*slot && !check_owner(*slot))
+            arg->errors++;
+        av_buffer_unref(slot);
+
+        buf = av_buffer_pool_get(arg->pool);
+        if (!buf) {
+            arg->errors++;
+            break;
+        }
+        /* a buffer handed out twice would get its tags mixed up */
+        AV_WN32(buf->data, tag);
+        AV_WN32(buf->data + BUF_SIZE - 4, tag);
+
+        /* let every eighth buffer be released by another thread */
+        if (!(i & 7)) {
+            buf = atomic_exchange(arg->mailbox, buf);
+            if (buf && !check_owner(buf))
+                arg->errors++;
+        }
+        *slot = buf;
+    }
+    for (int i = 0; i < HELD; i++) {
+        if (held[i] && !check_owner(held[i]))
+            arg->errors++;
+        av_buffer_unref(&held[i]);
+    }
+    return NULL;
+}
+
+static int run_threads(int nb_threads, int iterations, int64_t *elapsed)
+{
+    ThreadArg *args = av_calloc(nb_threads, sizeof(*args));
+    pthread_t *threads = av_calloc(nb_threads, sizeof(*threads));
+    _Atomic(AVBufferRef *) mailbox = NULL;
+    AVBufferPool *pool = av_buffer_pool_init(BUF_SIZE, NULL);
+    AVBufferRef *last;
+    int64_t start;
+    int i, ret = 0;
+
+    if (!args || !threads || !pool) {
+        ret = -1;
+        goto end;
+    }
+
+    start = av_gettime_relative();
+    for (i = 0; i < nb_threads; i++) {
+        args[i].pool       = pool;
+        args[i].mailbox    = &mailbox;
+        args[i].id         = i;
+        args[i].iterations = iterations;
+        if (pthread_create(&threads[i], NULL, worker, &args[i])) {
+            ret = -1;
+            break;
+        }
+    }
+    nb_threads = i;
+    for (i = 0; i < nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+        if (args[i].errors)
+            ret = -1;
+    }
+    *elapsed = av_gettime_relative() - start;
+
+    last = atomic_load(&mailbox);
+    av_buffer_unref(&last);
+
+end:
+    av_buffer_pool_uninit(&pool);
+    av_free(threads);
+    av_free(args);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int64_t elapsed;
+
+    if (argc > 1 && !strcmp(argv[1], "-b")) {
+        int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+        int iterations  = argc > 3 ? atoi(argv[3]) : 1000000;
+
+        for (int nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+            if (run_threads(nb_threads, iterations, &elapsed) < 0) {
+                fprintf(stderr, "%d threads: failed\n", nb_threads);
+                return 1;
+            }
+            printf("%2d threads: %8.2f ns per get/unref, %6.2f M ops/s\n",
+                   nb_threads, elapsed * 1000.0 / iterations,
+                   nb_threads * (double)iterations / FFMAX(elapsed, 1));
+        }
+        return 0;
+    }
+
+    if (test_reuse() < 0) {
+        fprintf(stderr, "reuse test failed\n");
+        return 1;
+    }
+
+    for (int nb_threads = 1; nb_threads <= 8; nb_threads *= 2) {
+        if (run_threads(nb_threads, 20000, &elapsed) < 0) {
+            fprintf(stderr, "%d threads: failed\n", nb_threads);
+            return 1;
+        }
+        printf("%d threads: ok\n", nb_threads);
+    }
+
+    /* the same with the buffers mapped by the large allocation backend */
+    av_mem_set_large_alloc(AV_MEM_LARGE_THP | AV_MEM_LARGE_NUMA, BUF_SIZE);
+    for (int nb_threads = 1; nb_threads <= 8; nb_threads *= 2) {
+        if (run_threads(nb_threads, 20000, &elapsed) < 0) {
+            fprintf(stderr, "%d threads, large: failed\n", nb_threads);
+            return 1;
+        }
+        printf("%d threads, large: ok\n", nb_threads);
+    }
+    av_mem_set_large_alloc(0, 0);
+
+    return 0;
+}
@@ -21,16 +21,77 @@
 
 #include "libavutil/rational.c"
 #include "libavutil/integer.h"
+#include "libavutil/time.h"
 
-int main(void)
+/**
+ * Advance the timestamps of a timeline of resources of 24000/1001 edit units
+ * by packets of 2002 samples at 48 kHz, once with rationals and once with
+ * ticks of the common time base, and check both reach the same end.
+ *
+ * @return the number of resources crossed, or -1 if the timelines differ
+ */
+static int64_t run_timeline(int nb_packets, int64_t *elapsed_q, int64_t *elapsed_ticks)
+{
+    AVRational edit_unit = { 1001, 24000 }, time_base = { 1, 48000 };
+    AVRational tick = av_gcd_q(edit_unit, time_base, INT_MAX, av_make_q(0, 1));
+    AVRational cur_q = { 0, 1 }, end_q = { 0, 1 };
+    int64_t cur = 0, end = 0, edit_unit_ticks, tb_ticks, start;
+    int64_t resources_q = 0, resources = 0, cur_q_ticks, end_q_ticks;
+    int i;
+
+    av_q2ticks(&edit_unit_ticks, edit_unit, tick);
+    av_q2ticks(&tb_ticks, time_base, tick);
+
+    start = av_gettime_relative();
+    for (i = 0; i < nb_packets; i++) {
+        cur_q = av_add_q(cur_q, av_mul_q(av_make_q(2002, 1), time_base));
+        if (av_cmp_q(cur_q, end_q) > 0) {
+            end_q = av_add_q(end_q, av_mul_q(av_make_q(240, 1), edit_unit));
+            resources_q++;
+        }
+    }
+    *elapsed_q = av_gettime_relative() - start;
+
+    start = av_gettime_relative();
+    for (i = 0; i < nb_packets; i++) {
+        cur += 2002 * tb_ticks;
+        if (cur > end) {
+            end += 240 * edit_unit_ticks;
+            resources++;
+        }
+    }
+    *elapsed_ticks = av_gettime_relative() - start;
+
+    if (resources != resources_q ||
+        !av_q2ticks(&cur_q_ticks, cur_q, tick) || cur_q_ticks != cur ||
+        !av_q2ticks(&end_q_ticks, end_q, tick) || end_q_ticks != end)
+        return -1;
+    return resources;
+}
+
+int main(int argc, char **argv)
 {
     AVRational a,b,r;
+    int64_t elapsed_q, elapsed_ticks, t;
     int i,j,k;
+
     static const int64_t numlist[] = {
         INT64_MIN, INT64_MIN+1, INT64_MAX, INT32_MIN, INT32_MAX, 1,0,-1,
         123456789, INT32_MAX-1, INT32_MAX+1LL, UINT32_MAX-1, UINT32_MAX, UINT32_MAX+1LL
     };
 
+    if (argc > 1 && !strcmp(argv[1], "-b")) {
+        int nb_packets = argc > 2 ? atoi(argv[2]) : 100000;
+
+        if (run_timeline(nb_packets, &elapsed_q, &elapsed_ticks) < 0) {
+            fprintf(stderr, "timelines differ\n");
+            return 1;
+        }
+        printf("rationals: %8.2f ns per packet\n", elapsed_q     * 1000.0 / nb_packets);
+        printf("ticks:     %8.2f ns per packet\n", elapsed_ticks * 1000.0 / nb_packets);
+        return 0;
+    }
+
     for (a.num = -2; a.num <= 2; a.num++) {
         for (a.den = -2; a.den <= 2; a.den++) {
             for (b.num = -2; b.num <= 2; b.num++) {
@@ -130,5 +191,31 @@ int main(void)
         }
     }
 
+    for (a.num = -10; a.num <= 10; a.num++) {
+        for (a.den = -10; a.den <= 10; a.den++) {
+            for (b.num = 1; b.num <= 10; b.num++) {
+                for (b.den = 1; b.den <= 10; b.den++) {
+                    int exact = av_q2ticks(&t, a, b);
+                    int64_t num = (int64_t)a.num * b.den, den = (int64_t)a.den * b.num;
+
+                    if (!a.den) {
+                        if (exact || t)
+                            av_log(NULL, AV_LOG_ERROR, "%d/%d %d/%d, %"PRId64" %d\n",
+                                   a.num, a.den, b.num, b.den, t, exact);
+                        continue;
+                    }
+                    if (exact != !(num % den) || t != llround(num / (double)den))
+                        av_log(NULL, AV_LOG_ERROR, "%d/%d %d/%d, %"PRId64" %d\n",
+                               a.num, a.den, b.num, b.den, t, exact);
+                }
+            }
+        }
+    }
+
+    if (run_timeline(10000, &elapsed_q, &elapsed_ticks) < 0) {
+        av_log(NULL, AV_LOG_ERROR, "timelines differ\n");
+        return 1;
+    }
+
     return 0;
 }
@@ -0,0 +1,176 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program runs slice threading contexts attached to one thread
+ * pool from several threads at once, and from the jobs of another context,
+ * and checks that every job runs once, with a thread number that no other
+ * job running concurrently has.
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "libavutil/mem.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
+#include "libavutil/threadpool.h"
+
+#define MAX_JOBS    32
+#define MAX_THREADS 16
+#define ITERATIONS  300
+
+typedef struct SliceContext {
+    AVSliceThread *thread;
+    int nb_threads;
+    atomic_int runs[MAX_JOBS];
+    atomic_int busy[MAX_THREADS];
+    atomic_int errors;
+    /* contexts run from each thread of this one, for the nested test */
+    struct SliceContext *inner[MAX_THREADS];
+} SliceContext;
+
+static int execute(SliceContext *s, int nb_jobs);
+
+static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    SliceContext *s = priv;
+
+    if (threadnr < 0 || threadnr >= FFMIN(nb_jobs, s->nb_threads) ||
+        nb_threads != FFMIN(nb_jobs, s->nb_threads) ||
+        atomic_exchange(&s->busy[threadnr], 1)) {
+        atomic_fetch_add(&s->errors, 1);
+        return;
+    }
+    atomic_fetch_add(&s->runs[jobnr], 1);
+    if (s->inner[threadnr] && execute(s->inner[threadnr], 1 + jobnr % 7) < 0)
+        atomic_fetch_add(&s->errors, 1);
+    atomic_store(&s->busy[threadnr], 0);
+}
+
+static int execute(SliceContext *s, int nb_jobs)
+{
+    int ret = 0;
+
+    avpriv_slicethread_execute(s->thread, nb_jobs, 0);
+    for (int i = 0; i < MAX_JOBS; i++) {
+        if (atomic_load(&s->runs[i]) != (i < nb_jobs))
+            ret = -1;
+        atomic_store(&s->runs[i], 0);
+    }
+    return ret;
+}
+
+static SliceContext *slice_alloc(AVThreadPool *pool, int nb_threads)
+{
+    SliceContext *s = av_mallocz(sizeof(*s));
+
+    if (!s)
+        return NULL;
+    s->nb_threads = avpriv_slicethread_create_pool(&s->thread, pool, s, worker_func,
+                                                   NULL, nb_threads);
+    if (s->nb_threads != nb_threads) {
+        avpriv_slicethread_free(&s->thread);
+        av_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+static void slice_free(SliceContext **ps)
+{
+    SliceContext *s = *ps;
+
+    if (!s)
+        return;
+    for (int i = 0; i < MAX_THREADS; i++)
+        slice_free(&s->inner[i]);
+    avpriv_slicethread_free(&s->thread);
+    av_freep(ps);
+}
+
+static void *caller(void *arg)
+{
+    SliceContext *s = arg;
+
+    for (int i = 0; i < ITERATIONS; i++)
+        if (execute(s, 1 + (i * 7 + s->nb_threads) % MAX_JOBS) < 0)
+            atomic_fetch_add(&s->errors, 1);
+    return NULL;
+}
+
+static int test_shared(int nb_callers, int nested)
+{
+    static const int nb_threads[] = { 2, 5, 8, 16 };
+    SliceContext *s[4] = { NULL };
+    pthread_t threads[4];
+    AVThreadPool *pool;
+    int i, j, errors = 0;
+
+    if (av_thread_pool_alloc(&pool, 4) < 0)
+        return -1;
+
+    for (i = 0; i < nb_callers; i++) {
+        if (!(s[i] = slice_alloc(pool, nb_threads[i])))
+            goto fail;
+        for (j = 0; nested && j < s[i]->nb_threads; j++)
+            if (!(s[i]->inner[j] = slice_alloc(pool, 3)))
+                goto fail;
+    }
+    /* the contexts keep the pool alive */
+    av_thread_pool_free(&pool);
+
+    for (i = 0; i < nb_callers; i++)
+        if (pthread_create(&threads[i], NULL, caller, s[i]))
+            goto fail;
+    for (i = 0; i < nb_callers; i++) {
+        pthread_join(threads[i], NULL);
+        errors += atomic_load(&s[i]->errors);
+        for (j = 0; j < MAX_THREADS; j++)
+            if (s[i]->inner[j])
+                errors += atomic_load(&s[i]->inner[j]->errors);
+    }
+
+    for (i = 0; i < nb_callers; i++)
+        slice_free(&s[i]);
+    return errors ? -1 : 0;
+
+fail:
+    for (i = 0; i < nb_callers; i++)
+        slice_free(&s[i]);
+    av_thread_pool_free(&pool);
+    return -1;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    for (int nb_callers = 1; nb_callers <= 4; nb_callers *= 2) {
+        int err = test_shared(nb_callers, 0);
+        printf("%d callers: %s\n", nb_callers, err < 0 ? "failed" : "ok");
+        ret |= err;
+    }
+    for (int nb_callers = 1; nb_callers <= 4; nb_callers *= 2) {
+        int err = test_shared(nb_callers, 1);
+        printf("%d callers, nested: %s\n", nb_callers, err < 0 ? "failed" : "ok");
+        ret |= err;
+    }
+
+    return !!ret;
+}
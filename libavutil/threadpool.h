@@ -0,0 +1,62 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Thread pool shared by the slice threading of several contexts.
+ */
+
+#ifndef AVUTIL_THREADPOOL_H
+#define AVUTIL_THREADPOOL_H
+
+/**
+ * A pool of worker threads running the slice threading jobs of all the
+ * codec contexts, filter graphs and scaling contexts it is attached to,
+ * instead of each of them creating its own threads.
+ *
+ * The caller of a slice threading operation runs its jobs too, and the idle
+ * workers of the pool join in, so an operation always progresses even when
+ * all the workers are busy with other contexts.
+ *
+ * Contexts using the pool keep their own reference to it, so the pool can be
+ * freed by the user as soon as it has been attached to all the contexts;
+ * the threads exit when the last context using the pool is freed.
+ */
+typedef struct AVThreadPool AVThreadPool;
+
+/**
+ * Allocate a thread pool and start its threads.
+ *
+ * @param pool       pointer to the thread pool
+ * @param nb_threads number of worker threads, 0 for one per CPU
+ * @return  >=0 for success; <0 for error, in particular AVERROR(ENOSYS) if
+ *          lavu was built without thread support
+ */
+int av_thread_pool_alloc(AVThreadPool **pool, int nb_threads);
+
+/**
+ * Release the reference of the user to a thread pool and set *pool to NULL.
+ */
+void av_thread_pool_free(AVThreadPool **pool);
+
+/**
+ * @return the number of worker threads of the pool
+ */
+int av_thread_pool_get_nb_threads(const AVThreadPool *pool);
+
+#endif /* AVUTIL_THREADPOOL_H */
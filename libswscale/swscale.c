@@ -629,116 +629,95 @@ static int check_image_pointers(const uint8_t * const data[4], enum AVPixelForma
     return 1;
 }
 
-static void xyz12Torgb48(struct SwsContext *c, uint16_t *dst,
-                         const uint16_t *src, int stride, int h)
-{
-    int xp,yp;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
-
-    for (yp=0; yp<h; yp++) {
-        for (xp=0; xp+2<stride; xp+=3) {
-            int x, y, z, r, g, b;
-
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                x = AV_RB16(src + xp + 0);
-                y = AV_RB16(src + xp + 1);
-                z = AV_RB16(src + xp + 2);
-            } else {
-                x = AV_RL16(src + xp + 0);
-                y = AV_RL16(src + xp + 1);
-                z = AV_RL16(src + xp + 2);
-            }
-
-            x = c->xyzgamma[x>>4];
-            y = c->xyzgamma[y>>4];
-            z = c->xyzgamma[z>>4];
-
-            // convert from XYZlinear to sRGBlinear
-            r = c->xyz2rgb_matrix[0][0] * x +
-                c->xyz2rgb_matrix[0][1] * y +
-                c->xyz2rgb_matrix[0][2] * z >> 12;
-            g = c->xyz2rgb_matrix[1][0] * x +
-                c->xyz2rgb_matrix[1][1] * y +
-                c->xyz2rgb_matrix[1][2] * z >> 12;
-            b = c->xyz2rgb_matrix[2][0] * x +
-                c->xyz2rgb_matrix[2][1] * y +
-                c->xyz2rgb_matrix[2][2] * z >> 12;
-
-            // limit values to 12-bit depth
-            r = av_clip_uintp2(r, 12);
-            g = av_clip_uintp2(g, 12);
-            b = av_clip_uintp2(b, 12);
-
-            // convert from sRGBlinear to RGB and scale from 12bit to 16bit
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                AV_WB16(dst + xp + 0, c->rgbgamma[r] << 4);
-                AV_WB16(dst + xp + 1, c->rgbgamma[g] << 4);
-                AV_WB16(dst + xp + 2, c->rgbgamma[b] << 4);
-            } else {
-                AV_WL16(dst + xp + 0, c->rgbgamma[r] << 4);
-                AV_WL16(dst + xp + 1, c->rgbgamma[g] << 4);
-                AV_WL16(dst + xp + 2, c->rgbgamma[b] << 4);
-            }
-        }
-        src += stride;
-        dst += stride;
-    }
+#define XYZ_CONVERT_FUNCS(endian, RB16, WB16)                                  \
+static void xyz12Torgb48_ ## endian ## _c(const SwsContext *c,                 \
+                                          uint16_t *dst, ptrdiff_t dst_stride, \
+                                          const uint16_t *src,                 \
+                                          ptrdiff_t src_stride, int w, int h)  \
+{                                                                              \
+    const int16_t *xyzgamma = c->xyzgamma;                                     \
+    const int16_t *rgbgamma = c->rgbgamma;                                     \
+    const int m00 = c->xyz2rgb_matrix[0][0], m01 = c->xyz2rgb_matrix[0][1],   \
+              m02 = c->xyz2rgb_matrix[0][2], m10 = c->xyz2rgb_matrix[1][0],   \
+              m11 = c->xyz2rgb_matrix[1][1], m12 = c->xyz2rgb_matrix[1][2],   \
+              m20 = c->xyz2rgb_matrix[2][0], m21 = c->xyz2rgb_matrix[2][1],   \
+              m22 = c->xyz2rgb_matrix[2][2];                                  \
+                                                                               \
+    for (int yp = 0; yp < h; yp++) {                                           \
+        for (int xp = 0; xp < 3 * w; xp += 3) {                                \
+            int x, y, z, r, g, b;                                              \
+                                                                               \
+            x = xyzgamma[RB16(src + xp + 0) >> 4];                             \
+            y = xyzgamma[RB16(src + xp + 1) >> 4];                             \
+            z = xyzgamma[RB16(src + xp + 2) >> 4];                             \
+                                                                               \
+            /* convert from XYZlinear to sRGBlinear */                         \
+            r = m00 * x + m01 * y + m02 * z >> 12;                             \
+            g = m10 * x + m11 * y + m12 * z >> 12;                             \
+            b = m20 * x + m21 * y + m22 * z >> 12;                             \
+                                                                               \
+            /* convert from sRGBlinear to RGB and scale from 12bit to 16bit */ \
+            WB16(dst + xp + 0, rgbgamma[av_clip_uintp2(r, 12)] << 4);          \
+            WB16(dst + xp + 1, rgbgamma[av_clip_uintp2(g, 12)] << 4);          \
+            WB16(dst + xp + 2, rgbgamma[av_clip_uintp2(b, 12)] << 4);          \
+        }                                                                      \
+        src = (const uint16_t *)((const uint8_t *)src + src_stride);           \
+        dst = (uint16_t *)((uint8_t *)dst + dst_stride);                       \
+    }                                                                          \
+}                                                                              \
+                                                                               \
+static void rgb48Toxyz12_ ## endian ## _c(const SwsContext *c,                 \
+                                          uint16_t *dst, ptrdiff_t dst_stride, \
+                                          const uint16_t *src,                 \
+                                          ptrdiff_t src_stride, int w, int h)  \
+{                                                                              \
+    const int16_t *rgbgammainv = c->rgbgammainv;                               \
+    const int16_t *xyzgammainv = c->xyzgammainv;                               \
+    const int m00 = c->rgb2xyz_matrix[0][0], m01 = c->rgb2xyz_matrix[0][1],   \
+              m02 = c->rgb2xyz_matrix[0][2], m10 = c->rgb2xyz_matrix[1][0],   \
+              m11 = c->rgb2xyz_matrix[1][1], m12 = c->rgb2xyz_matrix[1][2],   \
+              m20 = c->rgb2xyz_matrix[2][0], m21 = c->rgb2xyz_matrix[2][1],   \
+              m22 = c->rgb2xyz_matrix[2][2];                                  \
+                                                                               \
+    for (int yp = 0; yp < h; yp++) {                                           \
+        for (int xp = 0; xp < 3 * w; xp += 3) {                                \
+            int x, y, z, r, g, b;                                              \
+                                                                               \
+            r = rgbgammainv[RB16(src + xp + 0) >> 4];                          \
+            g = rgbgammainv[RB16(src + xp + 1) >> 4];                          \
+            b = rgbgammainv[RB16(src + xp + 2) >> 4];                          \
+                                                                               \
+            /* convert from sRGBlinear to XYZlinear */                         \
+            x = m00 * r + m01 * g + m02 * b >> 12;                             \
+            y = m10 * r + m11 * g + m12 * b >> 12;                             \
+            z = m20 * r + m21 * g + m22 * b >> 12;                             \
+                                                                               \
+            /* convert from XYZlinear to X'Y'Z', scale from 12bit to 16bit */ \
+            WB16(dst + xp + 0, xyzgammainv[av_clip_uintp2(x, 12)] << 4);       \
+            WB16(dst + xp + 1, xyzgammainv[av_clip_uintp2(y, 12)] << 4);       \
+            WB16(dst + xp + 2, xyzgammainv[av_clip_uintp2(z, 12)] << 4);       \
+        }                                                                      \
+        src = (const uint16_t *)((const uint8_t *)src + src_stride);           \
+        dst = (uint16_t *)((uint8_t *)dst + dst_stride);                       \
+    }                                                                          \
 }
 
-static void rgb48Toxyz12(struct SwsContext *c, uint16_t *dst,
-                         const uint16_t *src, int stride, int h)
-{
-    int xp,yp;
-    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
+XYZ_CONVERT_FUNCS(le, AV_RL16, AV_WL16)
+XYZ_CONVERT_FUNCS(be, AV_RB16, AV_WB16)
 
-    for (yp=0; yp<h; yp++) {
-        for (xp=0; xp+2<stride; xp+=3) {
-            int x, y, z, r, g, b;
-
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                r = AV_RB16(src + xp + 0);
-                g = AV_RB16(src + xp + 1);
-                b = AV_RB16(src + xp + 2);
-            } else {
-                r = AV_RL16(src + xp + 0);
-                g = AV_RL16(src + xp + 1);
-                b = AV_RL16(src + xp + 2);
-            }
+av_cold void ff_sws_init_xyzdsp(SwsContext *c)
+{
+    /* the XYZ formats have been replaced by the RGB48 ones of the same
+     * endianness at this point */
+    if (isBE(c->srcFormat))
+        c->xyz12Torgb48 = xyz12Torgb48_be_c;
+    else
+        c->xyz12Torgb48 = xyz12Torgb48_le_c;
 
-            r = c->rgbgammainv[r>>4];
-            g = c->rgbgammainv[g>>4];
-            b = c->rgbgammainv[b>>4];
-
-            // convert from sRGBlinear to XYZlinear
-            x = c->rgb2xyz_matrix[0][0] * r +
-                c->rgb2xyz_matrix[0][1] * g +
-                c->rgb2xyz_matrix[0][2] * b >> 12;
-            y = c->rgb2xyz_matrix[1][0] * r +
-                c->rgb2xyz_matrix[1][1] * g +
-                c->rgb2xyz_matrix[1][2] * b >> 12;
-            z = c->rgb2xyz_matrix[2][0] * r +
-                c->rgb2xyz_matrix[2][1] * g +
-                c->rgb2xyz_matrix[2][2] * b >> 12;
-
-            // limit values to 12-bit depth
-            x = av_clip_uintp2(x, 12);
-            y = av_clip_uintp2(y, 12);
-            z = av_clip_uintp2(z, 12);
-
-            // convert from XYZlinear to X'Y'Z' and scale from 12bit to 16bit
-            if (desc->flags & AV_PIX_FMT_FLAG_BE) {
-                AV_WB16(dst + xp + 0, c->xyzgammainv[x] << 4);
-                AV_WB16(dst + xp + 1, c->xyzgammainv[y] << 4);
-                AV_WB16(dst + xp + 2, c->xyzgammainv[z] << 4);
-            } else {
-                AV_WL16(dst + xp + 0, c->xyzgammainv[x] << 4);
-                AV_WL16(dst + xp + 1, c->xyzgammainv[y] << 4);
-                AV_WL16(dst + xp + 2, c->xyzgammainv[z] << 4);
-            }
-        }
-        src += stride;
-        dst += stride;
-    }
+    if (isBE(c->dstFormat))
+        c->rgb48Toxyz12 = rgb48Toxyz12_be_c;
+    else
+        c->rgb48Toxyz12 = rgb48Toxyz12_le_c;
 }
 
 static void update_palette(SwsContext *c, const uint32_t *pal)
@@ -822,6 +801,28 @@ static int scale_internal(SwsContext *c,
                           uint8_t *const dstSlice[], const int dstStride[],
                           int dstSliceY, int dstSliceH);
 
+/* Compute the range of input lines [*y0, *y1) read to produce the output
+ * lines [dstSliceY, dstSliceY + dstSliceH) of a full input frame. */
+static void xyz_src_range(const SwsContext *c, int dstSliceY, int dstSliceH,
+                          int *y0, int *y1)
+{
+    if (c->convert_unscaled) {
+        *y0 = dstSliceY;
+        *y1 = dstSliceY + dstSliceH;
+    } else {
+        const int last    = FFMIN((dstSliceY + dstSliceH - 1) | ((1 << c->chrDstVSubSample) - 1),
+                                  c->dstH - 1);
+        const int chr0    = dstSliceY >> c->chrDstVSubSample;
+        const int chr1    = last      >> c->chrDstVSubSample;
+
+        *y0 = FFMIN(c->vLumFilterPos[dstSliceY], c->vChrFilterPos[chr0]);
+        *y1 = FFMAX(c->vLumFilterPos[last] + c->vLumFilterSize,
+                    c->vChrFilterPos[chr1] + c->vChrFilterSize);
+    }
+    *y0 = av_clip(*y0, 0, c->srcH);
+    *y1 = av_clip(*y1, *y0, c->srcH);
+}
+
 static int scale_gamma(SwsContext *c,
                        const uint8_t * const srcSlice[], const int srcStride[],
                        int srcSliceY, int srcSliceH,
@@ -977,6 +978,7 @@ static int scale_internal(SwsContext *c,
 
     if (c->srcXYZ && !(c->dstXYZ && c->srcW==c->dstW && c->srcH==c->dstH)) {
         uint8_t *base;
+        int y0 = 0, y1 = srcSliceH;
 
         av_fast_malloc(&c->xyz_scratch, &c->xyz_scratch_allocated,
                        FFABS(srcStride[0]) * srcSliceH + 32);
@@ -986,7 +988,14 @@ static int scale_internal(SwsContext *c,
         base = srcStride[0] < 0 ? c->xyz_scratch - srcStride[0] * (srcSliceH-1) :
                                   c->xyz_scratch;
 
-        xyz12Torgb48(c, (uint16_t*)base, (const uint16_t*)src2[0], srcStride[0]/2, srcSliceH);
+        /* when scaling a part of the output, e.g. from a slice thread, only
+         * convert the input lines it depends on */
+        if (scale_dst)
+            xyz_src_range(c, dstSliceY, dstSliceH, &y0, &y1);
+
+        c->xyz12Torgb48(c, (uint16_t*)(base + y0 * srcStride[0]), srcStride[0],
+                        (const uint16_t*)(src2[0] + y0 * srcStride[0]), srcStride[0],
+                        c->srcW, y1 - y0);
         src2[0] = base;
     }
 
@@ -1058,7 +1067,7 @@ static int scale_internal(SwsContext *c,
         }
 
         /* replace on the same data */
-        rgb48Toxyz12(c, dst16, dst16, dstStride2[0]/2, ret);
+        c->rgb48Toxyz12(c, dst16, dstStride2[0], dst16, dstStride2[0], c->dstW, ret);
     }
 
     /* reset slice direction at end of frame */
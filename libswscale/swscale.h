@@ -33,6 +33,7 @@
 #include "libavutil/frame.h"
 #include "libavutil/log.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/threadpool.h"
 #include "version_major.h"
 #ifndef HAVE_AV_CONFIG_H
 /* When included as part of the ffmpeg build, only include the major version
@@ -154,6 +155,15 @@ int sws_isSupportedEndiannessConversion(enum AVPixelFormat pix_fmt);
  */
 struct SwsContext *sws_alloc_context(void);
 
+/**
+ * Run the slice threads of the context on a shared thread pool instead of
+ * threads of its own, see the "threads" option.
+ *
+ * Must be called before sws_init_context(), which takes a reference to the
+ * pool when the context uses more than one thread.
+ */
+void sws_set_thread_pool(struct SwsContext *sws_context, AVThreadPool *pool);
+
 /**
  * Initialize the swscaler context sws_context.
  *
@@ -291,6 +291,21 @@ typedef void (*yuv2anyX_fn)(struct SwsContext *c, const int16_t *lumFilter,
                             const int16_t **alpSrc, uint8_t **dest,
                             int dstW, int y);
 
+/**
+ * Convert packed 12-bit X'Y'Z' to packed 16-bit RGB, or back, using the
+ * gamma tables and matrices of the context. The samples are stored in the
+ * upper 12 bits of 16-bit words of the context's endianness. The conversion
+ * may be done in place.
+ *
+ * @param dst_stride, src_stride line sizes in bytes
+ * @param w                      width in pixels
+ * @param h                      number of lines
+ */
+typedef void (*xyz_convert_fn)(const struct SwsContext *c,
+                               uint16_t *dst, ptrdiff_t dst_stride,
+                               const uint16_t *src, ptrdiff_t src_stride,
+                               int w, int h);
+
 struct SwsSlice;
 struct SwsFilterDescriptor;
 
@@ -304,6 +319,7 @@ typedef struct SwsContext {
     struct SwsContext *parent;
 
     AVSliceThread      *slicethread;
+    AVThreadPool       *thread_pool;
     struct SwsContext **slice_ctx;
     int                *slice_err;
     int              nb_slice_ctx;
@@ -549,6 +565,8 @@ typedef struct SwsContext {
     int16_t *rgbgammainv;
     int16_t xyz2rgb_matrix[3][4];
     int16_t rgb2xyz_matrix[3][4];
+    xyz_convert_fn xyz12Torgb48;
+    xyz_convert_fn rgb48Toxyz12;
 
     /* function pointers for swscale() */
     yuv2planar1_fn yuv2plane1;
@@ -953,6 +971,7 @@ void ff_get_unscaled_swscale_arm(SwsContext *c);
 void ff_get_unscaled_swscale_aarch64(SwsContext *c);
 
 void ff_sws_init_scale(SwsContext *c);
+void ff_sws_init_xyzdsp(SwsContext *c);
 
 void ff_sws_init_input_funcs(SwsContext *c);
 void ff_sws_init_output_funcs(SwsContext *c,
@@ -901,6 +901,8 @@ static void fill_xyztables(struct SwsContext *c)
     c->xyzgammainv = xyzgammainv_tab;
     c->rgbgammainv = rgbgammainv_tab;
 
+    ff_sws_init_xyzdsp(c);
+
     if (rgbgamma_tab[4095])
         return;
 
@@ -1182,6 +1184,11 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
+void sws_set_thread_pool(SwsContext *c, AVThreadPool *pool)
+{
+    c->thread_pool = pool;
+}
+
 static uint16_t * alloc_gamma_tbl(double e)
 {
     int i = 0;
@@ -1259,8 +1266,8 @@ static int context_init_threaded(SwsContext *c,
 {
     int ret;
 
-    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
-                                    ff_sws_slice_worker, NULL, c->nb_threads);
+    ret = avpriv_slicethread_create_pool(&c->slicethread, c->thread_pool, (void*)c,
+                                         ff_sws_slice_worker, NULL, c->nb_threads);
     if (ret == AVERROR(ENOSYS)) {
         c->nb_threads = 1;
         return 0;
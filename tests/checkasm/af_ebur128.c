@@ -0,0 +1,118 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+#include <string.h>
+
+#include "libavfilter/ebur128dsp.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem_internal.h"
+#include "checkasm.h"
+
+#define LEN 480
+#define CHANNELS 2
+
+#define randomize_buffer(buf, len)            \
+do {                                          \
+    int i;                                    \
+    double bmg[2], stddev = 0.3, mean = 0.0;  \
+                                              \
+    for (i = 0; i < len; i += 2) {            \
+        av_bmg_get(&checkasm_lfg, bmg);       \
+        buf[i]     = bmg[0] * stddev + mean;  \
+        buf[i + 1] = bmg[1] * stddev + mean;  \
+    }                                         \
+} while(0);
+
+static void test_filter_channel(EBUR128DSPContext *dsp, const double *src)
+{
+    LOCAL_ALIGNED_32(double, cdst, [LEN * CHANNELS]);
+    LOCAL_ALIGNED_32(double, odst, [LEN * CHANNELS]);
+    double cstate[EBUR128_STATE_SIZE] = { 0 }, ostate[EBUR128_STATE_SIZE] = { 0 };
+    double coeffs[EBUR128_NB_COEFFS];
+    int i;
+
+    declare_func(void, double *dst, ptrdiff_t dst_stride,
+                 const double *src, ptrdiff_t src_stride,
+                 int nb_samples, const double *coeffs, double *state);
+
+    ff_ebur128_filter_coeffs(coeffs, 48000);
+
+    memset(cdst, 0, LEN * CHANNELS * sizeof(*cdst));
+    memset(odst, 0, LEN * CHANNELS * sizeof(*odst));
+    /* interleaved input and output, as used by both filters */
+    call_ref(cdst + 1, CHANNELS, src + 1, CHANNELS, LEN, coeffs, cstate);
+    call_new(odst + 1, CHANNELS, src + 1, CHANNELS, LEN, coeffs, ostate);
+    if (!double_near_abs_eps_array(cdst, odst, 1e-12, LEN * CHANNELS) ||
+        !double_near_abs_eps_array(cstate, ostate, 1e-12, EBUR128_STATE_SIZE))
+        fail();
+    for (i = 0; i < LEN * CHANNELS; i += CHANNELS) {
+        if (odst[i] != 0.0) {
+            fprintf(stderr, "filter_channel wrote outside its channel\n");
+            fail();
+            break;
+        }
+    }
+
+    /* planar input, state carried over from the previous call */
+    call_ref(cdst, 1, src, 1, LEN, coeffs, cstate);
+    call_new(odst, 1, src, 1, LEN, coeffs, ostate);
+    if (!double_near_abs_eps_array(cdst, odst, 1e-12, LEN) ||
+        !double_near_abs_eps_array(cstate, ostate, 1e-12, EBUR128_STATE_SIZE))
+        fail();
+
+    bench_new(odst, CHANNELS, src, CHANNELS, LEN, coeffs, ostate);
+}
+
+static void test_find_peak(EBUR128DSPContext *dsp, const double *src)
+{
+    double cpeak, opeak;
+
+    declare_func(double, double peak, const double *src, ptrdiff_t stride,
+                 int nb_samples);
+
+    cpeak = call_ref(0.0, src + 1, CHANNELS, LEN);
+    opeak = call_new(0.0, src + 1, CHANNELS, LEN);
+    if (cpeak != opeak)
+        fail();
+
+    cpeak = call_ref(100.0, src, 1, LEN * CHANNELS - 1);
+    opeak = call_new(100.0, src, 1, LEN * CHANNELS - 1);
+    if (cpeak != opeak)
+        fail();
+
+    bench_new(0.0, src, 1, LEN * CHANNELS);
+}
+
+void checkasm_check_ebur128(void)
+{
+    LOCAL_ALIGNED_32(double, src, [LEN * CHANNELS]);
+    EBUR128DSPContext dsp = { 0 };
+
+    ff_ebur128dsp_init(&dsp);
+
+    randomize_buffer(src, LEN * CHANNELS);
+
+    if (check_func(dsp.filter_channel, "filter_channel"))
+        test_filter_channel(&dsp, src);
+    report("filter_channel");
+
+    if (check_func(dsp.find_peak, "find_peak"))
+        test_find_peak(&dsp, src);
+    report("find_peak");
+}
@@ -93,6 +93,12 @@ static const struct {
     #if CONFIG_DCA_DECODER
         { "synth_filter", checkasm_check_synth_filter },
     #endif
+    #if CONFIG_DNXHD_ENCODER
+        { "dnxhdenc", checkasm_check_dnxhdenc },
+    #endif
+    #if CONFIG_DPX_DECODER
+        { "dpxdsp", checkasm_check_dpxdsp },
+    #endif
     #if CONFIG_EXR_DECODER
         { "exrdsp", checkasm_check_exrdsp },
     #endif
@@ -138,9 +144,15 @@ static const struct {
     #if CONFIG_OPUS_DECODER
         { "opusdsp", checkasm_check_opusdsp },
     #endif
+    #if CONFIG_PCM_S24LE_DECODER
+        { "pcmdsp", checkasm_check_pcmdsp },
+    #endif
     #if CONFIG_PIXBLOCKDSP
         { "pixblockdsp", checkasm_check_pixblockdsp },
     #endif
+    #if CONFIG_PRORES_DECODER
+        { "proresdsp", checkasm_check_proresdsp },
+    #endif
     #if CONFIG_UTVIDEO_DECODER
         { "utvideodsp", checkasm_check_utvideodsp },
     #endif
@@ -167,6 +179,9 @@ static const struct {
     #if CONFIG_AFIR_FILTER
         { "af_afir", checkasm_check_afir },
     #endif
+    #if CONFIG_EBUR128_FILTER
+        { "af_ebur128", checkasm_check_ebur128 },
+    #endif
     #if CONFIG_BLEND_FILTER
         { "vf_blend", checkasm_check_blend },
     #endif
@@ -193,6 +208,7 @@ static const struct {
     { "sw_gbrp", checkasm_check_sw_gbrp },
     { "sw_rgb", checkasm_check_sw_rgb },
     { "sw_scale", checkasm_check_sw_scale },
+    { "sw_xyz", checkasm_check_sw_xyz },
 #endif
 #if CONFIG_AVUTIL
         { "fixed_dsp", checkasm_check_fixed_dsp },
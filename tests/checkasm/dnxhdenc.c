@@ -0,0 +1,84 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/dnxhdenc.h"
+#include "libavcodec/mathops.h"
+#include "libavutil/mem_internal.h"
+
+#define MAX_LEVEL 4096
+
+static void check_quantize_count(void)
+{
+    LOCAL_ALIGNED_16(int16_t, coeffs,    [64]);
+    LOCAL_ALIGNED_16(int16_t, block_ref, [64]);
+    LOCAL_ALIGNED_16(int16_t, block_new, [64]);
+    DECLARE_ALIGNED(16, int, qmat)[64];
+    uint8_t vlc_bits[MAX_LEVEL * 4];
+    uint8_t run_bits[63];
+    DNXHDEncDSPContext c;
+    int i, j;
+
+    declare_func(int, int16_t *block, const int *qmat,
+                 const uint8_t *scantable, int bias, int shift,
+                 const uint8_t *vlc_bits, const uint8_t *run_bits, int *bits);
+
+    ff_dnxhdencdsp_init(&c);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(vlc_bits); i++)
+        vlc_bits[i] = rnd() % 32;
+    for (i = 0; i < FF_ARRAY_ELEMS(run_bits); i++)
+        run_bits[i] = rnd() % 16;
+
+    for (int shift = 16; shift <= 18; shift += 2) {
+        if (!check_func(c.quantize_count, "dnxhd_quantize_count_%d", shift))
+            continue;
+        for (i = 0; i < 16; i++) {
+            int bias = shift == 16 ? rnd() & 0x7fff : 0;
+            int last_ref, last_new, bits_ref, bits_new;
+
+            for (j = 0; j < 64; j++) {
+                // keep a realistic share of zero and small coefficients
+                int range = (i & 3) ? 64 << (rnd() % 6) : MAX_LEVEL;
+                coeffs[j] = rnd() % range - range / 2;
+                if (rnd() % 3 == 0)
+                    coeffs[j] = 0;
+                qmat[j] = rnd() % (1 << shift);
+            }
+            memcpy(block_ref, coeffs, sizeof(*coeffs) * 64);
+            memcpy(block_new, coeffs, sizeof(*coeffs) * 64);
+            last_ref = call_ref(block_ref, qmat, ff_zigzag_direct, bias, shift,
+                                vlc_bits + MAX_LEVEL * 2, run_bits, &bits_ref);
+            last_new = call_new(block_new, qmat, ff_zigzag_direct, bias, shift,
+                                vlc_bits + MAX_LEVEL * 2, run_bits, &bits_new);
+            if (last_ref != last_new || bits_ref != bits_new ||
+                memcmp(block_ref, block_new, sizeof(*block_ref) * 64))
+                fail();
+        }
+        bench_new(block_new, qmat, ff_zigzag_direct, 0, shift,
+                  vlc_bits + MAX_LEVEL * 2, run_bits, &i);
+    }
+    report("quantize_count");
+}
+
+void checkasm_check_dnxhdenc(void)
+{
+    check_quantize_count();
+}
@@ -0,0 +1,110 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/dpxdsp.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define MAX_WIDTH 4096
+#define SRC_SIZE  (MAX_WIDTH * 4)
+
+#define randomize_buffers()                 \
+    do {                                    \
+        int i;                              \
+        for (i = 0; i < SRC_SIZE; i += 4)   \
+            AV_WN32A(src + i, rnd());       \
+    } while (0)
+
+static const int widths[] = { 1, 2, 3, 7, 64, 1921, MAX_WIDTH };
+
+static void check_unpack_rgb10(void)
+{
+    LOCAL_ALIGNED_32(uint8_t,  src,     [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [3 * MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [3 * MAX_WIDTH]);
+    DPXDSPContext c;
+
+    declare_func(void, uint16_t *g, uint16_t *b, uint16_t *r,
+                 const uint8_t *src, int shift, int width);
+
+    ff_dpxdsp_init(&c);
+    for (int be = 0; be < 2; be++) {
+        for (int shift = 20; shift <= 22; shift += 2) {
+            if (!check_func(c.unpack_rgb10[be], "dpx_unpack_rgb10_%s_%s",
+                            be ? "be" : "le", shift == 22 ? "a" : "b"))
+                continue;
+            for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i];
+
+                randomize_buffers();
+                memset(dst_ref, 0, 3 * MAX_WIDTH * sizeof(*dst_ref));
+                memset(dst_new, 0, 3 * MAX_WIDTH * sizeof(*dst_new));
+                call_ref(dst_ref, dst_ref + MAX_WIDTH, dst_ref + 2 * MAX_WIDTH,
+                         src, shift, w);
+                call_new(dst_new, dst_new + MAX_WIDTH, dst_new + 2 * MAX_WIDTH,
+                         src, shift, w);
+                if (memcmp(dst_ref, dst_new, 3 * MAX_WIDTH * sizeof(*dst_ref)))
+                    fail();
+            }
+            bench_new(dst_new, dst_new + MAX_WIDTH, dst_new + 2 * MAX_WIDTH,
+                      src, shift, MAX_WIDTH);
+        }
+    }
+    report("unpack_rgb10");
+}
+
+static void check_unpack_gray10(void)
+{
+    LOCAL_ALIGNED_32(uint8_t,  src,     [SRC_SIZE]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [MAX_WIDTH]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [MAX_WIDTH]);
+    DPXDSPContext c;
+
+    declare_func(void, uint16_t *dst, const uint8_t *src, int shift, int width);
+
+    ff_dpxdsp_init(&c);
+    for (int be = 0; be < 2; be++) {
+        for (int shift = 0; shift <= 2; shift += 2) {
+            if (!check_func(c.unpack_gray10[be], "dpx_unpack_gray10_%s_%s",
+                            be ? "be" : "le", shift == 2 ? "a" : "b"))
+                continue;
+            for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+                int w = widths[i];
+
+                randomize_buffers();
+                memset(dst_ref, 0, MAX_WIDTH * sizeof(*dst_ref));
+                memset(dst_new, 0, MAX_WIDTH * sizeof(*dst_new));
+                call_ref(dst_ref, src, shift, w);
+                call_new(dst_new, src, shift, w);
+                if (memcmp(dst_ref, dst_new, MAX_WIDTH * sizeof(*dst_ref)))
+                    fail();
+            }
+            bench_new(dst_new, src, shift, MAX_WIDTH);
+        }
+    }
+    report("unpack_gray10");
+}
+
+void checkasm_check_dpxdsp(void)
+{
+    check_unpack_rgb10();
+    check_unpack_gray10();
+}
@@ -23,7 +23,9 @@
 #include "checkasm.h"
 #include "libavcodec/avcodec.h"
 #include "libavcodec/exrdsp.h"
+#include "libavcodec/half2float.h"
 #include "libavutil/intreadwrite.h"
+#include "libavutil/mem.h"
 #include "libavutil/mem_internal.h"
 
 #define BUF_SIZE 5120
@@ -74,6 +76,50 @@ static void check_predictor(void) {
     bench_new(dst_new, BUF_SIZE);
 }
 
+static void check_half2float(void) {
+    /* too large for the stack */
+    uint8_t  *src     = av_malloc(65536 * 2);
+    uint32_t *dst_ref = av_malloc(65536 * sizeof(*dst_ref));
+    uint32_t *dst_new = av_malloc(65536 * sizeof(*dst_new));
+    uint32_t mantissatable[2048];
+    uint32_t exponenttable[64];
+    uint16_t offsettable[64];
+    int i;
+
+    declare_func(void, uint32_t *dst, const uint8_t *src, ptrdiff_t len);
+
+    if (!src || !dst_ref || !dst_new) {
+        fail();
+        goto end;
+    }
+
+    half2float_table(mantissatable, exponenttable, offsettable);
+
+    /* every half value, checked against the table based conversion */
+    for (i = 0; i < 65536; i++) {
+        AV_WL16(src + 2 * i, i);
+        dst_ref[i] = half2float(i, mantissatable, exponenttable, offsettable);
+    }
+    memset(dst_new, 0, 65536 * sizeof(*dst_new));
+    call_new(dst_new, src, 65536);
+    if (memcmp(dst_ref, dst_new, 65536 * sizeof(*dst_new)))
+        fail();
+
+    /* odd length and unaligned source */
+    memset(dst_ref, 0, BUF_SIZE * sizeof(*dst_ref));
+    memset(dst_new, 0, BUF_SIZE * sizeof(*dst_new));
+    call_ref(dst_ref, src + 1, BUF_SIZE - 3);
+    call_new(dst_new, src + 1, BUF_SIZE - 3);
+    if (memcmp(dst_ref, dst_new, BUF_SIZE * sizeof(*dst_new)))
+        fail();
+    bench_new(dst_new, src, BUF_SIZE);
+
+end:
+    av_free(src);
+    av_free(dst_ref);
+    av_free(dst_new);
+}
+
 void checkasm_check_exrdsp(void)
 {
     ExrDSPContext h;
@@ -89,4 +135,9 @@ void checkasm_check_exrdsp(void)
         check_predictor();
 
     report("predictor");
+
+    if (check_func(h.half2float, "half2float"))
+        check_half2float();
+
+    report("half2float");
 }
@@ -0,0 +1,108 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/pcmdsp.h"
+#include "libavutil/mem_internal.h"
+
+#define BUF_SIZE 1024
+#define MAX_CHANNELS 16
+#define SRC_SIZE (BUF_SIZE * MAX_CHANNELS * 3 + 16)
+
+#define randomize_buffers()                 \
+    do {                                    \
+        int i;                              \
+        for (i = 0; i < SRC_SIZE; i++)      \
+            src[i] = rnd();                 \
+    } while (0)
+
+static void check_s24le_to_s32(void)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [SRC_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst_new, [BUF_SIZE]);
+    PCMDSPContext c;
+
+    ff_pcmdsp_init(&c);
+    if (check_func(c.s24le_to_s32, "s24le_to_s32")) {
+        int len = (rnd() % BUF_SIZE) + 1;
+        declare_func(void, int32_t *dst, const uint8_t *src, int len);
+
+        randomize_buffers();
+        memset(dst_ref, 0, BUF_SIZE * sizeof(*dst_ref));
+        memset(dst_new, 0, BUF_SIZE * sizeof(*dst_new));
+        call_ref(dst_ref, src, len);
+        call_new(dst_new, src, len);
+        if (memcmp(dst_ref, dst_new, BUF_SIZE * sizeof(*dst_ref)))
+            fail();
+        bench_new(dst_new, src, BUF_SIZE);
+    }
+    report("s24le_to_s32");
+}
+
+static void check_s24le_deinterleave(void)
+{
+    static const int channels[] = { 1, 2, 6, 16 };
+    LOCAL_ALIGNED_32(uint8_t, src,     [SRC_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst_ref, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(int32_t, dst_new, [BUF_SIZE]);
+    PCMDSPContext c;
+    int i;
+
+    ff_pcmdsp_init(&c);
+    for (i = 0; i < FF_ARRAY_ELEMS(channels); i++) {
+        int ch = channels[i];
+        int len = (rnd() % BUF_SIZE) + 1;
+        int off = 3 * (rnd() % ch);
+
+        randomize_buffers();
+        if (check_func(c.s24le_to_s32p, "s24le_to_s32p_%dch", ch)) {
+            declare_func(void, int32_t *dst, const uint8_t *src,
+                         ptrdiff_t stride, int len);
+
+            memset(dst_ref, 0, BUF_SIZE * sizeof(*dst_ref));
+            memset(dst_new, 0, BUF_SIZE * sizeof(*dst_new));
+            call_ref(dst_ref, src + off, 3 * ch, len);
+            call_new(dst_new, src + off, 3 * ch, len);
+            if (memcmp(dst_ref, dst_new, BUF_SIZE * sizeof(*dst_ref)))
+                fail();
+            bench_new(dst_new, src, 3 * ch, BUF_SIZE);
+        }
+        if (check_func(c.s24le_to_fltp, "s24le_to_fltp_%dch", ch)) {
+            declare_func(void, float *dst, const uint8_t *src,
+                         ptrdiff_t stride, int len);
+
+            memset(dst_ref, 0, BUF_SIZE * sizeof(*dst_ref));
+            memset(dst_new, 0, BUF_SIZE * sizeof(*dst_new));
+            call_ref((float *)dst_ref, src + off, 3 * ch, len);
+            call_new((float *)dst_new, src + off, 3 * ch, len);
+            if (!float_near_ulp_array((float *)dst_ref, (float *)dst_new, 1, BUF_SIZE))
+                fail();
+            bench_new((float *)dst_new, src, 3 * ch, BUF_SIZE);
+        }
+    }
+    report("s24le_deinterleave");
+}
+
+void checkasm_check_pcmdsp(void)
+{
+    check_s24le_to_s32();
+    check_s24le_deinterleave();
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "checkasm.h"
+#include "libavcodec/avcodec.h"
+#include "libavcodec/proresdsp.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  (16 * 8)
+#define HEIGHT 16
+#define STRIDE (WIDTH + 32)
+
+static void check_put_alpha(const ProresDSPContext *h, int bits, int num_bits)
+{
+    LOCAL_ALIGNED_32(uint16_t, src,     [WIDTH * HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst_ref, [STRIDE * HEIGHT]);
+    LOCAL_ALIGNED_32(uint16_t, dst_new, [STRIDE * HEIGHT]);
+    const int mask = (1 << num_bits) - 1;
+
+    declare_func(void, uint16_t *dst, ptrdiff_t linesize, const uint16_t *src,
+                 int width, int height);
+
+    if (!check_func(h->put_alpha[num_bits == 16], "prores_put_alpha_%d_%d",
+                    num_bits, bits))
+        return;
+
+    for (int i = 0; i < WIDTH * HEIGHT; i++)
+        src[i] = rnd() & mask;
+    src[0] = 0;
+    src[1] = mask;
+    memset(dst_ref, 0, STRIDE * HEIGHT * sizeof(*dst_ref));
+    memset(dst_new, 0, STRIDE * HEIGHT * sizeof(*dst_new));
+
+    /* the smallest slice is one macroblock wide */
+    for (int w = 16; w <= WIDTH; w += 16) {
+        call_ref(dst_ref, STRIDE * 2, src, w, HEIGHT);
+        call_new(dst_new, STRIDE * 2, src, w, HEIGHT);
+        if (memcmp(dst_ref, dst_new, STRIDE * HEIGHT * sizeof(*dst_new)))
+            fail();
+    }
+    bench_new(dst_new, STRIDE * 2, src, WIDTH, HEIGHT);
+}
+
+void checkasm_check_proresdsp(void)
+{
+    static const int bits[] = { 10, 12 };
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(bits); i++) {
+        AVCodecContext avctx = { .bits_per_raw_sample = bits[i] };
+        ProresDSPContext h;
+
+        if (ff_proresdsp_init(&h, &avctx) < 0) {
+            fail();
+            return;
+        }
+
+        check_put_alpha(&h, bits[i], 8);
+        check_put_alpha(&h, bits[i], 16);
+    }
+    report("put_alpha");
+}
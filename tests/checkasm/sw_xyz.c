@@ -0,0 +1,98 @@
+/*
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
+
+#include "checkasm.h"
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        for (j = 0; j < size; j+=4)       \
+            AV_WN32(buf + j, rnd());      \
+    } while (0)
+
+#define MAX_WIDTH  512
+#define HEIGHT     4
+#define STRIDE     (MAX_WIDTH * 6 + 64)
+#define BUF_SIZE   (STRIDE * HEIGHT)
+
+static const int widths[] = { 1, 7, 16, 33, 128, 511, MAX_WIDTH };
+
+static void check_xyz_convert(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                              int to_rgb)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,  [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [BUF_SIZE]);
+    const char *name = av_get_pix_fmt_name(to_rgb ? src_fmt : dst_fmt);
+    struct SwsContext *ctx;
+    xyz_convert_fn func;
+
+    declare_func(void, const struct SwsContext *c,
+                 uint16_t *dst, ptrdiff_t dst_stride,
+                 const uint16_t *src, ptrdiff_t src_stride, int w, int h);
+
+    ctx = sws_getContext(MAX_WIDTH, HEIGHT, src_fmt, MAX_WIDTH, HEIGHT, dst_fmt,
+                         SWS_POINT, NULL, NULL, NULL);
+    if (!ctx) {
+        fail();
+        return;
+    }
+    ff_sws_init_xyzdsp(ctx);
+    func = to_rgb ? ctx->xyz12Torgb48 : ctx->rgb48Toxyz12;
+
+    if (check_func(func, "%s_%s", to_rgb ? "xyz12Torgb48" : "rgb48Toxyz12", name)) {
+        for (int i = 0; i < FF_ARRAY_ELEMS(widths); i++) {
+            randomize_buffers(src, BUF_SIZE);
+            memset(dst0, 0xFF, BUF_SIZE);
+            memset(dst1, 0xFF, BUF_SIZE);
+
+            call_ref(ctx, (uint16_t *)dst0, STRIDE, (const uint16_t *)src, STRIDE,
+                     widths[i], HEIGHT);
+            call_new(ctx, (uint16_t *)dst1, STRIDE, (const uint16_t *)src, STRIDE,
+                     widths[i], HEIGHT);
+            if (memcmp(dst0, dst1, BUF_SIZE))
+                fail();
+        }
+        bench_new(ctx, (uint16_t *)dst1, STRIDE, (const uint16_t *)src, STRIDE,
+                  MAX_WIDTH, HEIGHT);
+    }
+
+    sws_freeContext(ctx);
+}
+
+void checkasm_check_sw_xyz(void)
+{
+    check_xyz_convert(AV_PIX_FMT_XYZ12LE, AV_PIX_FMT_RGB48LE, 1);
+    check_xyz_convert(AV_PIX_FMT_XYZ12BE, AV_PIX_FMT_RGB48BE, 1);
+    report("xyz12Torgb48");
+
+    check_xyz_convert(AV_PIX_FMT_RGB48LE, AV_PIX_FMT_XYZ12LE, 0);
+    check_xyz_convert(AV_PIX_FMT_RGB48BE, AV_PIX_FMT_XYZ12BE, 0);
+    report("rgb48Toxyz12");
+}
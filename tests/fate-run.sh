@@ -511,6 +511,23 @@ concat(){
     fi
 }
 
+imf(){
+    cpl=$1
+    assetmap=$2
+    extra_args=$3
+
+    mxffile="${outdir}/${test}.mxf"
+    cplfile="${outdir}/${test}-CPL.xml"
+    assetmapfile="${outdir}/${test}-ASSETMAP.xml"
+    cleanfiles="$mxffile $cplfile $assetmapfile"
+
+    ffmpeg -auto_conversion_filters -f s16le -ar 44100 -ac 2 -i $pcm_src -ar 48000 -ac 1 -c:a pcm_s24le -t 1 -bitexact -f mxf_opatom -y $(target_path $mxffile) || return
+    cp $cpl $cplfile
+    awk "{gsub(/%SRCFILE%/, \"${test}.mxf\"); print}" $assetmap > $assetmapfile
+
+    framecrc -f imf -assetmaps $(target_path $assetmapfile) $extra_args -i $(target_path $cplfile) -c copy
+}
+
 venc_data(){
     file=$1
     stream=$2
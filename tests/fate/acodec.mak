@@ -30,6 +30,9 @@ FATE_ACODEC_PCM-$(call ENCDEC, PCM_S16LE_PLANAR, NUT) += s16le_planar
 FATE_ACODEC_PCM-$(call ENCDEC, PCM_S24LE_PLANAR, NUT) += s24le_planar
 FATE_ACODEC_PCM-$(call ENCDEC, PCM_S32LE_PLANAR, NUT) += s32le_planar
 
+# planar output of the pcm_s24le decoder, must match the pcm-s24le decode
+FATE_ACODEC_PCM-$(call ENCDEC, PCM_S24LE, WAV) += s24le-s32p s24le-fltp
+
 FATE_ACODEC_PCM := $(FATE_ACODEC_PCM-yes:%=fate-acodec-pcm-%)
 FATE_ACODEC += $(FATE_ACODEC_PCM)
 fate-acodec-pcm: $(FATE_ACODEC_PCM)
@@ -43,6 +46,7 @@ fate-acodec-pcm-s%be: FMT = mov
 fate-acodec-pcm-u%be: FMT = nut
 fate-acodec-pcm-u%le: FMT = nut
 fate-acodec-pcm-f%be: FMT = au
+fate-acodec-pcm-s24le-%: CMD = enc_dec wav $(SRC) wav "-c pcm_s24le" wav "-c pcm_s16le" "" "-request_sample_fmt $(@:fate-acodec-pcm-s24le-%=%)"
 
 FATE_ACODEC_ADPCM-$(call ENCDEC, ADPCM_ADX,     ADX)      += adx
 FATE_ACODEC_ADPCM-$(call ENCDEC, ADPCM_ARGO,    ARGO_ASF) += argo
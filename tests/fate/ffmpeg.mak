@@ -41,6 +41,54 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -auto_conversion_filters -idct simpl
 FATE_FFMPEG-$(CONFIG_COLOR_FILTER) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+# chunk workers must not change the output, so the reference is shared
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SCALE_FILTER FORMAT_FILTER \
+                           RAWVIDEO_DECODER JPEG2000_ENCODER FRAMEMD5_MUXER) \
+                           += fate-ffmpeg-chunk-workers
+fate-ffmpeg-chunk-workers: CMD = framemd5 -f lavfi -i testsrc=s=352x288:r=25:d=0.4 -sws_flags +accurate_rnd+bitexact -vf scale,format=yuv444p -c:v jpeg2000 -tile_width 128 -tile_height 128 -threads 1 -chunk_workers 3
+fate-ffmpeg-chunk-workers: REF = $(SRC_PATH)/tests/ref/fate/enc-threads-jpeg2000
+
+# filters that keep state between frames or do not output one frame per input
+# frame must make chunk workers fall back to the regular path
+FATE_CHUNK_FALLBACK-$(CONFIG_FADE_FILTER)   += fade
+FATE_CHUNK_FALLBACK-$(CONFIG_TMIX_FILTER)   += tmix
+FATE_CHUNK_FALLBACK-$(CONFIG_SETPTS_FILTER) += setpts
+
+fate-ffmpeg-chunk-workers%-fade:   CHUNK_VF = fade=in:0:5
+fate-ffmpeg-chunk-workers%-tmix:   CHUNK_VF = tmix=frames=3
+fate-ffmpeg-chunk-workers%-setpts: CHUNK_VF = setpts=N*2/(25*TB)
+
+fate-ffmpeg-chunk-workers1-%: CHUNK_WORKERS = 1
+fate-ffmpeg-chunk-workers3-%: CHUNK_WORKERS = 3
+
+FATE_CHUNK_FALLBACK = $(foreach W, 1 3, $(FATE_CHUNK_FALLBACK-yes:%=fate-ffmpeg-chunk-workers$(W)-%))
+$(FATE_CHUNK_FALLBACK): CMD = framemd5 -f lavfi -i testsrc=s=352x288:r=25:d=0.4 -sws_flags +accurate_rnd+bitexact -vf "scale,format=yuv444p,$(CHUNK_VF)" -c:v jpeg2000 -tile_width 128 -tile_height 128 -threads 1 -chunk_workers $(CHUNK_WORKERS)
+$(FATE_CHUNK_FALLBACK): REF = $(SRC_PATH)/tests/ref/fate/ffmpeg-chunk-workers-$(lastword $(subst -, ,$(@)))
+
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SCALE_FILTER FORMAT_FILTER \
+                           RAWVIDEO_DECODER JPEG2000_ENCODER FRAMEMD5_MUXER) \
+                           += $(FATE_CHUNK_FALLBACK)
+fate-ffmpeg-chunk-workers-fallback: $(FATE_CHUNK_FALLBACK)
+
+# a frame threaded decoder still holds frames when the workers would take
+# over, so chunk workers must fall back to the regular path without losing them
+FATE_FFMPEG-$(call ALLYES, MXF_MUXER MXF_DEMUXER JPEG2000_ENCODER JPEG2000_DECODER \
+                           RAWVIDEO_ENCODER FRAMECRC_MUXER) \
+                           += fate-ffmpeg-chunk-workers-frame-threads
+fate-ffmpeg-chunk-workers-frame-threads: fate-lavf-mxf_jpeg2000
+fate-ffmpeg-chunk-workers-frame-threads: THREADS = 4
+fate-ffmpeg-chunk-workers-frame-threads: CMD = framecrc -i $(TARGET_PATH)/tests/data/lavf/lavf.mxf_jpeg2000 -c:v rawvideo -chunk_workers 3
+
+# encoder threads must not change the output, so the reference is shared
+FATE_ENC_THREAD_QUEUE = $(foreach Q, 0 4, fate-ffmpeg-enc-thread-queue$(Q))
+$(FATE_ENC_THREAD_QUEUE): CMD = framecrc -auto_conversion_filters -f lavfi -i testsrc=s=176x144:r=25:d=1 -f lavfi -i sine=d=1 -sws_flags +accurate_rnd+bitexact -c:v mpeg4 -bf 2 -c:a ac3_fixed -enc_thread_queue_size $(subst fate-ffmpeg-enc-thread-queue,,$(@))
+$(FATE_ENC_THREAD_QUEUE): REF = $(SRC_PATH)/tests/ref/fate/ffmpeg-enc-thread-queue
+
+FATE_FFMPEG-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SINE_FILTER SCALE_FILTER \
+                           ARESAMPLE_FILTER MPEG4_ENCODER AC3_FIXED_ENCODER \
+                           FRAMECRC_MUXER) += $(FATE_ENC_THREAD_QUEUE)
+fate-ffmpeg-enc-thread-queue: $(FATE_ENC_THREAD_QUEUE)
+
 FATE_SAMPLES_FFMPEG-$(CONFIG_RAWVIDEO_DEMUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
@@ -94,6 +94,9 @@ fate-filter-asetnsamples-nopad: tests/data/asynth-44100-2.wav
 fate-filter-asetnsamples-nopad: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
 fate-filter-asetnsamples-nopad: CMD = framecrc -i $(SRC) -af asetnsamples=512:p=0
 
+FATE_AFILTER-$(call ALLYES, SINE_FILTER ARESAMPLE_FILTER AFORMAT_FILTER ASETNSAMPLES_FILTER VOLUME_FILTER PCM_S16LE_ENCODER FRAMECRC_MUXER) += fate-filter-asetnsamples-rechunk
+fate-filter-asetnsamples-rechunk: CMD = framecrc -auto_conversion_filters -filter_complex "sine=frequency=1000:sample_rate=48000:samples_per_frame=2002:duration=0.5,aformat=sample_fmts=fltp:channel_layouts=stereo,asetnsamples=1024:p=0,volume=0.5,aformat=sample_fmts=s16,asetnsamples=480:p=0,asetnsamples=2002:p=0" -c:a pcm_s16le
+
 FATE_AFILTER-$(call FILTERDEMDECENCMUX, ASETRATE, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-asetrate
 fate-filter-asetrate: tests/data/asynth-44100-2.wav
 fate-filter-asetrate: SRC = $(TARGET_PATH)/tests/data/asynth-44100-2.wav
@@ -186,6 +189,9 @@ fate-filter-pan-downmix2: CMD = framecrc -ss 3.14 -i $(SRC) -frames:a 20 -filter
 FATE_AFILTER-$(call ALLYES, LAVFI_INDEV, AEVALSRC_FILTER SILENCEREMOVE_FILTER) += fate-filter-silenceremove
 fate-filter-silenceremove: CMD = framecrc -auto_conversion_filters -f lavfi -i "aevalsrc=between(t\,1\,2)+between(t\,4\,5)+between(t\,7\,9):d=10:n=8192,silenceremove=start_periods=0:start_duration=0:start_threshold=0:stop_periods=-1:stop_duration=0:stop_threshold=-90dB:window=0:detection=peak"
 
+FATE_AFILTER-$(call ALLYES, LAVFI_INDEV AEVALSRC_FILTER LOUDNORM_FILTER ARESAMPLE_FILTER) += fate-filter-loudnorm
+fate-filter-loudnorm: CMD = framecrc -auto_conversion_filters -f lavfi -i "aevalsrc=0.25*sin(2*PI*440*t)*(1+0.75*sin(PI*t))|0.1*sin(2*PI*1000*t):s=48000:d=4:n=4800,loudnorm=I=-23:TP=-2:LRA=7,aresample=48000"
+
 FATE_AFILTER_SAMPLES-$(call FILTERDEMDECENCMUX, STEREOTOOLS, WAV, PCM_S16LE, PCM_S16LE, WAV) += fate-filter-stereotools
 fate-filter-stereotools: SRC = $(TARGET_SAMPLES)/audio-reference/luckynight_2ch_44kHz_s16.wav
 fate-filter-stereotools: CMD = framecrc -i $(SRC) -frames:a 20 -af aresample,stereotools=mlev=0.015625,aresample
@@ -461,6 +461,28 @@ fate-filter-concat: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/d
 fate-filter-concat-vfr: tests/data/filtergraphs/concat-vfr
 fate-filter-concat-vfr: CMD = framecrc -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/concat-vfr
 
+SPLIT_BRANCHES_DEPS = TESTSRC2_FILTER SINE_FILTER SPLIT_FILTER SCALE_FILTER FORMAT_FILTER WAVEFORM_FILTER EBUR128_FILTER
+SPLIT_BRANCHES_ARGS = -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/split-branches -map "[proxy]" -map "[thumb]" -map "[wave]" -map "[loud]" -t 0.2
+FATE_FILTER-$(call ALLYES, $(SPLIT_BRANCHES_DEPS)) += fate-filter-split-branches fate-filter-split-branches-parallel
+fate-filter-split-branches: tests/data/filtergraphs/split-branches
+fate-filter-split-branches: CMD = framecrc -auto_conversion_filters -filter_complex_threads 4 $(SPLIT_BRANCHES_ARGS)
+fate-filter-split-branches-parallel: tests/data/filtergraphs/split-branches
+fate-filter-split-branches-parallel: CMD = framecrc -auto_conversion_filters -filter_complex_threads 4 -filter_parallel $(SPLIT_BRANCHES_ARGS)
+fate-filter-split-branches-parallel: REF = $(SRC_PATH)/tests/ref/fate/filter-split-branches
+
+FRAME_THREADS_DEPS = TESTSRC2_FILTER FORMAT_FILTER NEGATE_FILTER LUTYUV_FILTER COLORSPACE_FILTER LUT3D_FILTER LUT1D_FILTER
+FRAME_THREADS_ARGS = -filter_complex_script $(TARGET_PATH)/tests/data/filtergraphs/frame-threads
+FATE_FILTER-$(call ALLYES, $(FRAME_THREADS_DEPS)) += fate-filter-frame-threads fate-filter-frame-threads-parallel
+fate-filter-frame-threads: tests/data/filtergraphs/frame-threads
+fate-filter-frame-threads: CMD = framecrc -auto_conversion_filters -filter_complex_threads 3 $(FRAME_THREADS_ARGS)
+fate-filter-frame-threads-parallel: tests/data/filtergraphs/frame-threads
+fate-filter-frame-threads-parallel: CMD = framecrc -auto_conversion_filters -filter_complex_threads 3 -filter_parallel $(FRAME_THREADS_ARGS)
+fate-filter-frame-threads-parallel: REF = $(SRC_PATH)/tests/ref/fate/filter-frame-threads
+
+FATE_FILTER-$(call ALLYES, TESTSRC_FILTER FORMAT_FILTER SCALE_FILTER SPLIT_FILTER NEGATE_FILTER HFLIP_FILTER VFLIP_FILTER) += fate-filter-stats
+fate-filter-stats: libavfilter/tests/filterstats$(EXESUF)
+fate-filter-stats: CMD = run libavfilter/tests/filterstats$(EXESUF)
+
 FATE_FILTER-$(call ALLYES, TESTSRC2_FILTER CHROMASHIFT_FILTER) += fate-filter-chromashift-smear fate-filter-chromashift-wrap
 fate-filter-chromashift-smear: CMD = framecrc -lavfi testsrc2=r=5:d=1,chromashift=cbh=-1:cbv=1:crh=2:crv=-2:edge=smear -pix_fmt yuv420p
 fate-filter-chromashift-wrap:  CMD = framecrc -lavfi testsrc2=r=5:d=1,chromashift=cbh=-1:cbv=1:crh=2:crv=-2:edge=wrap  -pix_fmt yuv420p
@@ -838,6 +860,10 @@ FATE_METADATA_FILTER-$(call ALLYES, $(EBUR128_METADATA_DEPS)) += fate-filter-met
 fate-filter-metadata-ebur128: SRC = $(TARGET_SAMPLES)/filter/seq-3341-7_seq-3342-5-24bit.flac
 fate-filter-metadata-ebur128: CMD = run $(FILTER_METADATA_COMMAND) "amovie='$(SRC)',ebur128=metadata=1"
 
+EBUR128_LAVFI_METADATA_DEPS = FFPROBE AVDEVICE LAVFI_INDEV AEVALSRC_FILTER EBUR128_FILTER SWRESAMPLE
+FATE_METADATA_FILTER_LAVFI-$(call ALLYES, $(EBUR128_LAVFI_METADATA_DEPS)) += fate-filter-metadata-ebur128-aevalsrc
+fate-filter-metadata-ebur128-aevalsrc: CMD = run $(FILTER_METADATA_COMMAND) "aevalsrc=0.25*sin(2*PI*440*t)*(1+0.75*sin(PI*t))|0.1*sin(2*PI*1000*t):s=48000:d=4:n=4800,ebur128=metadata=1:peak=sample+true"
+
 READVITC_METADATA_DEPS = FFPROBE LAVFI_INDEV MOVIE_FILTER AVCODEC AVDEVICE \
                          AVI_DEMUXER FFVHUFF_DECODER READVITC_FILTER
 FATE_METADATA_FILTER-$(call ALLYES, $(READVITC_METADATA_DEPS)) += fate-filter-metadata-readvitc-def
@@ -883,9 +909,10 @@ FATE_FILTER-$(call ALLYES, $(REFCMP_DEPS) SITI_FILTER) += fate-filter-refcmp-sit
 fate-filter-refcmp-siti-yuv: CMD = cmp_metadata siti yuv420p 0.015
 
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
+FATE_FFPROBE += $(FATE_METADATA_FILTER_LAVFI-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)
 
 fate-vfilter: $(FATE_FILTER-yes) $(FATE_FILTER_SAMPLES-yes) $(FATE_FILTER_VSYNTH-yes)
 
-fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes)
+fate-filter: fate-afilter fate-vfilter $(FATE_METADATA_FILTER-yes) $(FATE_METADATA_FILTER_LAVFI-yes)
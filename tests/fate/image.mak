@@ -549,6 +549,22 @@ FATE_XBM-$(call DEMDEC, IMAGE2, XBM) += $(FATE_XBM)
 FATE_IMAGE += $(FATE_XBM-yes)
 fate-xbm: $(FATE_XBM-yes)
 
+# reading files ahead must not change the packets, so the references are shared
+FATE_IMAGE2_PREFETCH += fate-image2-prefetch-0 fate-image2-prefetch-4
+fate-image2-prefetch-%: CMD = framecrc -f image2 -prefetch $(PREFETCH) -c:v pgmyuv -i $(TARGET_PATH)/tests/vsynth1/%02d.pgm -c copy
+fate-image2-prefetch-%: REF = $(SRC_PATH)/tests/ref/fate/image2-prefetch
+
+FATE_IMAGE2_PREFETCH += fate-image2-prefetch-seek-0 fate-image2-prefetch-seek-4
+fate-image2-prefetch-seek-%: CMD = framecrc -f image2 -prefetch $(PREFETCH) -c:v pgmyuv -ss 0.4 -i $(TARGET_PATH)/tests/vsynth1/%02d.pgm -c copy
+fate-image2-prefetch-seek-%: REF = $(SRC_PATH)/tests/ref/fate/image2-prefetch-seek
+
+$(FATE_IMAGE2_PREFETCH): PREFETCH = $(lastword $(subst -, ,$(@)))
+$(FATE_IMAGE2_PREFETCH): $(VREF)
+
+FATE_IMAGE2_PREFETCH-$(call DEMDEC, IMAGE2, PGMYUV) += $(FATE_IMAGE2_PREFETCH)
+FATE_FFMPEG += $(FATE_IMAGE2_PREFETCH-yes)
+fate-image2-prefetch: $(FATE_IMAGE2_PREFETCH-yes)
+
 FATE_IMAGE += $(FATE_IMAGE-yes)
 FATE_IMAGE_PROBE += $(FATE_IMAGE_PROBE-yes)
 
@@ -3,4 +3,14 @@ fate-imf-cpl-with-repeat: CMD = framecrc -f imf -i $(TARGET_SAMPLES)/imf/countdo
 
 FATE_SAMPLES_FFMPEG-$(CONFIG_IMF_DEMUXER) += $(FATE_IMF)
 
-fate-imf: $(FATE_IMF)
+# re-chunk PCM audio spanning several resources into fixed size packets
+FATE_IMF_AUDIO_FRAME_SIZE = 1000 3000
+FATE_IMF_FFMPEG-$(call ALLYES, IMF_DEMUXER MXF_DEMUXER MXF_OPATOM_MUXER PCM_S16LE_DEMUXER \
+                               PCM_S16LE_DECODER PCM_S24LE_ENCODER ARESAMPLE_FILTER \
+                               FRAMECRC_MUXER) += $(FATE_IMF_AUDIO_FRAME_SIZE:%=fate-imf-audio-frame-size-%)
+$(FATE_IMF_FFMPEG-yes): $(AREF)
+fate-imf-audio-frame-size-%: CMD = imf $(SRC_PATH)/tests/imf-audio-CPL.xml $(SRC_PATH)/tests/imf-audio-ASSETMAP.xml "-audio_frame_size $(@:fate-imf-audio-frame-size-%=%)"
+
+FATE_FFMPEG += $(FATE_IMF_FFMPEG-yes)
+
+fate-imf: $(FATE_IMF) $(FATE_IMF_FFMPEG-yes)
@@ -11,6 +11,7 @@ FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG1VIDEO, MP2,       MPEG1SYSTEM MPEGPS) +
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, PCM_S16LE, MXF)                += mxf mxf_dv25 mxf_dvcpro50
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, PCM_S16LE, MXF_D10 MXF)        += mxf_d10
 FATE_LAVF_CONTAINER-$(call ENCDEC2, DNXHD,      PCM_S16LE, MXF_OPATOM MXF)     += mxf_opatom mxf_opatom_audio
+FATE_LAVF_CONTAINER-$(call ENCDEC,  JPEG2000,              MXF)                += mxf_jpeg2000 mxf_jpeg2000_rgb mxf_jpeg2000_jp2
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      MP2,       NUT)                += nut
 FATE_LAVF_CONTAINER-$(call ENCMUX,  RV10 AC3_FIXED,        RM)                 += rm
 FATE_LAVF_CONTAINER-$(call ENCMUX,  MJPEG PCM_S16LE,       SMJPEG)             += smjpeg
@@ -47,6 +48,9 @@ fate-lavf-mxf_dv25: CMD = lavf_container "-ar 48000 -ac 2" "-r 25 -vf scale=720:
 fate-lavf-mxf_dvcpro50: CMD = lavf_container "-ar 48000 -ac 2" "-r 25 -vf scale=720:576,setdar=16/9 -c:v dvvideo -pix_fmt yuv422p -b 50000k -top 0 -f mxf"
 fate-lavf-mxf_opatom: CMD = lavf_container "" "-s 1920x1080 -c:v dnxhd -pix_fmt yuv422p -vb 36M -f mxf_opatom -map 0"
 fate-lavf-mxf_opatom_audio: CMD = lavf_container "-ar 48000 -ac 1" "-f mxf_opatom -mxf_audio_edit_rate 25 -map 1"
+fate-lavf-mxf_jpeg2000: CMD = lavf_container "" "-an -r 25 -c:v jpeg2000 -format j2k -pix_fmt yuv422p -threads 1 -f mxf"
+fate-lavf-mxf_jpeg2000_rgb: CMD = lavf_container "" "-an -r 25 -c:v jpeg2000 -format j2k -pix_fmt rgb24 -threads 1 -f mxf"
+fate-lavf-mxf_jpeg2000_jp2: CMD = lavf_container "" "-an -r 25 -c:v jpeg2000 -pix_fmt yuv422p -threads 1 -f mxf"
 fate-lavf-smjpeg:  CMD = lavf_container "" "-f smjpeg"
 # The RealMedia muxer is broken.
 fate-lavf-rm:  CMD = lavf_container "" "-c:a ac3_fixed" disable_crc
@@ -246,6 +246,20 @@ fate-seek-lavf-y4m:      SRC = lavf/lavf.y4m
 
 FATE_SEEK += $(FATE_SEEK_LAVF-yes:%=fate-seek-lavf-%)
 
+# the same seeks through the memory mapped and io_uring modes of the file protocol
+FATE_SEEK_FILE_MODE-$(call ENCDEC2, MPEG2VIDEO, PCM_S16LE, MXF)    += mxf
+FATE_SEEK_FILE_MODE-$(call ENCDEC2, MPEG2VIDEO, MP2,       MPEGTS) += ts
+
+FATE_SEEK_FILE = $(foreach m,mmap $(if $(HAVE_LINUX_IO_URING_H),io_uring),$(FATE_SEEK_FILE_MODE-yes:%=fate-seek-lavf-%-$(m)))
+
+fate-seek-lavf-mxf-mmap fate-seek-lavf-mxf-io_uring: fate-lavf-mxf
+fate-seek-lavf-ts-mmap fate-seek-lavf-ts-io_uring: fate-lavf-ts
+
+$(FATE_SEEK_FILE): libavformat/tests/seek$(EXESUF)
+$(FATE_SEEK_FILE): SRC = $(word 4,$(subst -, ,$(@)))
+$(FATE_SEEK_FILE): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/lavf/lavf.$(SRC) -$(lastword $(subst -, ,$(@))) 1
+$(FATE_SEEK_FILE): REF = $(SRC_PATH)/tests/ref/seek/lavf-$(SRC)
+
 # extra files
 
 FATE_SEEK_EXTRA-$(CONFIG_MP3_DEMUXER)   += fate-seek-extra-mp3
@@ -273,6 +287,6 @@ $(FATE_SEEK) $(FATE_SAMPLES_SEEK): fate-seek-%: fate-%
 $(subst fate-seek-,fate-,$(FATE_SAMPLES_SEEK) $(FATE_SEEK)): KEEP_OVERRIDE = -keep
 fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
-FATE_AVCONV += $(FATE_SEEK)
+FATE_AVCONV += $(FATE_SEEK) $(FATE_SEEK_FILE)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SEEK_FILE) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
@@ -490,3 +490,26 @@ fate-vsynth2: $(FATE_VSYNTH2)
 fate-vsynth_lena: $(FATE_VSYNTH_LENA)
 fate-vsynth3: $(FATE_VSYNTH3)
 fate-vcodec:  fate-vsynth1 fate-vsynth_lena fate-vsynth2 fate-vsynth3
+
+# Frame threaded intra-only encoders must not depend on the thread count,
+# so the same reference is used for every count.
+ENC_THREADS_DEPS = LAVFI_INDEV TESTSRC_FILTER SCALE_FILTER FORMAT_FILTER FRAMEMD5_MUXER
+FATE_ENC_THREADS-$(call ALLYES, $(ENC_THREADS_DEPS) DPX_ENCODER)      += dpx
+FATE_ENC_THREADS-$(call ALLYES, $(ENC_THREADS_DEPS) FFV1_ENCODER)     += ffv1
+FATE_ENC_THREADS-$(call ALLYES, $(ENC_THREADS_DEPS) JPEG2000_ENCODER) += jpeg2000
+
+fate-enc-threads%-dpx:      ENC_PIXFMT = gbrp10le
+fate-enc-threads%-ffv1:     ENC_PIXFMT = yuv422p10
+fate-enc-threads%-ffv1:     ENC_OPTS   = -level 3 -g 1 -slices 4
+fate-enc-threads%-jpeg2000: ENC_PIXFMT = yuv444p
+fate-enc-threads%-jpeg2000: ENC_OPTS   = -tile_width 128 -tile_height 128
+
+fate-enc-threads1-%: ENC_THREADS = 1
+fate-enc-threads3-%: ENC_THREADS = 3
+
+FATE_ENC_THREADS = $(foreach T, 1 3, $(FATE_ENC_THREADS-yes:%=fate-enc-threads$(T)-%))
+$(FATE_ENC_THREADS): CMD = framemd5 -f lavfi -i testsrc=s=352x288:r=25:d=0.4 -sws_flags +accurate_rnd+bitexact -vf scale,format=$(ENC_PIXFMT) -c:v $(lastword $(subst -, ,$(@))) $(ENC_OPTS) -threads $(ENC_THREADS)
+$(FATE_ENC_THREADS): REF = $(SRC_PATH)/tests/ref/fate/enc-threads-$(lastword $(subst -, ,$(@)))
+
+FATE_AVCONV += $(FATE_ENC_THREADS)
+fate-enc-threads: $(FATE_ENC_THREADS)
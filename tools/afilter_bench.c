@@ -0,0 +1,185 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the throughput of an audio filter chain. Frames of silence are
+ * pushed to the chain and pulled from its output, without any decoding or
+ * encoding. The default chain re-chunks the 2002 samples per frame of
+ * 48 kHz audio at 24000/1001 fps, as read from IMF PCM track files, into
+ * the 1024 samples per frame of an AAC encoder:
+ *
+ *   afilter_bench -r 5
+ *   afilter_bench -n 2000 -c 8 -f "volume=0.5,asetnsamples=1024:p=0"
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-f chain] [-n samples] [-c channels] [-s sample_fmt] [-d seconds] [-r runs]\n", argv0);
+    fprintf(stderr, "-f: filter chain, default \"asetnsamples=1024:p=0\"\n");
+    fprintf(stderr, "-n: samples per input frame, default 2002\n");
+    return ret;
+}
+
+static int64_t run(const char *chain, int nb_samples, int channels,
+                   enum AVSampleFormat sample_fmt, int64_t duration)
+{
+    AVFilterGraph *graph;
+    AVFilterContext *src, *sink;
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    AVFrame *frame = NULL;
+    char args[256];
+    int64_t pts = 0, total = 0;
+    int ret;
+
+    graph = avfilter_graph_alloc();
+    if (!graph)
+        return AVERROR(ENOMEM);
+
+    snprintf(args, sizeof(args),
+             "time_base=1/48000:sample_rate=48000:sample_fmt=%s:channel_layout=%dc",
+             av_get_sample_fmt_name(sample_fmt), channels);
+    ret = avfilter_graph_create_filter(&src, avfilter_get_by_name("abuffer"),
+                                       "in", args, NULL, graph);
+    if (ret < 0)
+        goto fail;
+    ret = avfilter_graph_create_filter(&sink, avfilter_get_by_name("abuffersink"),
+                                       "out", NULL, NULL, graph);
+    if (ret < 0)
+        goto fail;
+
+    outputs = avfilter_inout_alloc();
+    inputs  = avfilter_inout_alloc();
+    if (!outputs || !inputs) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    outputs->name       = av_strdup("in");
+    outputs->filter_ctx = src;
+    inputs->name        = av_strdup("out");
+    inputs->filter_ctx  = sink;
+    ret = avfilter_graph_parse_ptr(graph, chain, &inputs, &outputs, NULL);
+    if (ret < 0)
+        goto fail;
+    ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0)
+        goto fail;
+
+    frame = av_frame_alloc();
+    if (!frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    while (1) {
+        if (pts < duration) {
+            frame->format      = sample_fmt;
+            frame->sample_rate = 48000;
+            frame->nb_samples  = nb_samples;
+            frame->pts         = pts;
+            av_channel_layout_default(&frame->ch_layout, channels);
+            ret = av_frame_get_buffer(frame, 0);
+            if (ret < 0)
+                goto fail;
+            av_samples_set_silence(frame->extended_data, 0, nb_samples,
+                                   channels, sample_fmt);
+            pts += nb_samples;
+            ret = av_buffersrc_add_frame(src, frame);
+        } else {
+            ret = av_buffersrc_add_frame(src, NULL);
+        }
+        if (ret < 0)
+            goto fail;
+
+        while ((ret = av_buffersink_get_frame(sink, frame)) >= 0) {
+            total += frame->nb_samples;
+            av_frame_unref(frame);
+        }
+        if (ret == AVERROR_EOF)
+            break;
+        if (ret != AVERROR(EAGAIN))
+            goto fail;
+    }
+    ret = 0;
+
+fail:
+    av_frame_free(&frame);
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    avfilter_graph_free(&graph);
+    return ret < 0 ? ret : total;
+}
+
+int main(int argc, char **argv)
+{
+    const char *chain = "asetnsamples=1024:p=0";
+    int nb_samples = 2002, channels = 2, runs = 3, i;
+    enum AVSampleFormat sample_fmt = AV_SAMPLE_FMT_S32;
+    double seconds = 600;
+    char errbuf[50];
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            chain = argv[++i];
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            nb_samples = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+            channels = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            sample_fmt = av_get_sample_fmt(argv[++i]);
+        } else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (nb_samples <= 0 || channels <= 0 || sample_fmt == AV_SAMPLE_FMT_NONE ||
+        seconds <= 0 || runs <= 0)
+        return usage(argv[0], 1);
+
+    for (i = 0; i < runs; i++) {
+        int64_t start = av_gettime_relative(), elapsed, samples;
+
+        samples = run(chain, nb_samples, channels, sample_fmt, seconds * 48000);
+        elapsed = FFMAX(av_gettime_relative() - start, 1);
+        if (samples < 0) {
+            av_strerror(samples, errbuf, sizeof(errbuf));
+            fprintf(stderr, "Error running %s: %s\n", chain, errbuf);
+            return 1;
+        }
+        printf("run %d: %"PRId64" samples, %.3f ms, %.1fx realtime\n",
+               i, samples, elapsed / 1000.0,
+               samples / 48000.0 / (elapsed / 1000000.0));
+    }
+    return 0;
+}
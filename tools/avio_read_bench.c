@@ -0,0 +1,202 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the read throughput of a protocol, e.g. to compare the plain and
+ * memory mapped modes of the file protocol:
+ *
+ *   avio_read_bench -r 5 input.mxf
+ *   avio_read_bench -r 5 -oi mmap=1 input.mxf
+ *
+ * Several inputs are read concurrently, one thread each if threads are
+ * available, which gives the aggregate throughput of e.g. the track files
+ * of an IMF package:
+ *
+ *   avio_read_bench -oi io_uring=1 video.mxf audio1.mxf audio2.mxf
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+#include "libavformat/avformat.h"
+
+#define MAX_INPUTS 64
+
+typedef struct Input {
+    const char *url;
+    AVIOContext *pb;
+    uint8_t *buf;
+    AVLFG lfg;
+    int64_t bytes;      ///< bytes read in the last run, or error code
+#if HAVE_THREADS
+    pthread_t thread;
+#endif
+} Input;
+
+static int chunk_size = 65536, seeks = 0;
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-s chunksize] [-r runs] [-k seeks] [-oi <options>] input_url [input_url...]\n", argv0);
+    fprintf(stderr, "<options>: AVOptions expressed as key=value, :-separated\n");
+    fprintf(stderr, "-k: read one chunk after each of <seeks> random seeks instead of reading sequentially\n");
+    return ret;
+}
+
+static int64_t run(AVIOContext *input, uint8_t *buf, int chunk_size,
+                   int seeks, AVLFG *lfg)
+{
+    int64_t total = 0, size;
+    int n, i;
+
+    if (avio_seek(input, 0, SEEK_SET) < 0)
+        return AVERROR(EIO);
+
+    if (!seeks) {
+        while ((n = avio_read(input, buf, chunk_size)) > 0)
+            total += n;
+        return n == AVERROR_EOF ? total : n;
+    }
+
+    size = avio_size(input);
+    if (size <= 0)
+        return AVERROR(ENOSYS);
+    for (i = 0; i < seeks; i++) {
+        int64_t pos = (((uint64_t)av_lfg_get(lfg) << 32) | av_lfg_get(lfg)) % size;
+        if (avio_seek(input, pos, SEEK_SET) < 0)
+            return AVERROR(EIO);
+        n = avio_read(input, buf, chunk_size);
+        if (n < 0 && n != AVERROR_EOF)
+            return n;
+        total += FFMAX(n, 0);
+    }
+    return total;
+}
+
+static void *run_thread(void *arg)
+{
+    Input *in = arg;
+    in->bytes = run(in->pb, in->buf, chunk_size, seeks, &in->lfg);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int runs = 3, nb_inputs = 0, ret = 0, i, j;
+    Input inputs[MAX_INPUTS] = { { 0 } };
+    AVDictionary *in_opts = NULL;
+    char errbuf[50];
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            chunk_size = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+            seeks = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-oi") && i + 1 < argc) {
+            if (av_dict_parse_string(&in_opts, argv[++i], "=", ":", 0) < 0) {
+                fprintf(stderr, "Cannot parse option string %s\n", argv[i]);
+                return usage(argv[0], 1);
+            }
+        } else if (nb_inputs < MAX_INPUTS) {
+            inputs[nb_inputs++].url = argv[i];
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (!nb_inputs || chunk_size <= 0 || runs <= 0 || seeks < 0)
+        return usage(argv[0], 1);
+
+    for (i = 0; i < nb_inputs; i++) {
+        Input *in = &inputs[i];
+        AVDictionary *opts = NULL;
+
+        av_dict_copy(&opts, in_opts, 0);
+        ret = avio_open2(&in->pb, in->url, AVIO_FLAG_READ, NULL, &opts);
+        av_dict_free(&opts);
+        if (ret < 0) {
+            av_strerror(ret, errbuf, sizeof(errbuf));
+            fprintf(stderr, "Unable to open %s: %s\n", in->url, errbuf);
+            goto fail;
+        }
+        in->buf = av_malloc(chunk_size);
+        if (!in->buf) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        av_lfg_init(&in->lfg, 0xdeadbeef + i);
+    }
+
+    for (i = 0; i < runs; i++) {
+        int64_t start = av_gettime_relative(), elapsed, bytes = 0;
+
+#if HAVE_THREADS
+        if (nb_inputs > 1) {
+            for (j = 0; j < nb_inputs; j++) {
+                ret = pthread_create(&inputs[j].thread, NULL, run_thread, &inputs[j]);
+                if (ret) {
+                    ret = AVERROR(ret);
+                    while (j--)
+                        pthread_join(inputs[j].thread, NULL);
+                    goto fail;
+                }
+            }
+            for (j = 0; j < nb_inputs; j++)
+                pthread_join(inputs[j].thread, NULL);
+        } else
+#endif
+        /* without threads, several inputs are read one after the other */
+        for (j = 0; j < nb_inputs; j++)
+            run_thread(&inputs[j]);
+        elapsed = FFMAX(av_gettime_relative() - start, 1);
+
+        for (j = 0; j < nb_inputs; j++) {
+            if (inputs[j].bytes < 0) {
+                ret = inputs[j].bytes;
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                fprintf(stderr, "Read error on %s: %s\n", inputs[j].url, errbuf);
+                goto fail;
+            }
+            bytes += inputs[j].bytes;
+        }
+        if (seeks)
+            printf("run %d: %d seeks, %"PRId64" bytes, %.3f ms, %.2f us/seek\n",
+                   i, seeks * nb_inputs, bytes, elapsed / 1000.0,
+                   (double)elapsed / seeks);
+        else
+            printf("run %d: %"PRId64" bytes, %.3f ms, %.2f MiB/s\n",
+                   i, bytes, elapsed / 1000.0,
+                   bytes / (1024.0 * 1024.0) / (elapsed / 1000000.0));
+    }
+    ret = 0;
+
+fail:
+    av_dict_free(&in_opts);
+    for (i = 0; i < nb_inputs; i++) {
+        avio_closep(&inputs[i].pb);
+        av_freep(&inputs[i].buf);
+    }
+    return ret < 0;
+}
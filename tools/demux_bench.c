@@ -0,0 +1,592 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure how fast a demuxer opens an input, returns its packets and seeks
+ * in it, without any decoding:
+ *
+ *   demux_bench -f imf -r 5 -s 200 CPL.xml
+ *   demux_bench -f mxf -o fflags=+genpts -i -s 1000 input.mxf
+ *
+ * The IMF demuxer is experimental and never probed, so -f imf is required for
+ * CPLs.
+ *
+ * With -g, synthetic stress inputs are written instead: an IMF package whose
+ * CPL has many short resources, each one opening the track file anew at
+ * another entry point, or a long MXF file with many body partitions:
+ *
+ *   demux_bench -g imf -n 10000 dir && demux_bench -f imf dir/CPL.xml
+ *   demux_bench -g mxf -n 100000 long.mxf && demux_bench long.mxf
+ */
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/avstring.h"
+#include "libavutil/channel_layout.h"
+#include "libavutil/common.h"
+#include "libavutil/dict.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+
+static atomic_uint_fast64_t nb_allocs = ATOMIC_VAR_INIT(0);
+
+#if defined(__GLIBC__)
+/* Count the heap allocations of the libraries, including those of external
+ * ones like libxml2, by interposing the allocation functions of the C
+ * library. av_malloc() goes through posix_memalign() there. */
+#define ALLOC_COUNT 1
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t nmemb, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t align, size_t size);
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&nb_allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+    atomic_fetch_add_explicit(&nb_allocs, 1, memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&nb_allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void **ptr, size_t align, size_t size)
+{
+    atomic_fetch_add_explicit(&nb_allocs, 1, memory_order_relaxed);
+    *ptr = __libc_memalign(align, size);
+    return *ptr || !size ? 0 : ENOMEM;
+}
+#else
+#define ALLOC_COUNT 0
+#endif
+
+static uint64_t get_allocs(void)
+{
+    return atomic_load_explicit(&nb_allocs, memory_order_relaxed);
+}
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-f format] [-o key=value]... [-i] [-r runs] [-s seeks] input\n", argv0);
+    fprintf(stderr, "%s -g imf|mxf [-n count] output\n", argv0);
+    fprintf(stderr, "-f: input format, required for imf since the IMF demuxer is never probed\n");
+    fprintf(stderr, "-o: demuxer option, can be repeated\n");
+    fprintf(stderr, "-i: also time avformat_find_stream_info()\n");
+    fprintf(stderr, "-r: number of times the input is opened and read, default 3\n");
+    fprintf(stderr, "-s: number of random seeks after the last run, default 100\n");
+    fprintf(stderr, "-g imf: write CPL.xml, ASSETMAP.xml and audio.mxf in the existing directory output,\n"
+                    "        the CPL having count resources, default 1000\n");
+    fprintf(stderr, "-g mxf: write the MXF file output, count frames long, default 25000\n");
+    return ret;
+}
+
+static int open_input(AVFormatContext **ctx, const char *filename,
+                      const AVInputFormat *fmt, const AVDictionary *opts)
+{
+    AVDictionary *o = NULL;
+    int ret;
+
+    if ((ret = av_dict_copy(&o, opts, 0)) < 0)
+        return ret;
+    ret = avformat_open_input(ctx, filename, fmt, &o);
+    av_dict_free(&o);
+    return ret;
+}
+
+static int run(const char *filename, const AVInputFormat *fmt,
+               const AVDictionary *opts, int find_info, int runnr,
+               int64_t *start_time, int64_t *duration)
+{
+    AVFormatContext *ctx = NULL;
+    AVPacket *pkt;
+    uint64_t allocs, packets = 0, bytes = 0;
+    int64_t start, open_time, info_time = 0, read_time, end_time = INT64_MIN;
+    int ret;
+
+    pkt = av_packet_alloc();
+    if (!pkt)
+        return AVERROR(ENOMEM);
+
+    allocs = get_allocs();
+    start  = av_gettime_relative();
+    ret    = open_input(&ctx, filename, fmt, opts);
+    open_time = av_gettime_relative() - start;
+    if (ret < 0)
+        goto end;
+    printf("run %d: open %.3f ms, %"PRIu64" allocs", runnr, open_time / 1000.0,
+           get_allocs() - allocs);
+
+    if (find_info) {
+        allocs = get_allocs();
+        start  = av_gettime_relative();
+        ret    = avformat_find_stream_info(ctx, NULL);
+        info_time = av_gettime_relative() - start;
+        if (ret < 0)
+            goto end;
+        printf(", stream info %.3f ms, %"PRIu64" allocs", info_time / 1000.0,
+               get_allocs() - allocs);
+    }
+    printf("\n");
+
+    allocs = get_allocs();
+    start  = av_gettime_relative();
+    while ((ret = av_read_frame(ctx, pkt)) >= 0) {
+        AVStream *st = ctx->streams[pkt->stream_index];
+
+        packets++;
+        bytes += pkt->size;
+        if (pkt->dts != AV_NOPTS_VALUE) {
+            int64_t dts = av_rescale_q(pkt->dts + pkt->duration, st->time_base, AV_TIME_BASE_Q);
+            end_time = FFMAX(end_time, dts);
+        }
+        av_packet_unref(pkt);
+    }
+    read_time = FFMAX(av_gettime_relative() - start, 1);
+    if (ret != AVERROR_EOF)
+        goto end;
+    ret = 0;
+    allocs = get_allocs() - allocs;
+
+    printf("run %d: %"PRIu64" packets, %.3f MB in %.3f ms: %.0f packets/s, %.2f MB/s, "
+           "%.2f allocs/packet\n", runnr, packets, bytes / 1000000.0, read_time / 1000.0,
+           packets * 1000000.0 / read_time, bytes / (double)read_time,
+           packets ? allocs / (double)packets : 0.0);
+
+    *start_time = ctx->start_time != AV_NOPTS_VALUE ? ctx->start_time : 0;
+    *duration   = ctx->duration;
+    if (*duration == AV_NOPTS_VALUE || *duration <= 0)
+        *duration = end_time > *start_time ? end_time - *start_time : 0;
+
+end:
+    av_packet_free(&pkt);
+    avformat_close_input(&ctx);
+    return ret;
+}
+
+static int cmp_int64(const void *a, const void *b)
+{
+    return FFDIFFSIGN(*(const int64_t *)a, *(const int64_t *)b);
+}
+
+/**
+ * Seek to random positions and read the first packet there.
+ */
+static int run_seeks(const char *filename, const AVInputFormat *fmt,
+                     const AVDictionary *opts, int nb_seeks,
+                     int64_t start_time, int64_t duration)
+{
+    AVFormatContext *ctx = NULL;
+    AVPacket *pkt = NULL;
+    int64_t *latency;
+    uint64_t allocs;
+    AVLFG lfg;
+    int i, failed = 0, ret;
+
+    latency = av_calloc(nb_seeks, sizeof(*latency));
+    pkt     = av_packet_alloc();
+    if (!latency || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = open_input(&ctx, filename, fmt, opts)) < 0)
+        goto end;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+    allocs = get_allocs();
+    for (i = 0; i < nb_seeks; i++) {
+        int64_t ts = start_time + av_rescale(av_lfg_get(&lfg), duration, UINT_MAX);
+        int64_t start = av_gettime_relative();
+
+        ret = avformat_seek_file(ctx, -1, INT64_MIN, ts, ts, 0);
+        if (ret >= 0)
+            ret = av_read_frame(ctx, pkt);
+        latency[i] = av_gettime_relative() - start;
+        if (ret < 0)
+            failed++;
+        av_packet_unref(pkt);
+    }
+    allocs = get_allocs() - allocs;
+    ret = 0;
+
+    qsort(latency, nb_seeks, sizeof(*latency), cmp_int64);
+    printf("seek: %d seeks, %d failed, %.2f allocs/seek\n", nb_seeks, failed,
+           allocs / (double)nb_seeks);
+    printf("seek latency: min %.3f ms, median %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           latency[0] / 1000.0, latency[nb_seeks / 2] / 1000.0,
+           latency[nb_seeks * 90 / 100] / 1000.0, latency[nb_seeks * 99 / 100] / 1000.0,
+           latency[nb_seeks - 1] / 1000.0);
+
+end:
+    av_packet_free(&pkt);
+    avformat_close_input(&ctx);
+    av_free(latency);
+    return ret;
+}
+
+static int open_output(AVFormatContext **ctx, const char *format, const char *filename)
+{
+    int ret = avformat_alloc_output_context2(ctx, NULL, format, filename);
+
+    if (ret < 0)
+        return ret;
+    return avio_open(&(*ctx)->pb, filename, AVIO_FLAG_WRITE);
+}
+
+static int close_output(AVFormatContext **ctx, int ret)
+{
+    if (*ctx && ret >= 0)
+        ret = av_write_trailer(*ctx);
+    if (*ctx)
+        avio_closep(&(*ctx)->pb);
+    avformat_free_context(*ctx);
+    *ctx = NULL;
+    return ret;
+}
+
+/**
+ * Write the packetnr-th packet of nb_samples samples of silence to st.
+ */
+static int write_silence(AVFormatContext *ctx, AVStream *st, AVPacket *pkt,
+                         int64_t packetnr, int nb_samples)
+{
+    int ret;
+
+    if ((ret = av_new_packet(pkt, nb_samples * st->codecpar->block_align)) < 0)
+        return ret;
+    memset(pkt->data, 0, pkt->size);
+    pkt->stream_index = st->index;
+    pkt->pts = pkt->dts = av_rescale_q(packetnr * nb_samples,
+                                      av_make_q(1, st->codecpar->sample_rate),
+                                      st->time_base);
+    pkt->duration = av_rescale_q(nb_samples, av_make_q(1, st->codecpar->sample_rate),
+                                 st->time_base);
+    pkt->flags |= AV_PKT_FLAG_KEY;
+    return av_interleaved_write_frame(ctx, pkt);
+}
+
+static AVStream *new_pcm_stream(AVFormatContext *ctx, int channels)
+{
+    AVStream *st = avformat_new_stream(ctx, NULL);
+
+    if (!st)
+        return NULL;
+    st->codecpar->codec_type  = AVMEDIA_TYPE_AUDIO;
+    st->codecpar->codec_id    = AV_CODEC_ID_PCM_S24LE;
+    st->codecpar->sample_rate = 48000;
+    st->codecpar->block_align = 3 * channels;
+    st->codecpar->bits_per_coded_sample = 24;
+    av_channel_layout_default(&st->codecpar->ch_layout, channels);
+    st->time_base = av_make_q(1, 48000);
+    return st;
+}
+
+#define IMF_EDIT_UNIT_SAMPLES 2000 /* 48 kHz samples per edit unit at 24 fps */
+#define IMF_TRACK_FILE_UNITS  1440 /* one minute at 24 fps */
+#define IMF_SEGMENT_RESOURCES 100
+
+static void imf_write_uuid(AVIOContext *pb, const char *tag, unsigned type, unsigned nb)
+{
+    avio_printf(pb, "<%s>urn:uuid:%08x-0000-4000-8000-%012x</%s>\n", tag, type, nb, tag);
+}
+
+static int write_xml(const char *dir, const char *name, AVIOContext **pb)
+{
+    char *path = av_append_path_component(dir, name);
+    int ret;
+
+    if (!path)
+        return AVERROR(ENOMEM);
+    ret = avio_open(pb, path, AVIO_FLAG_WRITE);
+    av_free(path);
+    if (ret < 0)
+        return ret;
+    avio_printf(*pb, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    return 0;
+}
+
+/**
+ * Write an IMF package made of a one minute track file of mono PCM audio and
+ * a CPL of nb_resources resources, each one edit unit long and entering the
+ * track file at a different point.
+ */
+static int generate_imf(const char *dir, int nb_resources)
+{
+    AVFormatContext *ctx = NULL;
+    AVIOContext *pb = NULL;
+    AVPacket *pkt;
+    AVStream *st;
+    char *path = NULL;
+    int i, ret;
+
+    pkt  = av_packet_alloc();
+    path = av_append_path_component(dir, "audio.mxf");
+    if (!pkt || !path) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    /* track file */
+    if ((ret = open_output(&ctx, "mxf_opatom", path)) < 0)
+        goto end;
+    if (!(st = new_pcm_stream(ctx, 1))) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = av_opt_set(ctx->priv_data, "mxf_audio_edit_rate", "24", 0)) < 0 ||
+        (ret = avformat_write_header(ctx, NULL)) < 0)
+        goto end;
+    for (i = 0; i < IMF_TRACK_FILE_UNITS; i++)
+        if ((ret = write_silence(ctx, st, pkt, i, IMF_EDIT_UNIT_SAMPLES)) < 0)
+            goto end;
+    ret = close_output(&ctx, 0);
+    if (ret < 0)
+        goto end;
+
+    /* asset map */
+    if ((ret = write_xml(dir, "ASSETMAP.xml", &pb)) < 0)
+        goto end;
+    avio_printf(pb, "<am:AssetMap xmlns:am=\"http://www.smpte-ra.org/schemas/429-9/2007/AM\">\n");
+    imf_write_uuid(pb, "am:Id", 1, 0);
+    avio_printf(pb, "<am:AssetList><am:Asset>\n");
+    imf_write_uuid(pb, "am:Id", 2, 0);
+    avio_printf(pb, "<am:ChunkList><am:Chunk><am:Path>audio.mxf</am:Path></am:Chunk></am:ChunkList>\n"
+                    "</am:Asset></am:AssetList></am:AssetMap>\n");
+    if ((ret = avio_closep(&pb)) < 0)
+        goto end;
+
+    /* composition playlist */
+    if ((ret = write_xml(dir, "CPL.xml", &pb)) < 0)
+        goto end;
+    avio_printf(pb, "<CompositionPlaylist xmlns=\"http://www.smpte-ra.org/schemas/2067-3/2016\""
+                    " xmlns:cc=\"http://www.smpte-ra.org/schemas/2067-2/2016\""
+                    " xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n");
+    imf_write_uuid(pb, "Id", 3, 0);
+    avio_printf(pb, "<IssueDate>2022-01-01T00:00:00Z</IssueDate>\n"
+                    "<ContentTitle>demux_bench</ContentTitle>\n"
+                    "<EditRate>24 1</EditRate>\n"
+                    "<SegmentList>\n");
+    for (i = 0; i < nb_resources; i++) {
+        /* spread the entry points over the track file */
+        int entry_point = (int)(i * 7919LL % (IMF_TRACK_FILE_UNITS - 1)) * IMF_EDIT_UNIT_SAMPLES;
+
+        if (!(i % IMF_SEGMENT_RESOURCES)) {
+            avio_printf(pb, "<Segment>\n");
+            imf_write_uuid(pb, "Id", 4, i);
+            avio_printf(pb, "<SequenceList><cc:MainAudioSequence>\n");
+            imf_write_uuid(pb, "Id", 5, i);
+            imf_write_uuid(pb, "TrackId", 6, 0);
+            avio_printf(pb, "<ResourceList>\n");
+        }
+        avio_printf(pb, "<Resource xsi:type=\"TrackFileResourceType\">\n");
+        imf_write_uuid(pb, "Id", 7, i);
+        avio_printf(pb, "<EditRate>48000 1</EditRate>\n"
+                        "<IntrinsicDuration>%d</IntrinsicDuration>\n"
+                        "<EntryPoint>%d</EntryPoint>\n"
+                        "<SourceDuration>%d</SourceDuration>\n",
+                    IMF_TRACK_FILE_UNITS * IMF_EDIT_UNIT_SAMPLES, entry_point,
+                    IMF_EDIT_UNIT_SAMPLES);
+        imf_write_uuid(pb, "SourceEncoding", 8, 0);
+        imf_write_uuid(pb, "TrackFileId", 2, 0);
+        avio_printf(pb, "</Resource>\n");
+        if (i % IMF_SEGMENT_RESOURCES == IMF_SEGMENT_RESOURCES - 1 || i == nb_resources - 1)
+            avio_printf(pb, "</ResourceList></cc:MainAudioSequence></SequenceList></Segment>\n");
+    }
+    avio_printf(pb, "</SegmentList></CompositionPlaylist>\n");
+    ret = avio_closep(&pb);
+
+end:
+    close_output(&ctx, ret);
+    avio_closep(&pb);
+    av_packet_free(&pkt);
+    av_free(path);
+    return ret;
+}
+
+/**
+ * Write an MXF file of nb_frames intra coded MPEG-2 frames with mono PCM
+ * audio. The muxer starts a body partition every 250 frames.
+ */
+static int generate_mxf(const char *filename, int nb_frames)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_MPEG2VIDEO);
+    AVCodecContext *enc = NULL;
+    AVFormatContext *ctx = NULL;
+    AVFrame *frame = NULL;
+    AVPacket *pkt = NULL, *video = NULL;
+    AVStream *vst, *ast;
+    int i, ret;
+
+    if (!codec) {
+        fprintf(stderr, "MPEG-2 video encoder not available\n");
+        return AVERROR_ENCODER_NOT_FOUND;
+    }
+
+    enc   = avcodec_alloc_context3(codec);
+    frame = av_frame_alloc();
+    pkt   = av_packet_alloc();
+    video = av_packet_alloc();
+    if (!enc || !frame || !pkt || !video) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    /* all the frames are copies of a single intra coded one */
+    enc->width     = 64;
+    enc->height    = 64;
+    enc->pix_fmt   = AV_PIX_FMT_YUV420P;
+    enc->time_base = av_make_q(1, 25);
+    enc->gop_size  = 0;
+    if ((ret = avcodec_open2(enc, codec, NULL)) < 0)
+        goto end;
+    frame->width  = enc->width;
+    frame->height = enc->height;
+    frame->format = enc->pix_fmt;
+    frame->pts    = 0;
+    if ((ret = av_frame_get_buffer(frame, 0)) < 0)
+        goto end;
+    for (i = 0; i < 3; i++)
+        memset(frame->data[i], 128, frame->linesize[i] * (i ? enc->height / 2 : enc->height));
+    if ((ret = avcodec_send_frame(enc, frame)) < 0 ||
+        (ret = avcodec_send_frame(enc, NULL)) < 0 ||
+        (ret = avcodec_receive_packet(enc, video)) < 0)
+        goto end;
+
+    if ((ret = open_output(&ctx, "mxf", filename)) < 0)
+        goto end;
+    if (!(vst = avformat_new_stream(ctx, NULL))) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = avcodec_parameters_from_context(vst->codecpar, enc)) < 0)
+        goto end;
+    vst->time_base = enc->time_base;
+    if (!(ast = new_pcm_stream(ctx, 1))) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    if ((ret = avformat_write_header(ctx, NULL)) < 0)
+        goto end;
+
+    for (i = 0; i < nb_frames; i++) {
+        if ((ret = av_packet_ref(pkt, video)) < 0)
+            goto end;
+        pkt->stream_index = vst->index;
+        pkt->pts = pkt->dts = av_rescale_q(i, enc->time_base, vst->time_base);
+        pkt->duration = av_rescale_q(1, enc->time_base, vst->time_base);
+        if ((ret = av_interleaved_write_frame(ctx, pkt)) < 0 ||
+            (ret = write_silence(ctx, ast, pkt, i, 48000 / 25)) < 0)
+            goto end;
+    }
+    ret = 0;
+
+end:
+    ret = close_output(&ctx, ret);
+    avcodec_free_context(&enc);
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    av_packet_free(&video);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    const AVInputFormat *fmt = NULL;
+    AVDictionary *opts = NULL;
+    const char *filename = NULL, *generate = NULL;
+    int64_t start_time = 0, duration = 0;
+    int runs = 3, nb_seeks = 100, find_info = 0, count = 0, i, ret = 0;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            if (!(fmt = av_find_input_format(argv[++i]))) {
+                fprintf(stderr, "Unknown input format %s\n", argv[i]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            if (av_dict_parse_string(&opts, argv[++i], "=", ":", 0) < 0)
+                return usage(argv[0], 1);
+        } else if (!strcmp(argv[i], "-i")) {
+            find_info = 1;
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            nb_seeks = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            generate = argv[++i];
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !filename) {
+            filename = argv[i];
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (!filename || runs <= 0 || nb_seeks < 0 || count < 0)
+        return usage(argv[0], 1);
+
+    if (generate) {
+        if (!strcmp(generate, "imf")) {
+            ret = generate_imf(filename, count ? count : 1000);
+            if (ret >= 0)
+                printf("wrote %s/CPL.xml, open it with: %s -f imf %s/CPL.xml\n",
+                       filename, argv[0], filename);
+        }
+        else if (!strcmp(generate, "mxf"))
+            ret = generate_mxf(filename, count ? count : 25000);
+        else
+            return usage(argv[0], 1);
+        goto end;
+    }
+
+    if (!ALLOC_COUNT)
+        printf("allocations are not counted on this system\n");
+
+    for (i = 0; i < runs; i++)
+        if ((ret = run(filename, fmt, opts, find_info, i, &start_time, &duration)) < 0)
+            goto end;
+
+    if (nb_seeks && duration > 0)
+        ret = run_seeks(filename, fmt, opts, nb_seeks, start_time, duration);
+
+end:
+    av_dict_free(&opts);
+    if (ret < 0) {
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}
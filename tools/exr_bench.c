@@ -0,0 +1,276 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measure the throughput of the OpenEXR decoder. Each image is loaded into
+ * memory once and decoded repeatedly, so only the decoder is timed. The
+ * compression of every image is read from its header:
+ *
+ *   exr_bench -t 8 -n 50 piz.exr zip.exr b44.exr dwaa.exr
+ *
+ * Without input files, half float images are generated with the OpenEXR
+ * encoder for each compression it supports (none, RLE, ZIP1 and ZIP16):
+ *
+ *   exr_bench -s 3840x2160 -r 5
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/file.h"
+#include "libavutil/frame.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/time.h"
+#include "libavcodec/avcodec.h"
+
+static const char *const compression_names[] = {
+    "none", "RLE", "ZIPS", "ZIP", "PIZ", "PXR24", "B44", "B44A", "DWAA", "DWAB",
+};
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-t threads] [-n decodes] [-r runs] [-s size] [file.exr ...]\n", argv0);
+    fprintf(stderr, "-t: decoder threads, default 1\n");
+    fprintf(stderr, "-n: decodes of each image per run, default 20\n");
+    fprintf(stderr, "-r: runs over each image, default 3\n");
+    fprintf(stderr, "-s: size of the generated images, default 1920x1080\n");
+    return ret;
+}
+
+/* Return the name of the compression attribute in the header, or "unknown". */
+static const char *exr_compression(const uint8_t *buf, int size)
+{
+    const uint8_t *end = buf + size;
+
+    if (size < 8 || AV_RL32(buf) != 20000630)
+        return "unknown";
+    buf += 8;
+
+    while (buf < end && *buf) {
+        const uint8_t *name = buf, *type;
+        uint32_t len;
+
+        buf  = memchr(buf, 0, end - buf);
+        type = buf ? buf + 1 : NULL;
+        buf  = type ? memchr(type, 0, end - type) : NULL;
+        if (!buf || end - buf < 5)
+            break;
+        len  = AV_RL32(buf + 1);
+        buf += 5;
+        if (len > end - buf)
+            break;
+        if (!strcmp((const char *)name, "compression") &&
+            !strcmp((const char *)type, "compression") && len == 1)
+            return *buf < FF_ARRAY_ELEMS(compression_names) ? compression_names[*buf] : "unknown";
+        buf += len;
+    }
+    return "unknown";
+}
+
+static int generate(AVPacket *pkt, const char *compression, int width, int height)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_EXR);
+    AVCodecContext *enc = NULL;
+    AVFrame *frame = NULL;
+    AVLFG lfg;
+    int ret;
+
+    if (!codec)
+        return AVERROR_ENCODER_NOT_FOUND;
+    enc   = avcodec_alloc_context3(codec);
+    frame = av_frame_alloc();
+    if (!enc || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    enc->width     = width;
+    enc->height    = height;
+    enc->pix_fmt   = AV_PIX_FMT_GBRPF32;
+    enc->time_base = (AVRational){ 1, 25 };
+    av_opt_set(enc->priv_data, "compression", compression, 0);
+    av_opt_set(enc->priv_data, "format", "half", 0);
+    ret = avcodec_open2(enc, codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    frame->format = enc->pix_fmt;
+    frame->width  = width;
+    frame->height = height;
+    ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0)
+        goto fail;
+
+    /* smooth gradients with some noise, so that the compressors have work */
+    av_lfg_init(&lfg, 0);
+    for (int p = 0; p < 3; p++) {
+        for (int y = 0; y < height; y++) {
+            float *line = (float *)(frame->data[p] + y * frame->linesize[p]);
+            for (int x = 0; x < width; x++)
+                line[x] = (x + y * (p + 1)) / (float)(width + height) +
+                          (av_lfg_get(&lfg) & 0xFF) / 4096.0f;
+        }
+    }
+
+    ret = avcodec_send_frame(enc, frame);
+    if (ret >= 0)
+        ret = avcodec_receive_packet(enc, pkt);
+
+fail:
+    av_frame_free(&frame);
+    avcodec_free_context(&enc);
+    return ret;
+}
+
+static int64_t run(const AVPacket *pkt, int threads, int decodes)
+{
+    const AVCodec *codec = avcodec_find_decoder(AV_CODEC_ID_EXR);
+    AVCodecContext *dec = NULL;
+    AVFrame *frame = NULL;
+    int64_t pixels = 0;
+    int ret, sent = 0;
+
+    if (!codec)
+        return AVERROR_DECODER_NOT_FOUND;
+    dec   = avcodec_alloc_context3(codec);
+    frame = av_frame_alloc();
+    if (!dec || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    dec->thread_count = threads;
+    ret = avcodec_open2(dec, codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    while (1) {
+        ret = avcodec_send_packet(dec, sent < decodes ? pkt : NULL);
+        if (ret >= 0)
+            sent++;
+        else if (ret != AVERROR(EAGAIN))
+            goto fail;
+
+        while ((ret = avcodec_receive_frame(dec, frame)) >= 0) {
+            pixels += frame->width * frame->height;
+            av_frame_unref(frame);
+        }
+        if (ret == AVERROR_EOF)
+            break;
+        if (ret != AVERROR(EAGAIN))
+            goto fail;
+    }
+    ret = 0;
+
+fail:
+    av_frame_free(&frame);
+    avcodec_free_context(&dec);
+    return ret < 0 ? ret : pixels;
+}
+
+static int bench(const char *name, const AVPacket *pkt, int threads, int decodes, int runs)
+{
+    char errbuf[50];
+
+    for (int i = 0; i < runs; i++) {
+        int64_t start = av_gettime_relative(), elapsed, pixels;
+
+        pixels  = run(pkt, threads, decodes);
+        elapsed = FFMAX(av_gettime_relative() - start, 1);
+        if (pixels < 0) {
+            av_strerror(pixels, errbuf, sizeof(errbuf));
+            fprintf(stderr, "Error decoding %s: %s\n", name, errbuf);
+            return 1;
+        }
+        printf("%s (%s, %d bytes) run %d: %.3f ms per image, %.1f Mpixel/s\n",
+               name, exr_compression(pkt->data, pkt->size), pkt->size, i,
+               elapsed / 1000.0 / decodes, pixels / (double)elapsed);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *const generated[] = { "none", "rle", "zip1", "zip16" };
+    int threads = 1, decodes = 20, runs = 3, width = 1920, height = 1080, i;
+    AVPacket *pkt;
+    char errbuf[50];
+    int ret = 0;
+
+    for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            decodes = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (av_parse_video_size(&width, &height, argv[++i]) < 0)
+                return usage(argv[0], 1);
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (threads < 0 || decodes <= 0 || runs <= 0)
+        return usage(argv[0], 1);
+
+    pkt = av_packet_alloc();
+    if (!pkt)
+        return 1;
+
+    if (i == argc) {
+        for (int j = 0; j < FF_ARRAY_ELEMS(generated) && !ret; j++) {
+            ret = generate(pkt, generated[j], width, height);
+            if (ret < 0) {
+                av_strerror(ret, errbuf, sizeof(errbuf));
+                fprintf(stderr, "Error generating %s image: %s\n", generated[j], errbuf);
+                ret = 1;
+                break;
+            }
+            ret = bench(generated[j], pkt, threads, decodes, runs);
+            av_packet_unref(pkt);
+        }
+    }
+
+    for (; i < argc && !ret; i++) {
+        uint8_t *buf;
+        size_t size;
+
+        ret = av_file_map(argv[i], &buf, &size, 0, NULL);
+        if (ret < 0) {
+            ret = 1;
+            break;
+        }
+        ret = av_new_packet(pkt, size);
+        if (ret >= 0) {
+            memcpy(pkt->data, buf, size);
+            ret = bench(argv[i], pkt, threads, decodes, runs);
+        } else {
+            ret = 1;
+        }
+        av_file_unmap(buf, size);
+        av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+    return ret;
+}